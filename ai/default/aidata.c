@@ -22,6 +22,9 @@
 #include "multipliers.h"
 #include "research.h"
 
+/* common/aicore */
+#include "caravan.h"
+
 /* server */
 #include "cityturn.h"
 #include "plrhand.h"
@@ -58,6 +61,7 @@ void dai_data_init(struct ai_type *ait, struct player *pplayer)
   struct ai_plr *ai = def_ai_player_data(pplayer, ait);
 
   ai->phase_initialized = FALSE;
+  ai->phase_planned = FALSE;
 
   ai->last_num_continents = -1;
   ai->last_num_oceans = -1;
@@ -90,6 +94,8 @@ void dai_data_init(struct ai_type *ait, struct player *pplayer)
   ai->diplomacy.req_love_for_alliance = MAX_AI_LOVE / 4;
 
   ai->settler = NULL;
+  ai->danger = NULL;
+  ai->caravans = NULL;
 
   /* Initialise autosettler. */
   dai_auto_settler_init(ai);
@@ -292,6 +298,11 @@ void dai_data_phase_finished(struct ai_type *ait, struct player *pplayer)
 {
   struct ai_plr *ai = def_ai_player_data(pplayer, ait);
 
+  if (ai->caravans != NULL) {
+    caravan_planner_destroy(ai->caravans);
+    ai->caravans = NULL;
+  }
+
   if (!ai->phase_initialized) {
     return;
   }
@@ -73,6 +73,9 @@ struct ai_plr
 {
   bool phase_initialized;
 
+  /* dai_plan_phase() has been done for the current phase. */
+  bool phase_planned;
+
   int last_num_continents;
   int last_num_oceans;
 
@@ -101,6 +104,12 @@ struct ai_plr
   /* Cache map for AI settlers; defined in aisettler.c. */
   struct ai_settler *settler;
 
+  /* Shared danger assessment paths; defined in daimilitary.c. */
+  struct dai_danger_map *danger;
+
+  /* Caravan destination searches of the phase; see caravan.h. */
+  struct caravan_planner *caravans;
+
   /* The units of tech_want seem to be shields */
   adv_want tech_want[A_LAST+1];
 };
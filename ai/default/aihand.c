@@ -728,14 +728,34 @@ static void dai_manage_government(struct ai_type *ait, struct player *pplayer)
   }
 }
 
+/*************************************************************************//**
+  Planning to be done by AI at the start of the phase, before any AI
+  player moves its units. This may run concurrently for several players,
+  so it only reads the world and writes pplayer's own AI data.
+*****************************************************************************/
+void dai_plan_phase(struct ai_type *ait, struct player *pplayer)
+{
+  struct ai_plr *plr_data = def_ai_player_data(pplayer, ait);
+
+  dai_assess_danger_player(ait, pplayer, &(wld.map));
+  plr_data->phase_planned = TRUE;
+}
+
 /*************************************************************************//**
   Activities to be done by AI _before_ human turn.  Here we just move the
   units intelligently.
 *****************************************************************************/
 void dai_do_first_activities(struct ai_type *ait, struct player *pplayer)
 {
+  struct ai_plr *plr_data = def_ai_player_data(pplayer, ait);
+
   TIMING_LOG(AIT_ALL, TIMER_START);
-  dai_assess_danger_player(ait, pplayer, &(wld.map));
+  if (plr_data->phase_planned) {
+    /* Danger was already assessed by dai_plan_phase(). */
+    plr_data->phase_planned = FALSE;
+  } else {
+    dai_assess_danger_player(ait, pplayer, &(wld.map));
+  }
   /* TODO: Make assess_danger save information on what is threatening
    * us and make dai_manage_units and Co act upon this information, trying
    * to eliminate the source of danger */
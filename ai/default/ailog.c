@@ -24,6 +24,7 @@
 
 /* server */
 #include "notify.h"
+#include "srv_log.h"
 
 /* ai/default */
 #include "aidata.h"
@@ -89,7 +90,7 @@ void real_tech_log(struct ai_type *ait, const char *file, const char *function,
   va_end(ap);
 
   cat_snprintf(buffer, sizeof(buffer), "%s", buffer2);
-  if (send_notify) {
+  if (send_notify && srv_log_can_notify()) {
     notify_conn(NULL, NULL, E_AI_DEBUG, ftc_log, "%s", buffer);
   }
   do_log(file, function, line, FALSE, level, "%s", buffer);
@@ -128,7 +129,7 @@ void real_diplo_log(struct ai_type *ait, const char *file,
   va_end(ap);
 
   cat_snprintf(buffer, sizeof(buffer), "%s", buffer2);
-  if (send_notify) {
+  if (send_notify && srv_log_can_notify()) {
     notify_conn(NULL, NULL, E_AI_DEBUG, ftc_log, "%s", buffer);
   }
   do_log(file, function, line, FALSE, level, "%s", buffer);
@@ -185,7 +186,7 @@ void real_bodyguard_log(struct ai_type *ait, const char *file,
   va_end(ap);
 
   cat_snprintf(buffer, sizeof(buffer), "%s", buffer2);
-  if (send_notify) {
+  if (send_notify && srv_log_can_notify()) {
     notify_conn(NULL, NULL, E_AI_DEBUG, ftc_log, "%s", buffer);
   }
   do_log(file, function, line, FALSE, level, "%s", buffer);
@@ -26,12 +26,15 @@
 
 /* common */
 #include "city.h"
+#include "effects.h"
 #include "game.h"
 #include "government.h"
+#include "improvement.h"
 #include "map.h"
 #include "movement.h"
 #include "packets.h"
 #include "player.h"
+#include "research.h"
 
 /* common/aicore */
 #include "citymap.h"
@@ -126,6 +129,7 @@ struct tile_data_cache {
   int reserved; /* reservation for this tile; used by print_citymap() */
 
   int turn;     /* the turn the values were calculated */
+  uint64_t key;  /* tdc_tile_key() of the inputs of the values */
 };
 
 
@@ -147,7 +151,7 @@ struct ai_settler {
 #ifdef FREECIV_DEBUG
   struct {
     int hit;
-    int old;
+    int stale;
     int miss;
     int save;
   } cache;
@@ -183,9 +187,12 @@ struct cityresult {
   int city_radius_sq;     /* current squared radius of the city */
 };
 
+static uint64_t tdc_context_key(struct player *plr);
+static uint64_t tdc_tile_key(uint64_t context, const struct tile *ptile);
 static const struct tile_data_cache *tdc_plr_get(struct ai_type *ait,
                                                  struct player *plr,
-                                                 int tindex);
+                                                 int tindex,
+                                                 uint64_t key);
 static void tdc_plr_set(struct ai_type *ait, struct player *plr, int tindex,
                         const struct tile_data_cache *tdcache);
 
@@ -194,7 +201,8 @@ static void cityresult_destroy(struct cityresult *result);
 
 static struct cityresult *cityresult_fill(struct ai_type *ait,
                                           struct player *pplayer,
-                                          struct tile *center);
+                                          struct tile *center,
+                                          uint64_t context);
 static bool food_starvation(const struct cityresult *result);
 static bool shield_starvation(const struct cityresult *result);
 static int result_defense_bonus(struct player *pplayer,
@@ -204,11 +212,13 @@ static void print_cityresult(struct player *pplayer,
                              const struct cityresult *cr);
 struct cityresult *city_desirability(struct ai_type *ait,
                                      struct player *pplayer,
-                                     struct unit *punit, struct tile *ptile);
+                                     struct unit *punit, struct tile *ptile,
+                                     uint64_t context);
 static struct cityresult *settler_map_iterate(struct ai_type *ait,
                                               struct pf_parameter *parameter,
                                               struct unit *punit,
-                                              int boat_cost);
+                                              int boat_cost,
+                                              uint64_t context);
 static struct cityresult *find_best_city_placement(struct ai_type *ait,
                                                    struct unit *punit,
                                                    bool look_for_boat,
@@ -272,7 +282,8 @@ static void cityresult_destroy(struct cityresult *result)
 *****************************************************************************/
 static struct cityresult *cityresult_fill(struct ai_type *ait,
                                           struct player *pplayer,
-                                          struct tile *center)
+                                          struct tile *center,
+                                          uint64_t context)
 {
   struct city *pcity = tile_city(center);
   struct government *curr_govt = government_of_player(pplayer);
@@ -322,10 +333,16 @@ static struct cityresult *cityresult_fill(struct ai_type *ait,
       ptdc->reserved = reserved;
       /* ptdc->turn was set by tile_data_cache_new(). */
     } else {
-      const struct tile_data_cache *ptdc_hit = tdc_plr_get(ait, pplayer, tindex);
-      if (!ptdc_hit || city_center) {
+      uint64_t key = tdc_tile_key(context, ptile);
+      const struct tile_data_cache *ptdc_hit = NULL;
+
+      if (!city_center) {
         /* We cannot read city center from cache */
+        ptdc_hit = tdc_plr_get(ait, pplayer, tindex, key);
+      }
+      if (!ptdc_hit) {
         ptdc = tile_data_cache_new();
+        ptdc->key = key;
 
         /* Food */
         ptdc->food = city_tile_output(pcity, ptile, FALSE, O_FOOD);
@@ -482,6 +499,7 @@ struct tile_data_cache *
   ptdc_copy->sum = ptdc->sum;
   ptdc_copy->reserved = ptdc->reserved;
   ptdc_copy->turn = ptdc->turn;
+  ptdc_copy->key = ptdc->key;
 
   return ptdc_copy;
 }
@@ -497,11 +515,192 @@ static void tile_data_cache_destroy(struct tile_data_cache *ptdc)
 }
 
 /*************************************************************************//**
-  Return player's tile data cache
+  Mix value into hash key.
+*****************************************************************************/
+static inline uint64_t tdc_key_fold(uint64_t key, unsigned int value)
+{
+  return (key ^ value) * 1099511628211ULL;
+}
+
+/*************************************************************************//**
+  Return whether the requirement can only be evaluated from state the
+  keys of the tile data cache don't cover, like the date, achievements,
+  culture, diplomatic states or the doings of other players.
+*****************************************************************************/
+static bool tdc_req_is_volatile(const struct requirement *preq)
+{
+  switch (preq->range) {
+  case REQ_RANGE_TEAM:
+  case REQ_RANGE_ALLIANCE:
+  case REQ_RANGE_WORLD:
+  case REQ_RANGE_TRADEROUTE:
+    /* Great wonders are part of the key, anything else isn't. */
+    return preq->source.kind != VUT_IMPROVEMENT;
+  default:
+    break;
+  }
+
+  switch (preq->source.kind) {
+  case VUT_NONE:
+  case VUT_ADVANCE:
+  case VUT_TECHFLAG:
+  case VUT_MINTECHS:
+  case VUT_GOVERNMENT:
+  case VUT_IMPROVEMENT:
+  case VUT_IMPR_GENUS:
+  case VUT_NATION:
+  case VUT_NATIONGROUP:
+  case VUT_NATIONALITY:
+  case VUT_STYLE:
+  case VUT_AI_LEVEL:
+  case VUT_OTYPE:
+  case VUT_SPECIALIST:
+  case VUT_MINSIZE:
+  case VUT_TOPO:
+  case VUT_TERRAIN:
+  case VUT_TERRAINCLASS:
+  case VUT_TERRFLAG:
+  case VUT_TERRAINALTER:
+  case VUT_EXTRA:
+  case VUT_EXTRAFLAG:
+  case VUT_BASEFLAG:
+  case VUT_ROADFLAG:
+  case VUT_CITYTILE:
+  case VUT_ACTION:
+  case VUT_UTYPE:
+  case VUT_UTFLAG:
+  case VUT_UCLASS:
+  case VUT_UCFLAG:
+  case VUT_UNITSTATE:
+  case VUT_MINMOVES:
+  case VUT_MINVETERAN:
+  case VUT_MINHP:
+    /* Fixed for the virtual city, or part of the keys. Unit requirements
+     * are evaluated without a unit. */
+    return FALSE;
+  default:
+    return TRUE;
+  }
+}
+
+/*************************************************************************//**
+  Return whether any effect city_tile_output() reads has requirements
+  the keys of the tile data cache don't cover.
+*****************************************************************************/
+static bool tdc_effects_are_volatile(void)
+{
+  const enum effect_type types[] = {
+    EFT_MINING_PCT,
+    EFT_IRRIGATION_PCT,
+    EFT_OUTPUT_ADD_TILE,
+    EFT_OUTPUT_PENALTY_TILE,
+    EFT_OUTPUT_INC_TILE_CELEBRATE,
+    EFT_OUTPUT_INC_TILE,
+    EFT_OUTPUT_PER_TILE,
+    EFT_OUTPUT_TILE_PUNISH_PCT
+  };
+  int i;
+
+  for (i = 0; i < ARRAY_SIZE(types); i++) {
+    effect_list_iterate(get_effects(types[i]), peffect) {
+      requirement_vector_iterate(&peffect->reqs, preq) {
+        if (tdc_req_is_volatile(preq)) {
+          return TRUE;
+        }
+      } requirement_vector_iterate_end;
+    } effect_list_iterate_end;
+  }
+
+  return FALSE;
+}
+
+/*************************************************************************//**
+  Return key of the player wide state the tile values of a virtual city
+  depend on: government aimed for, output priorities, skill level, known
+  techs, wonders and multipliers. If the output effects depend on
+  anything else, the turn is part of the key too, so such values are
+  not kept over turns.
+*****************************************************************************/
+static uint64_t tdc_context_key(struct player *plr)
+{
+  const struct research *presearch = research_get(plr);
+  const struct adv_data *adv = adv_data_get(plr, NULL);
+  uint64_t key = 14695981039346656037ULL;
+  unsigned int bits = 0;
+  int n = 0;
+
+  if (tdc_effects_are_volatile()) {
+    key = tdc_key_fold(key, game.info.turn);
+  }
+  key = tdc_key_fold(key, government_number(adv->goal.govt.gov));
+  key = tdc_key_fold(key, adv->food_priority);
+  key = tdc_key_fold(key, adv->shield_priority);
+  key = tdc_key_fold(key, adv->science_priority);
+  key = tdc_key_fold(key, plr->ai_common.skill_level);
+
+  advance_index_iterate(A_FIRST, tech) {
+    if (research_invention_state(presearch, tech) == TECH_KNOWN) {
+      bits |= 1u << (n % 32);
+    }
+    if (++n % 32 == 0) {
+      key = tdc_key_fold(key, bits);
+      bits = 0;
+    }
+  } advance_index_iterate_end;
+  key = tdc_key_fold(key, bits);
+
+  improvement_iterate(pimprove) {
+    if (is_great_wonder(pimprove)) {
+      const struct player *owner = great_wonder_owner(pimprove);
+
+      key = tdc_key_fold(key, owner != NULL ? player_number(owner) + 1 : 0);
+    } else if (is_small_wonder(pimprove)) {
+      key = tdc_key_fold(key, wonder_is_built(plr, pimprove));
+    }
+  } improvement_iterate_end;
+
+  multipliers_iterate(pmul) {
+    key = tdc_key_fold(key, plr->multipliers[multiplier_index(pmul)]);
+  } multipliers_iterate_end;
+
+  return key;
+}
+
+/*************************************************************************//**
+  Return key of everything the cached values of the tile depend on:
+  the player wide context, and terrain, extras, owner and city of the
+  tile and of the adjacent tiles.
+*****************************************************************************/
+static uint64_t tdc_tile_key(uint64_t context, const struct tile *ptile)
+{
+  uint64_t key = context;
+  size_t i;
+
+  square_iterate(&(wld.map), ptile, 1, ptile1) {
+    const struct player *owner = tile_owner(ptile1);
+    const struct extra_type *presource = tile_resource(ptile1);
+
+    key = tdc_key_fold(key, owner != NULL ? player_number(owner) + 1 : 0);
+    key = tdc_key_fold(key, tile_city(ptile1) != NULL);
+    key = tdc_key_fold(key, terrain_number(tile_terrain(ptile1)));
+    key = tdc_key_fold(key, presource != NULL
+                            ? extra_number(presource) + 1 : 0);
+    for (i = 0; i < ARRAY_SIZE(ptile1->extras.vec); i++) {
+      key = tdc_key_fold(key, ptile1->extras.vec[i]);
+    }
+  } square_iterate_end;
+
+  return key;
+}
+
+/*************************************************************************//**
+  Return player's tile data cache if it is still valid for the inputs
+  described by key.
 *****************************************************************************/
 static const struct tile_data_cache *tdc_plr_get(struct ai_type *ait,
                                                  struct player *plr,
-                                                 int tindex)
+                                                 int tindex,
+                                                 uint64_t key)
 {
   struct ai_plr *ai = dai_plr_data_get(ait, plr, NULL);
 
@@ -518,9 +717,9 @@ static const struct tile_data_cache *tdc_plr_get(struct ai_type *ait,
     ai->settler->cache.miss++;
 #endif /* FREECIV_DEBUG */
     return NULL;
-  } else if (ptdc->turn != game.info.turn) {
+  } else if (ptdc->key != key) {
 #ifdef FREECIV_DEBUG
-    ai->settler->cache.old++;
+    ai->settler->cache.stale++;
 #endif /* FREECIV_DEBUG */
     return NULL;
   } else {
@@ -698,7 +897,8 @@ static void print_cityresult(struct player *pplayer,
   if no place was found.
 *****************************************************************************/
 struct cityresult *city_desirability(struct ai_type *ait, struct player *pplayer,
-                                     struct unit *punit, struct tile *ptile)
+                                     struct unit *punit, struct tile *ptile,
+                                     uint64_t context)
 {
   struct city *pcity = tile_city(ptile);
   struct adv_data *ai = adv_data_get(pplayer, NULL);
@@ -740,7 +940,7 @@ struct cityresult *city_desirability(struct ai_type *ait, struct player *pplayer
     return NULL;
   }
 
-  cr = cityresult_fill(ait, pplayer, ptile); /* Burn CPU, burn! */
+  cr = cityresult_fill(ait, pplayer, ptile, context); /* Burn CPU, burn! */
   if (!cr) {
     /* Failed to find a good spot */
     return NULL;
@@ -778,7 +978,8 @@ struct cityresult *city_desirability(struct ai_type *ait, struct player *pplayer
 static struct cityresult *settler_map_iterate(struct ai_type *ait,
                                               struct pf_parameter *parameter,
                                               struct unit *punit,
-                                              int boat_cost)
+                                              int boat_cost,
+                                              uint64_t context)
 {
   struct cityresult *cr = NULL, *best = NULL;
   int best_turn = 0; /* Which turn we found the best fit */
@@ -806,7 +1007,7 @@ static struct cityresult *settler_map_iterate(struct ai_type *ait,
     }
 
     /* Calculate worth */
-    cr = city_desirability(ait, pplayer, punit, ptile);
+    cr = city_desirability(ait, pplayer, punit, ptile, context);
 
     /* Check if actually found something */
     if (!cr) {
@@ -885,16 +1086,21 @@ static struct cityresult *find_best_city_placement(struct ai_type *ait,
   struct player *pplayer = unit_owner(punit);
   struct unit *ferry = NULL;
   struct cityresult *cr1 = NULL, *cr2 = NULL;
+  uint64_t context;
 
   fc_assert_ret_val(is_ai(pplayer), NULL);
   /* Only virtual units may use virtual boats: */
   fc_assert_ret_val(0 == punit->id || !use_virt_boat, NULL);
 
+  /* The state the tile values depend on doesn't change during the
+   * search. */
+  context = tdc_context_key(pplayer);
+
   /* Phase 1: Consider building cities on our continent */
 
   pft_fill_unit_parameter(&parameter, punit);
   parameter.omniscience = !has_handicap(pplayer, H_MAP);
-  cr1 = settler_map_iterate(ait, &parameter, punit, 0);
+  cr1 = settler_map_iterate(ait, &parameter, punit, 0, context);
 
   if (cr1 && cr1->result > RESULT_IS_ENOUGH) {
     /* skip further searches */
@@ -949,7 +1155,7 @@ static struct cityresult *find_best_city_placement(struct ai_type *ait,
      * Building a new boat is like a war against a weaker enemy -- 
      * good for the economy. (c) Bush family */
     cr2 = settler_map_iterate(ait, &parameter, punit,
-                              unit_build_shield_cost_base(ferry));
+                              unit_build_shield_cost_base(ferry), context);
     if (cr2) {
       cr2->overseas = TRUE;
       cr2->virt_boat = (ferry->id == 0);
@@ -999,7 +1205,7 @@ void dai_auto_settler_init(struct ai_plr *ai)
 
 #ifdef FREECIV_DEBUG
   ai->settler->cache.hit = 0;
-  ai->settler->cache.old = 0;
+  ai->settler->cache.stale = 0;
   ai->settler->cache.miss = 0;
   ai->settler->cache.save = 0;
 #endif /* FREECIV_DEBUG */
@@ -1194,18 +1400,21 @@ void dai_auto_settler_reset(struct ai_type *ait, struct player *pplayer)
   fc_assert_ret(ai->settler->tdc_hash != NULL);
 
 #ifdef FREECIV_DEBUG
-  log_debug("[aisettler cache for %s] save: %d, miss: %d, old: %d, hit: %d",
-            player_name(pplayer), ai->settler->cache.save,
-            ai->settler->cache.miss, ai->settler->cache.old,
-            ai->settler->cache.hit);
+  log_debug("[aisettler cache for %s] recomputed: %d (miss: %d, stale: %d), "
+            "reused: %d, saved: %d", player_name(pplayer),
+            ai->settler->cache.miss + ai->settler->cache.stale,
+            ai->settler->cache.miss, ai->settler->cache.stale,
+            ai->settler->cache.hit, ai->settler->cache.save);
 
   ai->settler->cache.hit = 0;
-  ai->settler->cache.old = 0;
+  ai->settler->cache.stale = 0;
   ai->settler->cache.miss = 0;
   ai->settler->cache.save = 0;
 #endif /* FREECIV_DEBUG */
 
-  tile_data_cache_hash_clear(ai->settler->tdc_hash);
+  /* The tile data cache is kept over turns; each entry carries the key of
+   * the state it was computed from, so changes to terrain, extras, borders,
+   * techs or wonders make it stale by themselves. */
 
   if (caller_closes) {
     dai_data_phase_finished(ait, pplayer);
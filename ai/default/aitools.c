@@ -426,7 +426,7 @@ bool dai_unit_goto_constrained(struct ai_type *ait, struct unit *punit,
     return TRUE;
   }
 
-  pfm = pf_map_new(parameter);
+  pfm = pf_map_new_goal(parameter, ptile);
   path = pf_map_path(pfm, ptile);
 
   if (path) {
@@ -427,6 +427,16 @@ static bool is_my_turn(struct unit *punit, struct unit *pdef)
   return TRUE;
 }
 
+/* A tile find_rampage_target() considers, in the order it reached it. */
+struct rampage_target {
+  struct tile *ptile;
+  int want;             /* See dai_rampage_want(), unless fight >= 0 */
+  int fight;            /* Index of the fight the want depends on, or -1 */
+  struct unit *pdef;    /* For a fight: the defender, */
+  int benefit;          /* and the arguments of avg_benefit(). */
+  int loss;
+};
+
 /**********************************************************************//**
   This function appraises the location (x, y) for a quick hit-n-run
   operation.  We do not take into account reinforcements: rampage is for
@@ -442,14 +452,23 @@ static bool is_my_turn(struct unit *punit, struct unit *pdef)
     0        means nothing found or error
   Here the minus indicates that you need to enter the target tile (as
   opposed to attacking it, which leaves you where you are).
+
+  When the value depends on the chance of winning a fight, the fight is
+  filled in 'target' and 'odds' instead and TRUE is returned in
+  'fight_needed', so that the odds of all targets can be computed in one
+  batch.  rampage_fight_want() then gives the value.
 **************************************************************************/
-static int dai_rampage_want(struct unit *punit, struct tile *ptile)
+static int dai_rampage_want(struct unit *punit, struct tile *ptile,
+                            struct rampage_target *target,
+                            struct combat_odds *odds, bool *fight_needed)
 {
   struct player *pplayer = unit_owner(punit);
   struct unit *pdef;
 
   CHECK_UNIT(punit);
 
+  *fight_needed = FALSE;
+
   if (can_unit_attack_tile(punit, ptile)
       && (pdef = get_defender(punit, ptile))) {
     /* See description of kill_desire() about these variables. */
@@ -471,16 +490,11 @@ static int dai_rampage_want(struct unit *punit, struct tile *ptile)
 
     /* If we have non-zero attack rating... */
     if (attack > 0 && is_my_turn(punit, pdef)) {
-      double chance = unit_win_chance(punit, pdef);
-      int desire = avg_benefit(benefit, loss, chance);
-
-      /* No need to amortize, our operation takes one turn. */
-      UNIT_LOG(LOG_DEBUG, punit, "Rampage: Desire %d to kill %s(%d,%d)",
-               desire,
-               unit_rule_name(pdef),
-               TILE_XY(unit_tile(pdef)));
-
-      return MAX(0, desire);
+      target->pdef = pdef;
+      target->benefit = benefit;
+      target->loss = loss;
+      get_combat_odds(punit, pdef, odds);
+      *fight_needed = TRUE;
     }
   } else if (0 == unit_list_size(ptile->units)) {
     /* No defender. */
@@ -504,6 +518,25 @@ static int dai_rampage_want(struct unit *punit, struct tile *ptile)
   return 0;
 }
 
+/**********************************************************************//**
+  The value of a rampage target that dai_rampage_want() left to the
+  chance of winning the fight.
+**************************************************************************/
+static int rampage_fight_want(struct unit *punit,
+                              const struct rampage_target *target,
+                              double chance)
+{
+  int desire = avg_benefit(target->benefit, target->loss, chance);
+
+  /* No need to amortize, our operation takes one turn. */
+  UNIT_LOG(LOG_DEBUG, punit, "Rampage: Desire %d to kill %s(%d,%d)",
+           desire,
+           unit_rule_name(target->pdef),
+           TILE_XY(unit_tile(target->pdef)));
+
+  return MAX(0, desire);
+}
+
 /**********************************************************************//**
   Look for worthy targets within a one-turn horizon.
 **************************************************************************/
@@ -518,6 +551,13 @@ static struct pf_path *find_rampage_target(struct unit *punit,
   /* Want of the best target */
   int max_want = 0;
   struct player *pplayer = unit_owner(punit);
+  /* The tiles worth anything, and the fights their wants depend on */
+  struct rampage_target *targets = NULL;
+  struct combat_odds *fights = NULL;
+  double *chances = NULL;
+  int ntargets = 0, targets_alloc = 0;
+  int nfights = 0, fights_alloc = 0;
+  int i;
  
   pft_fill_unit_attack_param(&parameter, punit);
   parameter.omniscience = !has_handicap(pplayer, H_MAP);
@@ -528,9 +568,9 @@ static struct pf_path *find_rampage_target(struct unit *punit,
 
   tgt_map = pf_map_new(&parameter);
   pf_map_move_costs_iterate(tgt_map, iter_tile, move_cost, FALSE) {
-    int want;
-    bool move_needed;
-    int thresh;
+    struct rampage_target target;
+    struct combat_odds odds;
+    bool fight_needed;
  
     if (move_cost > punit->moves_left) {
       /* This is too far */
@@ -542,11 +582,48 @@ static struct pf_path *find_rampage_target(struct unit *punit,
       /* The target is under fog of war */
       continue;
     }
-    
-    want = dai_rampage_want(punit, iter_tile);
+
+    target.want = dai_rampage_want(punit, iter_tile, &target, &odds,
+                                   &fight_needed);
+    if (0 == target.want && !fight_needed) {
+      continue;
+    }
+
+    target.ptile = iter_tile;
+    target.fight = -1;
+    if (fight_needed) {
+      if (nfights == fights_alloc) {
+        fights_alloc = MAX(16, 2 * fights_alloc);
+        fights = fc_realloc(fights, fights_alloc * sizeof(*fights));
+      }
+      target.fight = nfights;
+      fights[nfights++] = odds;
+    }
+    if (ntargets == targets_alloc) {
+      targets_alloc = MAX(16, 2 * targets_alloc);
+      targets = fc_realloc(targets, targets_alloc * sizeof(*targets));
+    }
+    targets[ntargets++] = target;
+  } pf_map_move_costs_iterate_end;
+
+  /* Fights against alike defenders are only weighed once. */
+  if (nfights > 0) {
+    chances = fc_malloc(nfights * sizeof(*chances));
+    win_chance_batch(fights, nfights, chances);
+  }
+
+  for (i = 0; i < ntargets; i++) {
+    const struct rampage_target *target = targets + i;
+    int want = target->want;
+    bool move_needed;
+    int thresh;
+
+    if (target->fight >= 0) {
+      want = rampage_fight_want(punit, target, chances[target->fight]);
+    }
 
     /* Negative want means move needed even though the tiles are adjacent */
-    move_needed = (!is_tiles_adjacent(unit_tile(punit), iter_tile)
+    move_needed = (!is_tiles_adjacent(unit_tile(punit), target->ptile)
                    || want < 0);
     /* Select the relevant threshold */
     thresh = (move_needed ? thresh_move : thresh_adj);
@@ -556,9 +633,13 @@ static struct pf_path *find_rampage_target(struct unit *punit,
       /* The new want exceeds both the previous maximum 
        * and the relevant threshold, so it's worth recording */
       max_want = want;
-      ptile = iter_tile;
+      ptile = target->ptile;
     }
-  } pf_map_move_costs_iterate_end;
+  }
+
+  free(targets);
+  free(fights);
+  free(chances);
 
   if (max_want > 0) {
     /* We found something */
@@ -2156,6 +2237,7 @@ static void dai_manage_caravan(struct ai_type *ait, struct player *pplayer,
   const struct city *homecity;
   const struct city *dest = NULL;
   struct unit_ai *unit_data;
+  struct ai_plr *ai = def_ai_player_data(pplayer, ait);
   bool help_wonder = FALSE;
   bool required_boat = FALSE;
   bool request_boat = FALSE;
@@ -2274,7 +2356,12 @@ static void dai_manage_caravan(struct ai_type *ait, struct player *pplayer,
       parameter.allow_foreign_trade = FTL_NATIONAL_ONLY;
       parameter.ignore_transit_time = FALSE;
     }
-    caravan_find_best_destination(punit, &parameter, &result, !has_handicap(pplayer, H_MAP));
+    if (ai->caravans == NULL) {
+      ai->caravans = caravan_planner_new();
+    }
+    caravan_planner_find_best_destination(ai->caravans, punit, &parameter,
+                                          &result,
+                                          !has_handicap(pplayer, H_MAP));
     if (result.dest != NULL) {
       /* we did find a new destination for the unit */
       dest = result.dest;
@@ -874,6 +874,7 @@ void dai_manage_cities(struct ai_type *ait, struct player *pplayer)
 
   /* Initialize the infrastructure cache, which is used shortly. */
   initialize_infrastructure_cache(pplayer);
+  dai_danger_map_open(ait, pplayer, &(wld.map));
   city_list_iterate(pplayer->cities, pcity) {
     struct ai_city *city_data = def_ai_city_data(pcity, ait);
     struct adv_choice *choice;
@@ -915,6 +916,7 @@ void dai_manage_cities(struct ai_type *ait, struct player *pplayer)
     TIMING_LOG(AIT_CITY_SETTLERS, TIMER_STOP);
     ADV_CHOICE_ASSERT(city_data->choice);
   } city_list_iterate_end;
+  dai_danger_map_close(ait, pplayer);
   /* Reset auto settler state for the next run. */
   dai_auto_settler_reset(ait, pplayer);
 
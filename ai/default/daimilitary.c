@@ -69,6 +69,18 @@
 
 #include "daimilitary.h"
 
+/* The reverse maps towards all the cities of an AI player, shared by the
+ * danger assessment of each of these cities. */
+struct dai_danger_map {
+  const struct civ_map *dmap;
+  int assess_turns;
+  bool omnimap;
+  int num_targets;
+  struct tile **targets;
+  bool *is_target;              /* By tile index */
+  struct pf_reverse_map *maps[MAX_NUM_PLAYER_SLOTS];
+};
+
 static unsigned int assess_danger(struct ai_type *ait, struct city *pcity,
                                   const struct civ_map *dmap,
                                   player_unit_list_getter ul_cb);
@@ -362,6 +374,7 @@ static unsigned int assess_danger_unit(const struct city *pcity,
   const struct unit *ferry;
   unsigned int danger;
   int mod;
+  bool reachable;
 
   *move_time = PF_IMPOSSIBLE_MC;
 
@@ -371,15 +384,26 @@ static unsigned int assess_danger_unit(const struct city *pcity,
                   / punittype->paratroopers_range);
   }
 
-  if (pf_reverse_map_unit_position(pcity_map, punit, &pos)
+  TIMING_LOG(AIT_DANGER_PATHS, TIMER_START);
+  reachable = pf_reverse_map_unit_target_position(pcity_map, punit, ptile,
+                                                  &pos);
+  TIMING_LOG(AIT_DANGER_PATHS, TIMER_STOP);
+  if (reachable
       && (PF_IMPOSSIBLE_MC == *move_time
           || *move_time > pos.turn)) {
     *move_time = pos.turn;
   }
 
   if (unit_transported(punit)
-      && (ferry = unit_transport_get(punit))
-      && pf_reverse_map_unit_position(pcity_map, ferry, &pos)) {
+      && (ferry = unit_transport_get(punit))) {
+    TIMING_LOG(AIT_DANGER_PATHS, TIMER_START);
+    reachable = pf_reverse_map_unit_target_position(pcity_map, ferry, ptile,
+                                                    &pos);
+    TIMING_LOG(AIT_DANGER_PATHS, TIMER_STOP);
+  } else {
+    reachable = FALSE;
+  }
+  if (reachable) {
     if ((PF_IMPOSSIBLE_MC == *move_time
          || *move_time > pos.turn)) {
       *move_time = pos.turn;
@@ -406,6 +430,108 @@ static unsigned int assess_danger_unit(const struct city *pcity,
   return danger * 100 / MAX(mod, 1);
 }
 
+/**********************************************************************//**
+  How many turns ahead pplayer looks for units threatening its cities.
+**************************************************************************/
+static int assess_danger_turns(const struct player *pplayer)
+{
+  if (player_is_cpuhog(pplayer)) {
+    return 6;
+  }
+
+#ifdef FREECIV_WEB
+  return has_handicap(pplayer, H_ASSESS_DANGER_LIMITED) ? 2 : 3;
+#else
+  return 3;
+#endif
+}
+
+/**********************************************************************//**
+  Start sharing the path-finding of the danger assessment between all the
+  cities of pplayer. Each enemy unit is then checked against all the
+  cities at once, instead of once per city, which matters as both the
+  number of cities and the number of enemy units grow.
+
+  The enemy units must not move before dai_danger_map_close() is called.
+**************************************************************************/
+void dai_danger_map_open(struct ai_type *ait, struct player *pplayer,
+                         const struct civ_map *dmap)
+{
+  struct ai_plr *plr_data = def_ai_player_data(pplayer, ait);
+  struct dai_danger_map *danger;
+  int i = 0;
+
+  fc_assert_ret(NULL == plr_data->danger);
+
+  if (0 == city_list_size(pplayer->cities)) {
+    return;
+  }
+
+  danger = fc_calloc(1, sizeof(*danger));
+  danger->dmap = dmap;
+  danger->assess_turns = assess_danger_turns(pplayer);
+  danger->omnimap = !has_handicap(pplayer, H_MAP);
+  danger->num_targets = city_list_size(pplayer->cities);
+  danger->targets = fc_malloc(danger->num_targets
+                              * sizeof(*danger->targets));
+  danger->is_target = fc_calloc(MAP_INDEX_SIZE, sizeof(*danger->is_target));
+  city_list_iterate(pplayer->cities, pcity) {
+    danger->targets[i++] = city_tile(pcity);
+    danger->is_target[tile_index(city_tile(pcity))] = TRUE;
+  } city_list_iterate_end;
+
+  plr_data->danger = danger;
+}
+
+/**********************************************************************//**
+  Stop sharing the danger assessment path-finding of pplayer's cities.
+**************************************************************************/
+void dai_danger_map_close(struct ai_type *ait, struct player *pplayer)
+{
+  struct ai_plr *plr_data = def_ai_player_data(pplayer, ait);
+  struct dai_danger_map *danger = plr_data->danger;
+  size_t i;
+
+  if (NULL == danger) {
+    return;
+  }
+
+  for (i = 0; i < ARRAY_SIZE(danger->maps); i++) {
+    if (NULL != danger->maps[i]) {
+      pf_reverse_map_destroy(danger->maps[i]);
+    }
+  }
+  free(danger->targets);
+  free(danger->is_target);
+  free(danger);
+  plr_data->danger = NULL;
+}
+
+/**********************************************************************//**
+  Return the shared reverse map of the units of aplayer towards the city,
+  or NULL if the city is not covered by the danger map.
+**************************************************************************/
+static struct pf_reverse_map *
+dai_danger_map_get(struct dai_danger_map *danger, const struct city *pcity,
+                   const struct player *aplayer)
+{
+  struct pf_reverse_map **pmap;
+
+  if (!danger->is_target[tile_index(city_tile(pcity))]) {
+    return NULL;
+  }
+
+  pmap = danger->maps + player_index(aplayer);
+  if (NULL == *pmap) {
+    *pmap = pf_reverse_map_new_for_tiles(aplayer, danger->targets,
+                                         danger->num_targets,
+                                         danger->assess_turns,
+                                         danger->omnimap, danger->dmap);
+  }
+
+  return *pmap;
+}
+
 /**********************************************************************//**
   Call assess_danger() for all cities owned by pplayer.
 
@@ -416,9 +542,11 @@ void dai_assess_danger_player(struct ai_type *ait, struct player *pplayer,
 {
   /* Do nothing if game is not running */
   if (S_S_RUNNING == server_state()) {
+    dai_danger_map_open(ait, pplayer, dmap);
     city_list_iterate(pplayer->cities, pcity) {
       (void) assess_danger(ait, pcity, dmap, NULL);
     } city_list_iterate_end;
+    dai_danger_map_close(ait, pplayer);
   }
 }
 
@@ -494,6 +622,8 @@ static unsigned int assess_danger(struct ai_type *ait, struct city *pcity,
   bool defender_type_handled[U_LAST];
   int assess_turns;
   bool omnimap;
+  struct ai_plr *plr_data = def_ai_player_data(pplayer, ait);
+  struct dai_danger_map *danger;
 
   TIMING_LOG(AIT_DANGER, TIMER_START);
 
@@ -542,20 +672,13 @@ static unsigned int assess_danger(struct ai_type *ait, struct city *pcity,
     }
   } unit_list_iterate_end;
 
-  if (player_is_cpuhog(pplayer)) {
-    assess_turns = 6;
-  } else {
-    assess_turns = 3;
-#ifdef FREECIV_WEB
-    assess_turns = has_handicap(pplayer, H_ASSESS_DANGER_LIMITED) ? 2 : 3;
-#endif
-  }
-
+  assess_turns = assess_danger_turns(pplayer);
   omnimap = !has_handicap(pplayer, H_MAP);
+  danger = (ul_cb == NULL ? plr_data->danger : NULL);
 
   /* Check. */
   players_iterate(aplayer) {
-    struct pf_reverse_map *pcity_map;
+    struct pf_reverse_map *pcity_map = NULL;
     struct unit_list *units;
 
     if (!adv_is_player_dangerous(pplayer, aplayer)) {
@@ -564,8 +687,13 @@ static unsigned int assess_danger(struct ai_type *ait, struct city *pcity,
     /* Note that we still consider the units of players we are not (yet)
      * at war with. */
 
-    pcity_map = pf_reverse_map_new_for_city(pcity, aplayer, assess_turns,
-                                            omnimap, dmap);
+    if (danger != NULL) {
+      pcity_map = dai_danger_map_get(danger, pcity, aplayer);
+    }
+    if (pcity_map == NULL) {
+      pcity_map = pf_reverse_map_new_for_city(pcity, aplayer, assess_turns,
+                                              omnimap, dmap);
+    }
 
     if (ul_cb != NULL) {
       units = ul_cb(aplayer);
@@ -650,8 +778,9 @@ static unsigned int assess_danger(struct ai_type *ait, struct city *pcity,
       total_danger += vulnerability;
     } unit_list_iterate_end;
 
-    pf_reverse_map_destroy(pcity_map);
-
+    if (danger == NULL || pcity_map != danger->maps[player_index(aplayer)]) {
+      pf_reverse_map_destroy(pcity_map);
+    }
   } players_iterate_end;
 
   if (total_danger) {
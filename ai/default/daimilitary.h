@@ -38,6 +38,9 @@ struct adv_choice *military_advisor_choose_build(struct ai_type *ait,
                                                  player_unit_list_getter ul_cb);
 void dai_assess_danger_player(struct ai_type *ait, struct player *pplayer,
                               const struct civ_map *dmap);
+void dai_danger_map_open(struct ai_type *ait, struct player *pplayer,
+                         const struct civ_map *dmap);
+void dai_danger_map_close(struct ai_type *ait, struct player *pplayer);
 int assess_defense_quadratic(struct ai_type *ait, struct city *pcity);
 int assess_defense_unit(struct ai_type *ait, struct city *pcity,
                         struct unit *punit, bool igwall);
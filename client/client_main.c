@@ -260,7 +260,7 @@ static void client_game_init(void)
   mapimg_init(mapimg_client_tile_known, mapimg_client_tile_terrain,
               mapimg_client_tile_owner, mapimg_client_tile_city,
               mapimg_client_tile_unit, mapimg_client_plrcolor_count,
-              mapimg_client_plrcolor_get);
+              mapimg_client_plrcolor_get, NULL);
   animations_init();
 }
 
@@ -730,6 +730,8 @@ void actions_free(void)
     action_enabler_list_iterate(action_enablers_by_action[act], enabler) {
       requirement_vector_free(&enabler->actor_reqs);
       requirement_vector_free(&enabler->target_reqs);
+      req_program_free(&enabler->actor_reqs_prog);
+      req_program_free(&enabler->target_reqs_prog);
       free(enabler);
     } action_enabler_list_iterate_end;
 
@@ -1343,6 +1345,8 @@ struct action_enabler *action_enabler_new(void)
   enabler->disabled = FALSE;
   requirement_vector_init(&enabler->actor_reqs);
   requirement_vector_init(&enabler->target_reqs);
+  req_program_init(&enabler->actor_reqs_prog);
+  req_program_init(&enabler->target_reqs_prog);
 
   /* Make sure that action doesn't end up as a random value that happens to
    * be a valid action id. */
@@ -1356,6 +1360,8 @@ struct action_enabler *action_enabler_new(void)
 **************************************************************************/
 void action_enabler_close(struct action_enabler *enabler)
 {
+  req_program_free(&enabler->actor_reqs_prog);
+  req_program_free(&enabler->target_reqs_prog);
   free(enabler);
 }
 
@@ -2788,16 +2794,18 @@ static bool is_enabler_active(const struct action_enabler *enabler,
 			      const struct output_type *target_output,
 			      const struct specialist *target_specialist)
 {
-  return are_reqs_active(actor_player, target_player, actor_city,
-                         actor_building, actor_tile,
-                         actor_unit, actor_unittype,
-                         actor_output, actor_specialist, NULL,
-                         &enabler->actor_reqs, RPT_CERTAIN)
-      && are_reqs_active(target_player, actor_player, target_city,
-                         target_building, target_tile,
-                         target_unit, target_unittype,
-                         target_output, target_specialist, NULL,
-                         &enabler->target_reqs, RPT_CERTAIN);
+  return are_reqs_active_prog(actor_player, target_player, actor_city,
+                              actor_building, actor_tile,
+                              actor_unit, actor_unittype,
+                              actor_output, actor_specialist, NULL,
+                              &enabler->actor_reqs,
+                              &enabler->actor_reqs_prog, RPT_CERTAIN)
+      && are_reqs_active_prog(target_player, actor_player, target_city,
+                              target_building, target_tile,
+                              target_unit, target_unittype,
+                              target_output, target_specialist, NULL,
+                              &enabler->target_reqs,
+                              &enabler->target_reqs_prog, RPT_CERTAIN);
 }
 
 /**********************************************************************//**
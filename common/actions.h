@@ -290,6 +290,10 @@ struct action_enabler
   action_id action;
   struct requirement_vector actor_reqs;
   struct requirement_vector target_reqs;
+
+  /* Compiled forms of the above */
+  struct req_program actor_reqs_prog;
+  struct req_program target_reqs_prog;
 };
 
 #define enabler_get_action(_enabler_) action_by_number(_enabler_->action)
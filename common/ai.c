@@ -43,6 +43,9 @@ static struct ai_timer *ai_timer_player_get(const struct player *pplayer);
 static struct ai_timer *aitimers = NULL;
 static struct ai_timer *aitimer_plrs = NULL;
 
+/* Set while AI code may run on several threads at once. */
+static bool aitimers_suspended = FALSE;
+
 /*************************************************************************//**
   Allocate memory for Start the timer for the AI of a player.
 *****************************************************************************/
@@ -105,6 +108,15 @@ void ai_timer_free(void)
   aitimer_plrs = NULL;
 }
 
+/*************************************************************************//**
+  Stop updating the AI timers while AI code may run on several threads at
+  once; they are shared and not safe to update concurrently.
+*****************************************************************************/
+void ai_timers_suspend(bool suspend)
+{
+  aitimers_suspended = suspend;
+}
+
 /*************************************************************************//**
   Get the timer for the AI.
 *****************************************************************************/
@@ -152,7 +164,13 @@ static struct ai_timer *ai_timer_player_get(const struct player *pplayer)
 *****************************************************************************/
 void ai_timer_start(const struct ai_type *ai)
 {
-  struct ai_timer *aitimer = ai_timer_get(ai);
+  struct ai_timer *aitimer;
+
+  if (aitimers_suspended) {
+    return;
+  }
+
+  aitimer = ai_timer_get(ai);
 
   fc_assert_ret(aitimer != NULL);
   fc_assert_ret(aitimer->timer != NULL);
@@ -173,7 +191,13 @@ void ai_timer_start(const struct ai_type *ai)
 *****************************************************************************/
 void ai_timer_stop(const struct ai_type *ai)
 {
-  struct ai_timer *aitimer = ai_timer_get(ai);
+  struct ai_timer *aitimer;
+
+  if (aitimers_suspended) {
+    return;
+  }
+
+  aitimer = ai_timer_get(ai);
 
   fc_assert_ret(aitimer != NULL);
   fc_assert_ret(aitimer->timer != NULL);
@@ -199,7 +223,13 @@ void ai_timer_stop(const struct ai_type *ai)
 *****************************************************************************/
 void ai_timer_player_start(const struct player *pplayer)
 {
-  struct ai_timer *aitimer = ai_timer_player_get(pplayer);
+  struct ai_timer *aitimer;
+
+  if (aitimers_suspended) {
+    return;
+  }
+
+  aitimer = ai_timer_player_get(pplayer);
 
   fc_assert_ret(aitimer != NULL);
   fc_assert_ret(aitimer->timer != NULL);
@@ -222,7 +252,13 @@ void ai_timer_player_start(const struct player *pplayer)
 *****************************************************************************/
 void ai_timer_player_stop(const struct player *pplayer)
 {
-  struct ai_timer *aitimer = ai_timer_player_get(pplayer);
+  struct ai_timer *aitimer;
+
+  if (aitimers_suspended) {
+    return;
+  }
+
+  aitimer = ai_timer_player_get(pplayer);
 
   fc_assert_ret(aitimer != NULL);
   fc_assert_ret(aitimer->timer != NULL);
@@ -24,7 +24,7 @@ extern "C" {
  * structure below. When changing mandatory capability part, check that
  * there's enough reserved_xx pointers in the end of the structure for
  * taking to use without need to bump mandatory capability again. */
-#define FC_AI_MOD_CAPSTR "+Freeciv-3.1-ai-module-2019.Feb.16"
+#define FC_AI_MOD_CAPSTR "+Freeciv-3.1-ai-module-2019.Feb.16 plan_phase"
 
 /* Timers for all AI activities. Define it to get statistics about the AI. */
 #ifdef FREECIV_DEBUG
@@ -324,7 +324,13 @@ struct ai_type
      * version to do so.
      * When mandatory capability then changes again, please add new reservations to
      * replace those taken to use. */
-    void (*reserved_01)(void);
+    /* Called for player AI type of every AI player of the phase in the
+     * beginning of the phase, before first_activities of any of them.
+     * Calls for different players may run concurrently on several
+     * threads. The world must then be treated as read-only, and only the
+     * player's own AI data written. */
+    void (*plan_phase)(struct player *pplayer);
+
     void (*reserved_02)(void);
     void (*reserved_03)(void);
     void (*reserved_04)(void);
@@ -350,6 +356,7 @@ void ai_timer_start(const struct ai_type *ai);
 void ai_timer_stop(const struct ai_type *ai);
 void ai_timer_player_start(const struct player *pplayer);
 void ai_timer_player_stop(const struct player *pplayer);
+void ai_timers_suspend(bool suspend);
 #else
 #define ai_timer_init(...) (void) 0
 #define ai_timer_free(...) (void) 0
@@ -357,6 +364,7 @@ void ai_timer_player_stop(const struct player *pplayer);
 #define ai_timer_stop(...) (void) 0
 #define ai_timer_player_start(...) (void) 0
 #define ai_timer_player_stop(...) (void) 0
+#define ai_timers_suspend(...) (void) 0
 #endif /* DEBUG_AITIMERS */
 
 #define ai_type_iterate(NAME_ai)                        \
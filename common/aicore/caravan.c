@@ -19,10 +19,13 @@
 
 /* utility */
 #include "log.h"
+#include "mem.h"
 
 /* common */
 #include "game.h"
+#include "movement.h"
 #include "traderoutes.h"
+#include "unit.h"
 
 /* aicore */
 #include "path_finding.h"
@@ -190,27 +193,215 @@ int caravan_result_compare(const struct caravan_result *a,
   }
 }
 
+/* A city reached by a search of the caravan_planner. */
+struct caravan_dest {
+  int city_id;
+  int turn;
+  int moves_left;
+};
+
+/* The cities found by one path finding run, in distance order. */
+struct caravan_search {
+  /* What the search depends on. */
+  int src_id;
+  const struct player *owner;
+  const struct unit_type *utype;
+  struct tile *start_tile;
+  int moves_left, move_rate, fuel_left;
+  bool omniscient;
+  int end_time;
+
+  int num_dests, dests_alloc;
+  struct caravan_dest *dests;
+};
+
+/* trade_benefit() of a city pair, valid as long as neither city changed
+ * owner or its trade routes. */
+struct caravan_trade {
+  bool countloser;
+  const struct player *dest_owner;
+  int src_routes, dest_routes;
+  double benefit;
+};
+
+/* Trade benefits, by the id of the destination city. */
+#define SPECHASH_TAG caravan_trade
+#define SPECHASH_INT_KEY_TYPE
+#define SPECHASH_IDATA_TYPE struct caravan_trade *
+#define SPECHASH_IDATA_FREE (caravan_trade_hash_data_free_fn_t) free
+#include "spechash.h"
+
+/* Trade benefits of the routes from one source city. */
+struct caravan_src {
+  int src_id;
+  struct caravan_trade_hash *trades;
+};
+
+struct caravan_planner {
+  int num_searches, searches_alloc;
+  struct caravan_search *searches;
+
+  int num_srcs, srcs_alloc;
+  struct caravan_src *srcs;
+};
+
 /************************************************************************//**
-  We use the path finding in several places.
-  This provides a single implementation of that.  It is critical that
-  this function be re-entrant since we call it recursively.
+  Create a planner which keeps the searches of caravans with the same
+  home city, type and starting point, and the trade benefits of the city
+  pairs evaluated for them. The caravans given to it should all belong to
+  one player, and it should be destroyed when the world changes much, for
+  instance at the end of the phase.
+****************************************************************************/
+struct caravan_planner *caravan_planner_new(void)
+{
+  return fc_calloc(1, sizeof(struct caravan_planner));
+}
+
+/************************************************************************//**
+  Free the planner and all it knows.
+****************************************************************************/
+void caravan_planner_destroy(struct caravan_planner *planner)
+{
+  int i;
+
+  for (i = 0; i < planner->num_searches; i++) {
+    free(planner->searches[i].dests);
+  }
+  free(planner->searches);
+
+  for (i = 0; i < planner->num_srcs; i++) {
+    caravan_trade_hash_destroy(planner->srcs[i].trades);
+  }
+  free(planner->srcs);
 
+  free(planner);
+}
+
+/************************************************************************//**
   The callback should return TRUE if it wants to stop searching,
   FALSE otherwise.
 ****************************************************************************/
 typedef bool (*search_callback) (void *data, const struct city *pcity,
                                  int arrival_turn, int arrival_moves_left);
 
+/************************************************************************//**
+  Find the search of the planner which the caravan would repeat, or add
+  an empty one, and return its index. Returns -1 if the search can't be
+  shared.
+
+  The index, not a pointer, has to be kept while running callbacks; they
+  may add searches of their own.
+****************************************************************************/
+static int caravan_planner_search(struct caravan_planner *planner,
+                                  const struct unit *caravan,
+                                  const struct city *src,
+                                  const struct pf_parameter *pfparam,
+                                  int end_time, bool *found)
+{
+  struct caravan_search *psearch;
+  int i;
+
+  *found = FALSE;
+
+  if (planner == NULL || src == NULL
+      || pfparam->transported_by_initially != NULL
+      || pfparam->cargo_depth != 0 || BV_ISSET_ANY(pfparam->cargo_types)) {
+    return -1;
+  }
+
+  for (i = 0; i < planner->num_searches; i++) {
+    psearch = planner->searches + i;
+
+    if (psearch->src_id == src->id
+        && psearch->owner == pfparam->owner
+        && psearch->utype == unit_type_get(caravan)
+        && psearch->start_tile == pfparam->start_tile
+        && psearch->moves_left == pfparam->moves_left_initially
+        && psearch->move_rate == pfparam->move_rate
+        && psearch->fuel_left == pfparam->fuel_left_initially
+        && psearch->omniscient == pfparam->omniscience) {
+      if (psearch->end_time < end_time) {
+        /* Searched not far enough; do it again. */
+        psearch->end_time = end_time;
+        psearch->num_dests = 0;
+      } else {
+        *found = TRUE;
+      }
+
+      return i;
+    }
+  }
+
+  if (planner->num_searches >= planner->searches_alloc) {
+    planner->searches_alloc = MAX(8, 2 * planner->searches_alloc);
+    planner->searches = fc_realloc(planner->searches,
+                                   planner->searches_alloc
+                                   * sizeof(*planner->searches));
+  }
+
+  psearch = planner->searches + planner->num_searches++;
+  psearch->src_id = src->id;
+  psearch->owner = pfparam->owner;
+  psearch->utype = unit_type_get(caravan);
+  psearch->start_tile = pfparam->start_tile;
+  psearch->moves_left = pfparam->moves_left_initially;
+  psearch->move_rate = pfparam->move_rate;
+  psearch->fuel_left = pfparam->fuel_left_initially;
+  psearch->omniscient = pfparam->omniscience;
+  psearch->end_time = end_time;
+  psearch->num_dests = 0;
+  psearch->dests_alloc = 0;
+  psearch->dests = NULL;
+
+  return planner->num_searches - 1;
+}
+
+/************************************************************************//**
+  Record a city reached by the search.
+****************************************************************************/
+static void caravan_search_add(struct caravan_search *psearch,
+                               const struct city *pcity,
+                               int turn, int moves_left)
+{
+  struct caravan_dest *pdest;
+
+  if (psearch->num_dests >= psearch->dests_alloc) {
+    psearch->dests_alloc = MAX(16, 2 * psearch->dests_alloc);
+    psearch->dests = fc_realloc(psearch->dests,
+                                psearch->dests_alloc
+                                * sizeof(*psearch->dests));
+  }
+
+  pdest = psearch->dests + psearch->num_dests++;
+  pdest->city_id = pcity->id;
+  pdest->turn = turn;
+  pdest->moves_left = moves_left;
+}
+
+/************************************************************************//**
+  We use the path finding in several places.
+  This provides a single implementation of that.  It is critical that
+  this function be re-entrant since we call it recursively.
+
+  With a planner, the cities found are kept and a later search by the same
+  kind of caravan from the same city and tile just goes through them
+  again, in the same order.
+****************************************************************************/
 static void caravan_search_from(const struct unit *caravan,
                                 const struct caravan_parameter *param,
+                                const struct city *src,
                                 struct tile *start_tile,
                                 int turns_before, int moves_left_before,
                                 bool omniscient,
+                                struct caravan_planner *planner,
                                 search_callback callback,
                                 void *callback_data) {
   struct pf_map *pfm;
   struct pf_parameter pfparam;
   int end_time;
+  int search;
+  bool found;
+  int i;
 
   end_time = param->horizon - turns_before;
 
@@ -219,29 +410,63 @@ static void caravan_search_from(const struct unit *caravan,
   pfparam.start_tile = start_tile;
   pfparam.moves_left_initially = moves_left_before;
   pfparam.omniscience = omniscient;
-  pfm = pf_map_new(&pfparam);
-
-  /* For every tile in distance order:
-     quit if we've exceeded the maximum number of turns
-     otherwise, run the callback if we're on a city.
-     Do-while loop rather than while loop to make sure to process the
-     start tile.
-   */
-  pf_map_positions_iterate(pfm, pos, TRUE) {
+
+  search = caravan_planner_search(planner, caravan, src, &pfparam,
+                                  end_time, &found);
+
+  if (search < 0 || !found) {
+    pfm = pf_map_new(&pfparam);
+
+    /* For every tile in distance order:
+       quit if we've exceeded the maximum number of turns
+       otherwise, record the city for the planner.
+       Do-while loop rather than while loop to make sure to process the
+       start tile.
+     */
+    pf_map_positions_iterate(pfm, pos, TRUE) {
+      struct city *pcity;
+
+      if (pos.turn > end_time) {
+        break;
+      }
+
+      pcity = tile_city(pos.tile);
+      if (pcity == NULL) {
+        continue;
+      }
+
+      if (search >= 0) {
+        caravan_search_add(planner->searches + search, pcity, pos.turn,
+                           pos.moves_left);
+      } else if (callback(callback_data, pcity, turns_before + pos.turn,
+                          pos.moves_left)) {
+        break;
+      }
+    } pf_map_positions_iterate_end;
+
+    pf_map_destroy(pfm);
+
+    if (search < 0) {
+      return;
+    }
+  }
+
+  /* Run the callback on the cities found, as far as this search goes. */
+  for (i = 0; i < planner->searches[search].num_dests; i++) {
+    struct caravan_dest *pdest = planner->searches[search].dests + i;
     struct city *pcity;
 
-    if (pos.turn > end_time) {
+    if (pdest->turn > end_time) {
       break;
     }
 
-    pcity = tile_city(pos.tile);
-    if (pcity && callback(callback_data, pcity, turns_before + pos.turn,
-                          pos.moves_left)) {
+    pcity = game_city_by_number(pdest->city_id);
+    if (pcity != NULL
+        && callback(callback_data, pcity, turns_before + pdest->turn,
+                    pdest->moves_left)) {
       break;
     }
-  } pf_map_positions_iterate_end;
-
-  pf_map_destroy(pfm);
+  }
 }
 
 /************************************************************************//**
@@ -363,6 +588,62 @@ static double trade_benefit(const struct player *caravan_owner,
   }
 }
 
+/************************************************************************//**
+  trade_benefit(), remembered by the planner (if there is one) for the
+  next caravan.
+****************************************************************************/
+static double planned_trade_benefit(struct caravan_planner *planner,
+                                    const struct player *caravan_owner,
+                                    const struct city *src,
+                                    const struct city *dest,
+                                    const struct caravan_parameter *param)
+{
+  struct caravan_src *psrc = NULL;
+  struct caravan_trade *ptrade;
+  int i;
+
+  if (planner == NULL || !param->consider_trade || param->convert_trade) {
+    return trade_benefit(caravan_owner, src, dest, param);
+  }
+
+  for (i = 0; i < planner->num_srcs; i++) {
+    if (planner->srcs[i].src_id == src->id) {
+      psrc = planner->srcs + i;
+      break;
+    }
+  }
+
+  if (psrc == NULL) {
+    if (planner->num_srcs >= planner->srcs_alloc) {
+      planner->srcs_alloc = MAX(8, 2 * planner->srcs_alloc);
+      planner->srcs = fc_realloc(planner->srcs,
+                                 planner->srcs_alloc
+                                 * sizeof(*planner->srcs));
+    }
+    psrc = planner->srcs + planner->num_srcs++;
+    psrc->src_id = src->id;
+    psrc->trades = caravan_trade_hash_new();
+  }
+
+  if (!caravan_trade_hash_lookup(psrc->trades, dest->id, &ptrade)) {
+    ptrade = fc_malloc(sizeof(*ptrade));
+    caravan_trade_hash_insert(psrc->trades, dest->id, ptrade);
+  } else if (ptrade->countloser == param->account_for_broken_routes
+             && ptrade->dest_owner == city_owner(dest)
+             && ptrade->src_routes == city_num_trade_routes(src)
+             && ptrade->dest_routes == city_num_trade_routes(dest)) {
+    return ptrade->benefit;
+  }
+
+  ptrade->benefit = trade_benefit(caravan_owner, src, dest, param);
+  ptrade->countloser = param->account_for_broken_routes;
+  ptrade->dest_owner = city_owner(dest);
+  ptrade->src_routes = city_num_trade_routes(src);
+  ptrade->dest_routes = city_num_trade_routes(dest);
+
+  return ptrade->benefit;
+}
+
 /************************************************************************//**
   Check the benefit of helping build the wonder in dest.
   This is based on how much the caravan would help if it arrived
@@ -457,9 +738,11 @@ static bool does_foreign_trade_param_allow(const struct caravan_parameter *param
   by the src, dest, and arrival_time fields of the result:  Fills in
   the value and help_wonder fields.
   Assumes the owner of src is the owner of the caravan.
+  The planner may be NULL.
 ****************************************************************************/
 static bool get_discounted_reward(const struct unit *caravan,
                                   const struct caravan_parameter *parameter,
+                                  struct caravan_planner *planner,
                                   struct caravan_result *result)
 {
   double trade;
@@ -504,7 +787,8 @@ static bool get_discounted_reward(const struct unit *caravan,
     return FALSE;
   }
 
-  trade = trade_benefit(pplayer_src, src, dest, parameter);
+  trade = planned_trade_benefit(planner, pplayer_src, src, dest,
+                                parameter);
   windfall = windfall_benefit(caravan, src, dest, parameter);
   if (consider_wonder) {
     wonder = wonder_benefit(caravan, arrival_time, dest, parameter);
@@ -567,7 +851,7 @@ static void caravan_evaluate_notransit(const struct unit *caravan,
   const struct city *src = game_city_by_number(caravan->homecity);
 
   caravan_result_init(result, src, dest, 0);
-  get_discounted_reward(caravan, param, result);
+  get_discounted_reward(caravan, param, NULL, result);
 }
 
 /************************************************************************//**
@@ -589,7 +873,7 @@ static bool cewt_callback(void *vdata, const struct city *dest,
 
   if (dest == data->result->dest) {
     data->result->arrival_time = arrival_time;
-    get_discounted_reward(data->caravan, data->param, data->result);
+    get_discounted_reward(data->caravan, data->param, NULL, data->result);
     return TRUE;
   } else {
     return FALSE;
@@ -612,8 +896,9 @@ static void caravan_evaluate_withtransit(const struct unit *caravan,
   data.param = param;
   caravan_result_init(result, game_city_by_number(caravan->homecity),
                       dest, 0);
-  caravan_search_from(caravan, param, unit_tile(caravan), 0,
-                      caravan->moves_left, omniscient, cewt_callback, &data);
+  caravan_search_from(caravan, param, NULL, unit_tile(caravan), 0,
+                      caravan->moves_left, omniscient, NULL,
+                      cewt_callback, &data);
 }
 
 /************************************************************************//**
@@ -637,6 +922,7 @@ void caravan_evaluate(const struct unit *caravan,
 ****************************************************************************/
 static void caravan_find_best_destination_notransit(const struct unit *caravan,
                                          const struct caravan_parameter *param,
+                                         struct caravan_planner *planner,
                                                     struct caravan_result *best)
 {
   struct caravan_result current;
@@ -650,7 +936,7 @@ static void caravan_find_best_destination_notransit(const struct unit *caravan,
     if (does_foreign_trade_param_allow(param, src_owner, dest_owner)) {
       city_list_iterate(dest_owner->cities, dest) {
         caravan_result_init(&current, pcity, dest, 0);
-        get_discounted_reward(caravan, param, &current);
+        get_discounted_reward(caravan, param, planner, &current);
 
         if (caravan_result_compare(&current, best) > 0) {
           *best = current;
@@ -667,6 +953,7 @@ static void caravan_find_best_destination_notransit(const struct unit *caravan,
 struct cfbdw_data {
   const struct caravan_parameter *param;
   const struct unit *caravan;
+  struct caravan_planner *planner;
   struct caravan_result *best;
 };
 
@@ -678,7 +965,8 @@ static bool cfbdw_callback(void *vdata, const struct city *dest,
 
   caravan_result_init(&current, data->best->src, dest, arrival_time);
 
-  get_discounted_reward(data->caravan, data->param, &current);
+  get_discounted_reward(data->caravan, data->param, data->planner,
+                        &current);
   if (caravan_result_compare(&current, data->best) > 0) {
     *data->best = current;
   }
@@ -696,13 +984,15 @@ static void caravan_find_best_destination_withtransit(
     int turns_before,
     int moves_left,
     bool omniscient,
-    struct caravan_result *result) 
+    struct caravan_planner *planner,
+    struct caravan_result *result)
 {
   struct tile *start_tile;
   struct cfbdw_data data;
 
   data.param = param;
   data.caravan = caravan;
+  data.planner = planner;
   data.best = result;
   caravan_result_init(data.best, src, NULL, 0);
 
@@ -712,8 +1002,9 @@ static void caravan_find_best_destination_withtransit(
     start_tile = unit_tile(caravan);
   }
 
-  caravan_search_from(caravan, param, start_tile, turns_before,
-                      caravan->moves_left, omniscient, cfbdw_callback, &data);
+  caravan_search_from(caravan, param, src, start_tile, turns_before,
+                      caravan->moves_left, omniscient, planner,
+                      cfbdw_callback, &data);
 }
 
 /************************************************************************//**
@@ -724,16 +1015,33 @@ static void caravan_find_best_destination_withtransit(
 void caravan_find_best_destination(const struct unit *caravan,
                                    const struct caravan_parameter *parameter,
                                    struct caravan_result *result, bool omniscient)
+{
+  caravan_planner_find_best_destination(NULL, caravan, parameter, result,
+                                        omniscient);
+}
+
+/************************************************************************//**
+  As caravan_find_best_destination(), but share the path finding and the
+  trade benefits with the other caravans given to the planner (which may
+  be NULL).
+****************************************************************************/
+void caravan_planner_find_best_destination(struct caravan_planner *planner,
+                                           const struct unit *caravan,
+                                           const struct caravan_parameter *parameter,
+                                           struct caravan_result *result,
+                                           bool omniscient)
 {
   if (parameter->ignore_transit_time) {
-    caravan_find_best_destination_notransit(caravan, parameter, result);
+    caravan_find_best_destination_notransit(caravan, parameter, planner,
+                                            result);
   } else {
     const struct city *src = game_city_by_number(caravan->homecity);
 
     fc_assert(src != NULL);
 
     caravan_find_best_destination_withtransit(caravan, parameter, src, 0,
-                                              caravan->moves_left, omniscient, result);
+                                              caravan->moves_left, omniscient,
+                                              planner, result);
   }
 }
 
@@ -742,6 +1050,7 @@ void caravan_find_best_destination(const struct unit *caravan,
 ****************************************************************************/
 static void caravan_optimize_notransit(const struct unit *caravan,
                                        const struct caravan_parameter *param,
+                                       struct caravan_planner *planner,
                                        struct caravan_result *best)
 {
   struct player *pplayer = unit_owner(caravan);
@@ -756,7 +1065,7 @@ static void caravan_optimize_notransit(const struct unit *caravan,
           struct caravan_result current;
 
           caravan_result_init(&current, src, dest, 0);
-          get_discounted_reward(caravan, param, &current);
+          get_discounted_reward(caravan, param, planner, &current);
           if (caravan_result_compare(&current, best) > 0) {
             *best = current;
           }
@@ -775,6 +1084,7 @@ struct cowt_data {
   const struct unit *caravan;
   struct caravan_result *best;
   bool omniscient;
+  struct caravan_planner *planner;
 };
 
 /************************************************************************//**
@@ -795,7 +1105,7 @@ static bool cowt_callback(void *vdata, const struct city *pcity,
                       pcity, arrival_time);
 
   /* first, see what benefit we'd get from not changing home city */
-  get_discounted_reward(caravan, data->param, &current);
+  get_discounted_reward(caravan, data->param, data->planner, &current);
   if (caravan_result_compare(&current, data->best) > 0) {
     *data->best = current;
   }
@@ -803,8 +1113,8 @@ static bool cowt_callback(void *vdata, const struct city *pcity,
   /* next, try changing home city (if we're allowed to) */
   if (city_owner(pcity) == unit_owner(caravan)) {
     caravan_find_best_destination_withtransit(
-                caravan, data->param, pcity, arrival_time, moves_left, data->omniscient,
-                &current);
+                caravan, data->param, pcity, arrival_time, moves_left,
+                data->omniscient, data->planner, &current);
     if (caravan_result_compare(&current, data->best) > 0) {
       *data->best = current;
     }
@@ -820,7 +1130,8 @@ static bool cowt_callback(void *vdata, const struct city *pcity,
 static void caravan_optimize_withtransit(const struct unit *caravan,
                                          const struct caravan_parameter *param,
                                          struct caravan_result *result,
-                                         bool omniscient)
+                                         bool omniscient,
+                                         struct caravan_planner *planner)
 {
   struct cowt_data data;
 
@@ -828,9 +1139,12 @@ static void caravan_optimize_withtransit(const struct unit *caravan,
   data.caravan = caravan;
   data.best = result;
   data.omniscient = omniscient;
+  data.planner = planner;
   caravan_result_init_zero(data.best);
-  caravan_search_from(caravan, param, unit_tile(caravan), 0,
-                      caravan->moves_left, omniscient, cowt_callback, &data);
+  caravan_search_from(caravan, param,
+                      game_city_by_number(caravan->homecity),
+                      unit_tile(caravan), 0, caravan->moves_left, omniscient,
+                      planner, cowt_callback, &data);
 }
 
 /************************************************************************//**
@@ -841,10 +1155,25 @@ static void caravan_optimize_withtransit(const struct unit *caravan,
 void caravan_optimize_allpairs(const struct unit *caravan,
                                const struct caravan_parameter *param,
                                struct caravan_result *result, bool omniscient)
+{
+  caravan_planner_optimize_allpairs(NULL, caravan, param, result, omniscient);
+}
+
+/************************************************************************//**
+  As caravan_optimize_allpairs(), but share the path finding and the
+  trade benefits with the other caravans given to the planner (which may
+  be NULL).
+****************************************************************************/
+void caravan_planner_optimize_allpairs(struct caravan_planner *planner,
+                                       const struct unit *caravan,
+                                       const struct caravan_parameter *param,
+                                       struct caravan_result *result,
+                                       bool omniscient)
 {
   if (param->ignore_transit_time) {
-    caravan_optimize_notransit(caravan, param, result);
+    caravan_optimize_notransit(caravan, param, planner, result);
   } else {
-    caravan_optimize_withtransit(caravan, param, result, omniscient);
+    caravan_optimize_withtransit(caravan, param, result, omniscient,
+                                 planner);
   }
 }
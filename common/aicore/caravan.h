@@ -155,6 +155,28 @@ void caravan_optimize_allpairs(const struct unit *caravan,
                                const struct caravan_parameter *parameter,
                                struct caravan_result *result, bool omniscient);
 
+/**
+ * A planner serves several caravans of one player: caravans of the same
+ * type starting from the same home city and tile share one path finding
+ * run, and the trade benefit of each city pair is computed once.
+ */
+struct caravan_planner;
+
+struct caravan_planner *caravan_planner_new(void);
+void caravan_planner_destroy(struct caravan_planner *planner);
+
+void caravan_planner_find_best_destination(struct caravan_planner *planner,
+                                           const struct unit *caravan,
+                                           const struct caravan_parameter *parameter,
+                                           struct caravan_result *result,
+                                           bool omniscient);
+
+void caravan_planner_optimize_allpairs(struct caravan_planner *planner,
+                                       const struct unit *caravan,
+                                       const struct caravan_parameter *parameter,
+                                       struct caravan_result *result,
+                                       bool omniscient);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -61,6 +61,10 @@
  * slightly faster.  It evaluates about half as many solutions, but each
  * candidate solution is more expensive due to the lack of cacheing.
  *
+ * Some state is still kept for each city between queries, but it is
+ * checked against the city every time: the lattice, and the previous best
+ * solution to start the search from (see struct cm_cache).
+ *
  * We use highly specific knowledge about how the city computes its stats
  * in two places:
  * - setting the min_production array.  Ideally the city should tell us.
@@ -101,6 +105,9 @@ static struct {
     struct timer *wall_timer;
     int query_count;
     int apply_count;
+    int lattice_reuse_count;
+    int lattice_update_count;
+    int warm_start_count;
     const char *name;
   } greedy, opt;
 
@@ -174,6 +181,34 @@ struct cm_tile_type {
 };
 
 
+/*
+ * The solver state kept for a city between queries (see
+ * cm_query_result()).
+ *
+ * The lattice only depends on what the city map tiles and the specialists
+ * produce.  The signature of those is checked on every query, and only
+ * the tiles whose entries changed are moved in the lattice; the city size
+ * only decides which nodes the search gets.  The best solution of the
+ * previous query is used to seed the next search: it's usually still good
+ * after small changes, and a good solution known at once lets the search
+ * prune most branches.
+ */
+struct cm_cache {
+  int radius_sq;
+  int sig_len;
+  int *signature;       /* See compute_lattice_signature(). */
+  bool lattice_valid;
+  struct tile_type_vector lattice;
+
+  bool have_solution;   /* The previous best solution. */
+  bool *worked;         /* Indexed by city map index, for radius_sq. */
+  citizens specialists[SP_MAX];
+};
+
+/* Elements of the signature for each city map tile and specialist type:
+ * whether it can be used, then its production. */
+#define SIG_STRIDE (1 + O_LAST)
+
 /*
  * A partial solution.
  * Has the count of workers assigned to each lattice position, and
@@ -198,8 +233,9 @@ struct cm_state {
   struct cm_parameter parameter;
   /*mutable*/ struct city *pcity;
 
-  /* the tile lattice */
+  /* the tile lattice; its types are owned by the cache of the city */
   struct tile_type_vector lattice;
+  struct cm_cache *cache;
   struct tile_type_vector lattice_by_prod[O_LAST];
 
   /* the best known solution, and its fitness */
@@ -278,6 +314,7 @@ static void cm_result_copy(struct cm_result *result,
 
 static double estimate_fitness(const struct cm_state *state,
 			       const int production[]);
+static void tile_type_vector_free_all(struct tile_type_vector *vec);
 static bool choice_is_promising(struct cm_state *state, int newchoice,
                                 bool negative_ok);
 
@@ -311,11 +348,24 @@ void cm_init_citymap(void)
 }
 
 /************************************************************************//**
-  Clear the cache for a city.
+  Clear the cache for a city.  The cache is checked against the city on
+  every query, so this is only needed to release its memory.
 ****************************************************************************/
 void cm_clear_cache(struct city *pcity)
 {
-  /* The B&B algorithm doesn't have city caches so there's nothing to do. */
+  struct cm_cache *cache = pcity->cm_cache;
+
+  if (NULL == cache) {
+    return;
+  }
+
+  if (cache->lattice_valid) {
+    tile_type_vector_free_all(&cache->lattice);
+  }
+  free(cache->signature);
+  free(cache->worked);
+  free(cache);
+  pcity->cm_cache = NULL;
 }
 
 /************************************************************************//**
@@ -972,7 +1022,8 @@ static void tile_type_lattice_add(struct tile_type_vector *lattice,
     tile_type_vector_append(lattice, type);
   }
 
-  /* Finally, add the tile to the tile type. */
+  /* Finally, add the tile to the tile type, keeping the tiles in city map
+   * index order as a lattice built from scratch has them. */
   if (!type->is_specialist) {
     struct cm_tile tile;
 
@@ -980,9 +1031,75 @@ static void tile_type_lattice_add(struct tile_type_vector *lattice,
     tile.index = tindex;
 
     tile_vector_append(&type->tiles, tile);
+    for (i = type->tiles.size - 1;
+         i > 0 && type->tiles.p[i - 1].index > tindex; i--) {
+      type->tiles.p[i] = type->tiles.p[i - 1];
+    }
+    type->tiles.p[i] = tile;
   }
 }
 
+/************************************************************************//**
+  Remove 'ptype' from the vector, keeping the order of the others.
+****************************************************************************/
+static void tile_type_vector_remove_type(struct tile_type_vector *vec,
+                                         const struct cm_tile_type *ptype)
+{
+  int i;
+
+  for (i = 0; i < vec->size; i++) {
+    if (vec->p[i] == ptype) {
+      tile_type_vector_remove(vec, i);
+      return;
+    }
+  }
+}
+
+/************************************************************************//**
+  Unlink the type from the lattice and free it.
+****************************************************************************/
+static void tile_type_lattice_free(struct tile_type_vector *lattice,
+                                   struct cm_tile_type *ptype)
+{
+  tile_type_vector_iterate(&ptype->better_types, other) {
+    tile_type_vector_remove_type(&other->worse_types, ptype);
+  } tile_type_vector_iterate_end;
+  tile_type_vector_iterate(&ptype->worse_types, other) {
+    tile_type_vector_remove_type(&other->better_types, ptype);
+  } tile_type_vector_iterate_end;
+  tile_type_vector_remove_type(lattice, ptype);
+
+  tile_type_destroy(ptype);
+  free(ptype);
+}
+
+/************************************************************************//**
+  Remove the tile with city map index 'tindex' from the lattice.  Its type
+  goes away with it if it was the last tile of that type.
+****************************************************************************/
+static void tile_type_lattice_remove(struct tile_type_vector *lattice,
+                                     int tindex)
+{
+  tile_type_vector_iterate(lattice, ptype) {
+    int i;
+
+    if (ptype->is_specialist) {
+      continue;
+    }
+    for (i = 0; i < ptype->tiles.size; i++) {
+      if (ptype->tiles.p[i].index == tindex) {
+        tile_vector_remove(&ptype->tiles, i);
+        if (0 == ptype->tiles.size) {
+          tile_type_lattice_free(lattice, ptype);
+        }
+        return;
+      }
+    }
+  } tile_type_vector_iterate_end;
+
+  fc_assert(FALSE);
+}
+
 /*
  * Add the specialist types to the lattice.
  */
@@ -992,7 +1109,7 @@ static void tile_type_lattice_add(struct tile_type_vector *lattice,
   tile_type for each specialist type.
 ****************************************************************************/
 static void init_specialist_lattice_nodes(struct tile_type_vector *lattice,
-					  const struct city *pcity)
+                                          const int *signature)
 {
   struct cm_tile_type type;
 
@@ -1002,11 +1119,11 @@ static void init_specialist_lattice_nodes(struct tile_type_vector *lattice,
   /* for each specialist type, create a tile_type that has as production
    * the bonus for the specialist (if the city is allowed to use it) */
   specialist_type_iterate(i) {
-    if (city_can_use_specialist(pcity, i)) {
+    const int *ssig = signature + i * SIG_STRIDE;
+
+    if (ssig[0]) {
       type.spec = i;
-      output_type_iterate(output) {
-	type.production[output] = get_specialist_output(pcity, i, output);
-      } output_type_iterate_end;
+      memcpy(type.production, ssig + 1, sizeof(type.production));
 
       tile_type_lattice_add(lattice, &type, 0);
     }
@@ -1101,71 +1218,6 @@ static void top_sort_lattice(struct tile_type_vector *lattice)
   tile_type_vector_free(&vectors[1]);
 }
 
-/************************************************************************//**
-  Remove unreachable lattice nodes to speed up processing later.
-  This doesn't reduce the number of evaluations we do, it just
-  reduces the number of times we loop over and reject tile types
-  we can never use.
-
-  A node is unreachable if there are fewer available workers
-  than are needed to fill up all predecessors.  A node at depth
-  two needs three workers to be reachable, for example (two to fill
-  the predecessors, and one for the tile).  We remove a node if
-  its depth is equal to the city size, or larger.
-
-  We could clean up the tile arrays in each type (if we have two workers,
-  we can use only the first tile of a depth 1 tile type), but that
-  wouldn't save us anything later.
-****************************************************************************/
-static void clean_lattice(struct tile_type_vector *lattice,
-			  const struct city *pcity)
-{
-  int i, j; /* i is the index we read, j is the index we write */
-  struct tile_type_vector tofree;
-  bool forced_loop = FALSE;
-
-  /* We collect the types we want to remove and free them in one fell 
-     swoop at the end, in order to avoid memory errors.  */
-  tile_type_vector_init(&tofree);
-
-  /* forced_loop is workaround for what seems like gcc optimization
-   * bug.
-   * This applies to -O2 optimization on some distributions. */
-  if (lattice->size > 0) {
-    forced_loop = TRUE;
-  }
-  for (i = 0, j = 0; i < lattice->size || forced_loop; i++) {
-    struct cm_tile_type *ptype = lattice->p[i];
-
-    forced_loop = FALSE;
-
-    if (ptype->lattice_depth >= city_size_get(pcity)) {
-      tile_type_vector_append(&tofree, ptype);
-    } else {
-      /* Remove links to children that are being removed. */
-
-      int ci, cj; /* 'c' for 'child'; read from ci, write to cj */
-
-      lattice->p[j] = ptype;
-      lattice->p[j]->lattice_index = j;
-      j++;
-
-      for (ci = 0, cj = 0; ci < ptype->worse_types.size; ci++) {
-        const struct cm_tile_type *ptype2 = ptype->worse_types.p[ci];
-
-        if (ptype2->lattice_depth < city_size_get(pcity)) {
-          ptype->worse_types.p[cj] = ptype->worse_types.p[ci];
-          cj++;
-        }
-      }
-      ptype->worse_types.size = cj;
-    }
-  }
-  lattice->size = j;
-
-  tile_type_vector_free_all(&tofree);
-}
-
 /************************************************************************//**
   Determine the estimated_fitness fields, and sort by that.
   estimate_fitness is later, in a section of code that isolates
@@ -1195,10 +1247,57 @@ static void sort_lattice_by_fitness(const struct cm_state *state,
 }
 
 /************************************************************************//**
-  Create the lattice.
+  Return the length of the lattice signature of the city.
+****************************************************************************/
+static int lattice_signature_length(const struct city *pcity)
+{
+  return (city_map_tiles_from_city(pcity) + specialist_count())
+         * SIG_STRIDE;
+}
+
+/************************************************************************//**
+  Compute everything the lattice of the city is built from into
+  'signature': for each city map index whether the tile can be worked and
+  what it produces, then the same for each specialist type.
+****************************************************************************/
+static void compute_lattice_signature(const struct city *pcity,
+                                      int *signature)
+{
+  struct cm_tile_type type;
+  struct tile *pcenter = city_tile(pcity);
+  int *spec_sig = signature + city_map_tiles_from_city(pcity) * SIG_STRIDE;
+
+  memset(signature, 0, lattice_signature_length(pcity) * sizeof(*signature));
+
+  city_tile_iterate_index(city_map_radius_sq_get(pcity), pcenter, ptile,
+                          ctindex) {
+    if (!is_free_worked(pcity, ptile) && city_can_work_tile(pcity, ptile)) {
+      int *tsig = signature + ctindex * SIG_STRIDE;
+
+      compute_tile_production(pcity, ptile, &type);
+      tsig[0] = TRUE;
+      memcpy(tsig + 1, type.production, sizeof(type.production));
+    }
+  } city_tile_iterate_index_end;
+
+  specialist_type_iterate(i) {
+    if (city_can_use_specialist(pcity, i)) {
+      int *ssig = spec_sig + i * SIG_STRIDE;
+
+      ssig[0] = TRUE;
+      output_type_iterate(output) {
+        ssig[1 + output] = get_specialist_output(pcity, i, output);
+      } output_type_iterate_end;
+    }
+  } specialist_type_iterate_end;
+}
+
+/************************************************************************//**
+  Create the lattice from the signature of the city.
 ****************************************************************************/
 static void init_tile_lattice(struct city *pcity,
-                              struct tile_type_vector *lattice)
+                              struct tile_type_vector *lattice,
+                              const int *signature)
 {
   struct cm_tile_type type;
   struct tile *pcenter = city_tile(pcity);
@@ -1208,25 +1307,108 @@ static void init_tile_lattice(struct city *pcity,
 
   city_tile_iterate_index(city_map_radius_sq_get(pcity), pcenter, ptile,
                           ctindex) {
-    if (is_free_worked(pcity, ptile)) {
-      continue;
-    } else if (city_can_work_tile(pcity, ptile)) {
-      compute_tile_production(pcity, ptile, &type); /* clobbers type */
+    const int *tsig = signature + ctindex * SIG_STRIDE;
+
+    if (tsig[0]) {
+      memcpy(type.production, tsig + 1, sizeof(type.production));
       tile_type_lattice_add(lattice, &type, ctindex); /* copy type if needed */
     }
   } city_tile_iterate_index_end;
 
   /* Add all the specialists into the lattice.  */
-  init_specialist_lattice_nodes(lattice, pcity);
+  init_specialist_lattice_nodes(lattice, signature
+                                + city_map_tiles_from_city(pcity)
+                                  * SIG_STRIDE);
 
-  /* Set the lattice_depth fields, and clean up unreachable nodes. */
+  /* Set the lattice_depth fields.  The nodes the city is too small to
+   * reach are left in, see init_cached_lattice(). */
   top_sort_lattice(lattice);
-  clean_lattice(lattice, pcity);
 
   /* All done now. */
   print_lattice(LOG_LATTICE, lattice);
 }
 
+/************************************************************************//**
+  Compare tile types by the order init_tile_lattice() adds them in: tile
+  types by their first city map index, then the specialists.
+****************************************************************************/
+static int compare_tile_type_by_build_order(const void *va, const void *vb)
+{
+  const struct cm_tile_type *a = *(struct cm_tile_type * const *) va;
+  const struct cm_tile_type *b = *(struct cm_tile_type * const *) vb;
+
+  if (a->is_specialist != b->is_specialist) {
+    return a->is_specialist ? 1 : -1;
+  }
+  if (a->is_specialist) {
+    return a->spec - b->spec;
+  }
+
+  return a->tiles.p[0].index - b->tiles.p[0].index;
+}
+
+/************************************************************************//**
+  Bring the lattice built from 'old_sig' up to date with 'new_sig', moving
+  only the tiles whose entries differ.  Specialists are all added again if
+  any of them changed.  The result is the lattice init_tile_lattice() would
+  build from 'new_sig', in the same order, so the searches over it don't
+  change.
+****************************************************************************/
+static void update_tile_lattice(const struct city *pcity,
+                                struct tile_type_vector *lattice,
+                                const int *old_sig, const int *new_sig)
+{
+  int ntiles = city_map_tiles_from_city(pcity);
+  int spec_offset = ntiles * SIG_STRIDE;
+  struct cm_tile_type type;
+  int i;
+
+  /* Take the changed tiles out first, so that the types they leave empty
+   * are gone before any tile is added back. */
+  for (i = 0; i < ntiles; i++) {
+    const int *old_tsig = old_sig + i * SIG_STRIDE;
+
+    if (old_tsig[0]
+        && 0 != memcmp(old_tsig, new_sig + i * SIG_STRIDE,
+                       SIG_STRIDE * sizeof(*old_tsig))) {
+      tile_type_lattice_remove(lattice, i);
+    }
+  }
+
+  tile_type_init(&type);
+  for (i = 0; i < ntiles; i++) {
+    const int *tsig = new_sig + i * SIG_STRIDE;
+
+    if (tsig[0]
+        && 0 != memcmp(tsig, old_sig + i * SIG_STRIDE,
+                       SIG_STRIDE * sizeof(*tsig))) {
+      memcpy(type.production, tsig + 1, sizeof(type.production));
+      tile_type_lattice_add(lattice, &type, i);
+    }
+  }
+
+  if (0 != memcmp(old_sig + spec_offset, new_sig + spec_offset,
+                  specialist_count() * SIG_STRIDE * sizeof(*old_sig))) {
+    for (i = lattice->size - 1; i >= 0; i--) {
+      if (lattice->p[i]->is_specialist) {
+        tile_type_lattice_free(lattice, lattice->p[i]);
+      }
+    }
+    init_specialist_lattice_nodes(lattice, new_sig + spec_offset);
+  }
+
+  /* Ties in the fitness sort are broken by the order of the lattice, so
+   * it has to be the one of a lattice built from scratch. */
+  qsort(lattice->p, lattice->size, sizeof(*lattice->p),
+        compare_tile_type_by_build_order);
+  for (i = 0; i < lattice->size; i++) {
+    lattice->p[i]->lattice_index = i;
+  }
+  top_sort_lattice(lattice);
+
+  print_lattice(LOG_LATTICE, lattice);
+}
+
 
 /****************************************************************************
 
@@ -1297,12 +1479,19 @@ static void add_workers(struct partial_solution *soln,
   if (old_worker_count == tile_type_num_tiles(ptype)) {
     fc_assert_ret(number < 0);
     tile_type_vector_iterate(&ptype->worse_types, other) {
+      if (other->lattice_index < 0) {
+        /* Out of reach at this city size. */
+        continue;
+      }
       soln->prereqs_filled[other->lattice_index]--;
       fc_assert_ret(soln->prereqs_filled[other->lattice_index] >= 0);
     } tile_type_vector_iterate_end;
   } else if (soln->worker_counts[itype] == tile_type_num_tiles(ptype)) {
     fc_assert_ret(number > 0);
     tile_type_vector_iterate(&ptype->worse_types, other) {
+      if (other->lattice_index < 0) {
+        continue;
+      }
       soln->prereqs_filled[other->lattice_index]++;
       fc_assert_ret(soln->prereqs_filled[other->lattice_index]
           <= tile_type_num_prereqs(other));
@@ -1812,6 +2001,87 @@ static bool bb_next(struct cm_state *state, bool negative_ok)
   return FALSE;
 }
 
+/************************************************************************//**
+  Fill the lattice of the state from the one kept for the city, bringing
+  it up to date first if anything it is built from has changed since the
+  last query.
+
+  The cached lattice holds every node, and only the reachable ones go to
+  the state.  A node is unreachable if there are fewer available workers
+  than are needed to fill up all predecessors.  A node at depth two needs
+  three workers to be reachable, for example (two to fill the
+  predecessors, and one for the tile).  We leave out a node if its depth
+  is equal to the city size, or larger, and set its lattice_index to -1.
+  Keeping them in the cache means the lattice doesn't depend on the city
+  size.
+****************************************************************************/
+static void init_cached_lattice(struct cm_state *state)
+{
+  struct city *pcity = state->pcity;
+  struct cm_cache *cache = pcity->cm_cache;
+  int radius_sq = city_map_radius_sq_get(pcity);
+  int sig_len = lattice_signature_length(pcity);
+  int *signature = fc_malloc(sig_len * sizeof(*signature));
+
+  compute_lattice_signature(pcity, signature);
+
+  if (NULL == cache) {
+    cache = fc_calloc(1, sizeof(*cache));
+    pcity->cm_cache = cache;
+  }
+
+  if (cache->radius_sq != radius_sq || NULL == cache->worked) {
+    free(cache->worked);
+    cache->worked = fc_calloc(city_map_tiles(radius_sq),
+                              sizeof(*cache->worked));
+    cache->have_solution = FALSE;
+  }
+
+  if (cache->lattice_valid
+      && cache->radius_sq == radius_sq
+      && cache->sig_len == sig_len) {
+    if (0 == memcmp(cache->signature, signature,
+                    sig_len * sizeof(*signature))) {
+      free(signature);
+#ifdef GATHER_TIME_STATS
+      performance.opt.lattice_reuse_count++;
+#endif
+    } else {
+      update_tile_lattice(pcity, &cache->lattice, cache->signature,
+                          signature);
+      free(cache->signature);
+      cache->signature = signature;
+#ifdef GATHER_TIME_STATS
+      performance.opt.lattice_update_count++;
+#endif
+    }
+  } else {
+    if (cache->lattice_valid) {
+      tile_type_vector_free_all(&cache->lattice);
+    }
+    free(cache->signature);
+    cache->signature = signature;
+    cache->sig_len = sig_len;
+    cache->radius_sq = radius_sq;
+
+    tile_type_vector_init(&cache->lattice);
+    init_tile_lattice(pcity, &cache->lattice, cache->signature);
+    cache->lattice_valid = TRUE;
+  }
+
+  /* Searches reorder their copy, so keep the order of the cached lattice
+   * as it was built. */
+  tile_type_vector_iterate(&cache->lattice, ptype) {
+    if (ptype->lattice_depth < city_size_get(pcity)) {
+      ptype->lattice_index = state->lattice.size;
+      tile_type_vector_append(&state->lattice, ptype);
+    } else {
+      ptype->lattice_index = -1;
+    }
+  } tile_type_vector_iterate_end;
+  state->cache = cache;
+}
+
 /************************************************************************//**
   Initialize the state for the branch-and-bound algorithm.
 ****************************************************************************/
@@ -1831,7 +2101,7 @@ static struct cm_state *cm_state_init(struct city *pcity, bool negative_ok)
 
   /* create the lattice */
   tile_type_vector_init(&state->lattice);
-  init_tile_lattice(pcity, &state->lattice);
+  init_cached_lattice(state);
   numtypes = tile_type_vector_size(&state->lattice);
 
   get_tax_rates(pplayer, rates);
@@ -1932,7 +2202,8 @@ static void end_search(struct cm_state *state)
 ****************************************************************************/
 static void cm_state_free(struct cm_state *state)
 {
-  tile_type_vector_free_all(&state->lattice);
+  /* The types themselves belong to the cache. */
+  tile_type_vector_free(&state->lattice);
   output_type_iterate(stat_index) {
     tile_type_vector_free(&state->lattice_by_prod[stat_index]);
   } output_type_iterate_end;
@@ -1945,6 +2216,154 @@ static void cm_state_free(struct cm_state *state)
 }
 
 
+/************************************************************************//**
+  Seed the search with the best solution of the previous query, or with
+  the current arrangement of the city if there is none, as long as it
+  still fits the lattice.  It becomes the best known solution, so that the
+  search only has to look for better ones.  Must be called before any
+  other solution is applied to the city.
+
+  Only a seed that meets the constraints is kept, and it doesn't set
+  min_luxury: the pruning heuristic isn't exact, and would otherwise
+  sometimes cut off better solutions that the search from scratch finds.
+****************************************************************************/
+static void warm_start(struct cm_state *state, bool negative_ok)
+{
+  struct cm_cache *cache = state->cache;
+  struct city *pcity = state->pcity;
+  int ntiles = city_map_tiles_from_city(pcity);
+  const int *spec_sig = cache->signature + ntiles * SIG_STRIDE;
+  const struct cm_tile_type **by_index;
+  const bool *worked;
+  const citizens *spec_counts;
+  bool *main_worked = NULL;
+  int *counts;
+  int ncitizens = 0, i;
+  bool ok = TRUE;
+
+  if (cache->have_solution) {
+    worked = cache->worked;
+    spec_counts = cache->specialists;
+  } else {
+    main_worked = fc_calloc(ntiles, sizeof(*main_worked));
+    city_tile_iterate_index(city_map_radius_sq_get(pcity), city_tile(pcity),
+                            ptile, ctindex) {
+      main_worked[ctindex] = (tile_worked(ptile) == pcity);
+    } city_tile_iterate_index_end;
+    worked = main_worked;
+    spec_counts = pcity->specialists;
+  }
+
+  /* Find the type of each tile and specialist of the solution. */
+  counts = fc_calloc(num_types(state), sizeof(*counts));
+  by_index = fc_calloc(ntiles, sizeof(*by_index));
+  tile_type_vector_iterate(&state->lattice, ptype) {
+    if (!ptype->is_specialist) {
+      for (i = 0; i < ptype->tiles.size; i++) {
+        by_index[ptype->tiles.p[i].index] = ptype;
+      }
+    }
+  } tile_type_vector_iterate_end;
+
+  for (i = 0; ok && i < ntiles; i++) {
+    if (!worked[i] || is_free_worked_index(i)) {
+      continue;
+    }
+    if (NULL == by_index[i]) {
+      /* The tile can't be worked any more, or isn't worth it. */
+      ok = FALSE;
+    } else {
+      counts[by_index[i]->lattice_index]++;
+      ncitizens++;
+    }
+  }
+
+  specialist_type_iterate(sp) {
+    const int *ssig = spec_sig + sp * SIG_STRIDE;
+    bool found = FALSE;
+
+    if (!ok || 0 == spec_counts[sp]) {
+      continue;
+    }
+    if (ssig[0]) {
+      /* Specialists with the same production share a type. */
+      tile_type_vector_iterate(&state->lattice, ptype) {
+        if (ptype->is_specialist
+            && 0 == memcmp(ptype->production, ssig + 1,
+                           sizeof(ptype->production))) {
+          counts[ptype->lattice_index] += spec_counts[sp];
+          ncitizens += spec_counts[sp];
+          found = TRUE;
+          break;
+        }
+      } tile_type_vector_iterate_end;
+    }
+    ok = found;
+  } specialist_type_iterate_end;
+
+  ok = ok && ncitizens == city_size_get(pcity);
+  for (i = 0; ok && i < num_types(state); i++) {
+    ok = (counts[i] <= tile_type_num_tiles(tile_type_get(state, i)));
+  }
+
+  if (ok) {
+    struct partial_solution seed;
+    struct cm_fitness value;
+    int min_luxury = state->min_luxury;
+
+    init_partial_solution(&seed, num_types(state), city_size_get(pcity),
+                          negative_ok);
+    for (i = 0; i < num_types(state); i++) {
+      add_workers(&seed, i, counts[i], state);
+    }
+    value = evaluate_solution(state, &seed);
+    state->min_luxury = min_luxury;
+
+    if (value.sufficient) {
+      copy_partial_solution(&state->best, &seed, state);
+      state->best_value = value;
+#ifdef GATHER_TIME_STATS
+      performance.current->warm_start_count++;
+#endif
+    }
+    destroy_partial_solution(&seed);
+  }
+
+  free(counts);
+  free(by_index);
+  free(main_worked);
+}
+
+/************************************************************************//**
+  Keep the best solution found in the cache, to seed the next query.
+****************************************************************************/
+static void cache_best_solution(struct cm_state *state)
+{
+  struct cm_cache *cache = state->cache;
+  int i, j;
+
+  if (0 != state->best.idle) {
+    return;
+  }
+
+  memset(cache->worked, 0, city_map_tiles(cache->radius_sq)
+                           * sizeof(*cache->worked));
+  memset(cache->specialists, 0, sizeof(cache->specialists));
+  for (i = 0; i < num_types(state); i++) {
+    const struct cm_tile_type *ptype = tile_type_get(state, i);
+    int nworkers = state->best.worker_counts[i];
+
+    if (ptype->is_specialist) {
+      cache->specialists[ptype->spec] += nworkers;
+    } else {
+      for (j = 0; j < nworkers; j++) {
+        cache->worked[tile_get(ptype, j)->index] = TRUE;
+      }
+    }
+  }
+  cache->have_solution = TRUE;
+}
+
 /************************************************************************//**
   Run B&B until we find the best solution.
 ****************************************************************************/
@@ -1965,6 +2384,8 @@ static void cm_find_best_solution(struct cm_state *state,
   /* make a backup of the city to restore at the very end */
   memcpy(&backup, state->pcity, sizeof(backup));
 
+  warm_start(state, negative_ok);
+
   if (player_is_cpuhog(city_owner(state->pcity))) {
     max_count = CPUHOG_CM_MAX_LOOP;
   } else {
@@ -1988,6 +2409,7 @@ static void cm_find_best_solution(struct cm_state *state,
 
   /* convert to the caller's format */
   convert_solution_to_result(state, &state->best, result);
+  cache_best_solution(state);
 
   memcpy(state->pcity, &backup, sizeof(backup));
 
@@ -2293,8 +2715,11 @@ static void print_performance(struct one_perf *counts)
   applies = counts->apply_count;
 
   log_base(LOG_TIME_STATS,
-           "CM-%s: overall=%fs queries=%d %fms / query, %d applies",
-           counts->name, s, queries, ms / q, applies);
+           "CM-%s: overall=%fs queries=%d %fms / query, %d applies, "
+           "%d lattices reused, %d updated, %d warm starts",
+           counts->name, s, queries, ms / q, applies,
+           counts->lattice_reuse_count, counts->lattice_update_count,
+           counts->warm_start_count);
 }
 #endif /* GATHER_TIME_STATS */
 
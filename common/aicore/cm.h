@@ -77,8 +77,9 @@ void cm_query_result(struct city *pcity,
 		     struct cm_result *result, bool negative_ok);
 
 /*
- * Call this function if the city has changed. To be safe call it
- * everytime before you call cm_query_result().
+ * Releases the solver state kept for the city between queries. The state
+ * is checked against the city on every query, so this is not needed when
+ * the city has changed.
  */
 void cm_clear_cache(struct city *pcity);
 
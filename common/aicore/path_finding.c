@@ -15,11 +15,16 @@
 #include <fc_config.h>
 #endif
 
+#include <limits.h>
+#include <string.h>
+
 /* utility */
 #include "bitvector.h"
+#include "fcthread.h"
 #include "log.h"
 #include "mem.h"
 #include "support.h"
+#include "timing.h"
 
 /* common */
 #include "game.h"
@@ -37,6 +42,12 @@
 #define SPECPQ_DATA_TYPE int
 #define SPECPQ_PRIORITY_TYPE int
 #include "specpq.h"
+
+/* Queue of goal-directed searches, see pf_normal_map_goal_priority(). */
+#define SPECPQ_TAG map_index_goal
+#define SPECPQ_DATA_TYPE int
+#define SPECPQ_PRIORITY_TYPE int64_t
+#include "specpq.h"
 #define INITIAL_QUEUE_SIZE 100
 
 #ifdef FREECIV_DEBUG
@@ -56,8 +67,8 @@ enum pf_mode {
 #endif /* PF_DEBUG */
 
 enum pf_node_status {
-  NS_UNINIT = 0,        /* memory is calloced, hence zero means
-                         * uninitialised. */
+  NS_UNINIT = 0,        /* memory is zeroed when a node is first
+                         * accessed, hence zero means uninitialised. */
   NS_INIT,              /* node initialized, but we didn't search a route
                          * yet. */
   NS_NEW,               /* the optimal route isn't found yet. */
@@ -91,11 +102,224 @@ struct pf_map {
   /* Private data. */
   struct tile *tile;          /* The current position (aka iterator). */
   struct pf_parameter params; /* Initial parameters. */
+  struct pf_workspace *ws;    /* Memory of the map. */
+  unsigned short generation;  /* Copy of ws->generation. */
 };
 
 /* Down-cast macro. */
 #define PF_MAP(pfm) ((struct pf_map *) (pfm))
 
+/* ========================== Workspace pool ============================= */
+
+/* Frees whatever the nodes of a lattice own, whatever their generation. */
+typedef void (*pf_lattice_purge_fn) (void *lattice, int size);
+
+/* The memory of a pf_map: its lattice and queues. Destroyed maps give it
+ * back to the pool for the next map of the same type. Instead of zeroing
+ * the lattice each time, the workspace generation is bumped: nodes of an
+ * older generation are considered NS_UNINIT and reset on first access. */
+struct pf_workspace {
+  enum pf_map_type type;
+  int size;                     /* MAP_INDEX_SIZE at allocation. */
+  size_t node_size;
+  pf_lattice_purge_fn purge;
+  unsigned short generation;
+
+  void *lattice;
+  struct map_index_pq *queue;
+  struct map_index_pq *queue2;  /* Danger or waited queue. */
+
+  unsigned long nodes;          /* Nodes reset for the current map. */
+  unsigned long expanded;       /* Nodes processed by the current map. */
+  struct timer *timer;
+};
+
+/* Workspaces kept around, per map type. */
+#define PF_WORKSPACE_POOL_SIZE 4
+
+static struct {
+  bool initialized;
+  fc_mutex mutex;
+  int count[PF_MAP_TYPE_COUNT];
+  struct pf_workspace *idle[PF_MAP_TYPE_COUNT][PF_WORKSPACE_POOL_SIZE];
+  struct pf_map_stats stats[PF_MAP_TYPE_COUNT];
+} pf_pool;
+
+/************************************************************************//**
+  Free the workspace and all its memory.
+****************************************************************************/
+static void pf_workspace_destroy(struct pf_workspace *ws)
+{
+  if (NULL != ws->purge) {
+    ws->purge(ws->lattice, ws->size);
+  }
+  free(ws->lattice);
+  map_index_pq_destroy(ws->queue);
+  if (NULL != ws->queue2) {
+    map_index_pq_destroy(ws->queue2);
+  }
+  timer_destroy(ws->timer);
+  free(ws);
+}
+
+/************************************************************************//**
+  Get a workspace for a new map of the given type, from the pool if
+  possible. All the nodes of the returned lattice are stale.
+****************************************************************************/
+static struct pf_workspace *pf_workspace_get(enum pf_map_type type,
+                                             size_t node_size,
+                                             pf_lattice_purge_fn purge,
+                                             bool need_queue2)
+{
+  struct pf_workspace *ws = NULL;
+
+  if (pf_pool.initialized) {
+    fc_allocate_mutex(&pf_pool.mutex);
+    while (NULL == ws && 0 < pf_pool.count[type]) {
+      ws = pf_pool.idle[type][--pf_pool.count[type]];
+      if (ws->size != MAP_INDEX_SIZE) {
+        /* Left from a map of another size. */
+        pf_workspace_destroy(ws);
+        ws = NULL;
+      }
+    }
+    pf_pool.stats[type].maps++;
+    if (NULL != ws) {
+      pf_pool.stats[type].reused++;
+    } else {
+      pf_pool.stats[type].allocated++;
+    }
+    fc_release_mutex(&pf_pool.mutex);
+  }
+
+  if (NULL == ws) {
+    ws = fc_malloc(sizeof(*ws));
+    ws->type = type;
+    ws->size = MAP_INDEX_SIZE;
+    ws->node_size = node_size;
+    ws->purge = purge;
+    ws->generation = 0;
+    ws->lattice = fc_calloc(ws->size, node_size);
+    ws->queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
+    ws->queue2 = (need_queue2 ? map_index_pq_new(INITIAL_QUEUE_SIZE)
+                  : NULL);
+    ws->timer = timer_new(TIMER_USER, TIMER_ACTIVE);
+  }
+
+  if (0 == ++ws->generation) {
+    /* Wrapped around, really clear the lattice this time. */
+    if (NULL != ws->purge) {
+      ws->purge(ws->lattice, ws->size);
+    }
+    memset(ws->lattice, 0, ws->size * ws->node_size);
+    ws->generation = 1;
+  }
+  ws->nodes = 0;
+  ws->expanded = 0;
+  timer_clear(ws->timer);
+  timer_start(ws->timer);
+
+  return ws;
+}
+
+/************************************************************************//**
+  Give back the workspace of a destroyed map.
+****************************************************************************/
+static void pf_workspace_release(struct pf_workspace *ws)
+{
+  timer_stop(ws->timer);
+  map_index_pq_clear(ws->queue);
+  if (NULL != ws->queue2) {
+    map_index_pq_clear(ws->queue2);
+  }
+
+  if (pf_pool.initialized) {
+    fc_allocate_mutex(&pf_pool.mutex);
+    pf_pool.stats[ws->type].nodes += ws->nodes;
+    pf_pool.stats[ws->type].expanded += ws->expanded;
+    pf_pool.stats[ws->type].seconds += timer_read_seconds(ws->timer);
+    if (PF_WORKSPACE_POOL_SIZE > pf_pool.count[ws->type]
+        && ws->size == MAP_INDEX_SIZE) {
+      pf_pool.idle[ws->type][pf_pool.count[ws->type]++] = ws;
+      ws = NULL;
+    }
+    fc_release_mutex(&pf_pool.mutex);
+  }
+
+  if (NULL != ws) {
+    pf_workspace_destroy(ws);
+  }
+}
+
+/************************************************************************//**
+  Enable the recycling of the memory of destroyed pf_maps.
+****************************************************************************/
+void pf_workspaces_init(void)
+{
+  if (pf_pool.initialized) {
+    return;
+  }
+
+  fc_init_mutex(&pf_pool.mutex);
+  memset(pf_pool.count, 0, sizeof(pf_pool.count));
+  memset(pf_pool.stats, 0, sizeof(pf_pool.stats));
+  pf_pool.initialized = TRUE;
+}
+
+/************************************************************************//**
+  Free the memory kept for reuse and stop keeping any.
+****************************************************************************/
+void pf_workspaces_free(void)
+{
+  int type;
+
+  if (!pf_pool.initialized) {
+    return;
+  }
+
+  fc_allocate_mutex(&pf_pool.mutex);
+  pf_pool.initialized = FALSE;
+  for (type = 0; type < PF_MAP_TYPE_COUNT; type++) {
+    while (0 < pf_pool.count[type]) {
+      pf_workspace_destroy(pf_pool.idle[type][--pf_pool.count[type]]);
+    }
+  }
+  fc_release_mutex(&pf_pool.mutex);
+  fc_destroy_mutex(&pf_pool.mutex);
+}
+
+/************************************************************************//**
+  Fill stats with the statistics of the maps of the given type since the
+  pool was initialized or the stats last reset.
+****************************************************************************/
+void pf_map_stats_get(enum pf_map_type type, struct pf_map_stats *stats)
+{
+  fc_assert_ret(pf_map_type_is_valid(type));
+
+  if (!pf_pool.initialized) {
+    memset(stats, 0, sizeof(*stats));
+    return;
+  }
+
+  fc_allocate_mutex(&pf_pool.mutex);
+  *stats = pf_pool.stats[type];
+  fc_release_mutex(&pf_pool.mutex);
+}
+
+/************************************************************************//**
+  Reset the statistics of all the map types.
+****************************************************************************/
+void pf_map_stats_reset(void)
+{
+  if (!pf_pool.initialized) {
+    return;
+  }
+
+  fc_allocate_mutex(&pf_pool.mutex);
+  memset(pf_pool.stats, 0, sizeof(pf_pool.stats));
+  fc_release_mutex(&pf_pool.mutex);
+}
+
 /* ========================== Common functions =========================== */
 
 /************************************************************************//**
@@ -220,6 +444,7 @@ struct pf_normal_node {
   unsigned behavior : 2;        /* 'enum tile_behavior' really. */
   unsigned zoc_number : 2;      /* 'enum pf_zoc_type' really. */
   unsigned short extra_tile;    /* EC */
+  unsigned short generation;    /* See struct pf_workspace. */
 };
 
 /* Derived structure of struct pf_map. */
@@ -230,6 +455,12 @@ struct pf_normal_map {
                                * processed yet (NS_NEW), sorted by their
                                * total_CC. */
   struct pf_normal_node *lattice; /* Lattice of nodes. */
+
+  /* Goal-directed search, see pf_map_new_goal(). When 'goal' is set,
+   * 'goal_queue' is used instead of 'queue'. */
+  struct tile *goal;
+  int min_step;                 /* Lower bound of the cost of any step. */
+  struct map_index_goal_pq *goal_queue;
 };
 
 /* Up-cast macro. */
@@ -251,6 +482,24 @@ pf_normal_map_check(struct pf_map *pfm, const char *file,
 
 /* ================  Specific pf_normal_* mode functions ================= */
 
+/************************************************************************//**
+  Return the node of the lattice at the given index, resetting it first if
+  it's stale (see struct pf_workspace).
+****************************************************************************/
+static inline struct pf_normal_node *
+pf_normal_map_node(const struct pf_normal_map *pfnm, int tindex)
+{
+  struct pf_normal_node *node = pfnm->lattice + tindex;
+
+  if (node->generation != pfnm->base_map.generation) {
+    memset(node, 0, sizeof(*node));
+    node->generation = pfnm->base_map.generation;
+    pfnm->base_map.ws->nodes++;
+  }
+
+  return node;
+}
+
 /************************************************************************//**
   Calculates cached values of the target node. Set the node status to
   NS_INIT to avoid recalculating all values. Returns FALSE if we cannot
@@ -328,7 +577,7 @@ static inline bool pf_normal_node_init(struct pf_normal_map *pfnm,
       node->action = action;
 #ifdef ZERO_VARIABLES_FOR_SEARCHING
     } else {
-      /* Nodes are allocated by fc_calloc(), so should be already set to
+      /* Nodes are zeroed on first access, so should be already set to
        * 0. */
       node->action = PF_ACTION_NONE;
 #endif
@@ -365,7 +614,7 @@ static inline bool pf_normal_node_init(struct pf_normal_map *pfnm,
                           ? ZOC_ALLIED : ZOC_NO);
 #ifdef ZERO_VARIABLES_FOR_SEARCHING
     } else {
-      /* Nodes are allocated by fc_calloc(), so should be already set to
+      /* Nodes are zeroed on first access, so should be already set to
        * 0. */
       node->zoc_number = ZOC_MINE;
 #endif
@@ -373,7 +622,7 @@ static inline bool pf_normal_node_init(struct pf_normal_map *pfnm,
   } else {
     node->move_scope = PF_MS_NATIVE;
 #ifdef ZERO_VARIABLES_FOR_SEARCHING
-    /* Nodes are allocated by fc_calloc(), so  should be already set to 0. */
+    /* Nodes are zeroed on first access, so  should be already set to 0. */
     node->action = PF_ACTION_NONE;
     node->zoc_number = ZOC_MINE;
 #endif
@@ -384,7 +633,7 @@ static inline bool pf_normal_node_init(struct pf_normal_map *pfnm,
     node->extra_tile = params->get_EC(ptile, node_known_type, params);
 #ifdef ZERO_VARIABLES_FOR_SEARCHING
   } else {
-    /* Nodes are allocated by fc_calloc(), so  should be already set to 0. */
+    /* Nodes are zeroed on first access, so  should be already set to 0. */
     node->extra_tile = 0;
 #endif
   }
@@ -401,7 +650,7 @@ static void pf_normal_map_fill_position(const struct pf_normal_map *pfnm,
                                         struct pf_position *pos)
 {
   int tindex = tile_index(ptile);
-  struct pf_normal_node *node = pfnm->lattice + tindex;
+  struct pf_normal_node *node = pf_normal_map_node(pfnm, tindex);
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfnm));
 
 #ifdef PF_DEBUG
@@ -436,7 +685,7 @@ static struct pf_path *
 pf_normal_map_construct_path(const struct pf_normal_map *pfnm,
                              struct tile *dest_tile)
 {
-  struct pf_normal_node *node = pfnm->lattice + tile_index(dest_tile);
+  struct pf_normal_node *node = pf_normal_map_node(pfnm, tile_index(dest_tile));
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfnm));
   enum direction8 dir_next = direction8_invalid();
   struct pf_path *path;
@@ -461,7 +710,7 @@ pf_normal_map_construct_path(const struct pf_normal_map *pfnm,
     }
 
     ptile = mapstep(params->map, ptile, DIR_REVERSE(node->dir_to_here));
-    node = pfnm->lattice + tile_index(ptile);
+    node = pf_normal_map_node(pfnm, tile_index(ptile));
   }
 
   /* 2: Allocate the memory */
@@ -470,7 +719,7 @@ pf_normal_map_construct_path(const struct pf_normal_map *pfnm,
 
   /* 3: Backtrack again and fill the positions this time */
   ptile = dest_tile;
-  node = pfnm->lattice + tile_index(ptile);
+  node = pf_normal_map_node(pfnm, tile_index(ptile));
 
   for (; i >= 0; i--) {
     pf_normal_map_fill_position(pfnm, ptile, &path->positions[i]);
@@ -482,13 +731,60 @@ pf_normal_map_construct_path(const struct pf_normal_map *pfnm,
     if (i > 0) {
       /* Step further back, if we haven't finished yet */
       ptile = mapstep(params->map, ptile, DIR_REVERSE(dir_next));
-      node = pfnm->lattice + tile_index(ptile);
+      node = pf_normal_map_node(pfnm, tile_index(ptile));
     }
   }
 
   return path;
 }
 
+/************************************************************************//**
+  Lower bound of the cost after 'steps' more steps from a node of cost
+  'cost', when no step costs less than 'min_step' (or the moves left, see
+  pf_normal_map_adjust_cost()).
+****************************************************************************/
+static inline int pf_goal_cost_bound(const struct pf_parameter *param,
+                                     int cost, int steps, int min_step)
+{
+  int move_rate = pf_move_rate(param);
+  int moves_left = pf_moves_left(param, cost);
+  int per_turn;
+
+  if (steps * min_step < moves_left) {
+    return cost + steps * min_step;
+  }
+
+  /* Spend this turn's moves, then go on from a full turn. */
+  steps -= (moves_left + min_step - 1) / min_step;
+  cost += moves_left;
+  per_turn = (move_rate + min_step - 1) / min_step;
+
+  return (cost + (steps / per_turn) * move_rate
+          + (steps % per_turn) * min_step);
+}
+
+/************************************************************************//**
+  Queue priority of a node of a goal-directed map. Nodes are sorted by the
+  lower bound of the total_CC of a path through them to the goal, then by
+  their own total_CC. The bound never decreases along a path, so a node is
+  processed with its best cost, as in the plain search, and the goal
+  position found is the same.
+****************************************************************************/
+static inline int64_t
+pf_normal_map_goal_priority(const struct pf_normal_map *pfnm,
+                            const struct tile *ptile, int cost, int extra)
+{
+  const struct pf_parameter *params = &pfnm->base_map.params;
+  int steps = real_map_distance(ptile, pfnm->goal);
+  int bound = pf_total_CC(params,
+                          pf_goal_cost_bound(params, cost, steps,
+                                             pfnm->min_step), extra);
+  int64_t total = (int64_t) pf_total_CC(params, cost, extra) - INT_MIN;
+
+  /* As we prefer lower costs, let's reverse the priority. */
+  return -((int64_t) bound * ((int64_t) 1 << 32) + total);
+}
+
 /************************************************************************//**
   Adjust MC to reflect the move_rate.
 ****************************************************************************/
@@ -521,7 +817,7 @@ static bool pf_jumbo_map_iterate(struct pf_map *pfm)
   struct pf_normal_map *pfnm = PF_NORMAL_MAP(pfm);
   struct tile *tile = pfm->tile;
   int tindex = tile_index(tile);
-  struct pf_normal_node *node = pfnm->lattice + tindex;
+  struct pf_normal_node *node = pf_normal_map_node(pfnm, tindex);
   const struct pf_parameter *params = pf_map_parameter(pfm);
 
   /* Processing Stage */
@@ -534,7 +830,7 @@ static bool pf_jumbo_map_iterate(struct pf_map *pfm)
     /* Calculate the cost of every adjacent position and set them in the
      * priority queue for next call to pf_jumbo_map_iterate(). */
     int tindex1 = tile_index(tile1);
-    struct pf_normal_node *node1 = pfnm->lattice + tindex1;
+    struct pf_normal_node *node1 = pf_normal_map_node(pfnm, tindex1);
     int priority, cost1, extra_cost1;
 
     /* As for the previous position, 'tile1', 'node1' and 'tindex1' are
@@ -582,12 +878,12 @@ static bool pf_jumbo_map_iterate(struct pf_map *pfm)
   }
 
 #ifdef PF_DEBUG
-  fc_assert(NS_NEW == pfnm->lattice[tindex].status);
+  fc_assert(NS_NEW == pf_normal_map_node(pfnm, tindex)->status);
 #endif
 
   /* Change the pf_map iterator. Node status step B. to C. */
   pfm->tile = index_to_tile(params->map, tindex);
-  pfnm->lattice[tindex].status = NS_PROCESSED;
+  pf_normal_map_node(pfnm, tindex)->status = NS_PROCESSED;
 
   return TRUE;
 }
@@ -613,7 +909,7 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
   struct pf_normal_map *pfnm = PF_NORMAL_MAP(pfm);
   struct tile *tile = pfm->tile;
   int tindex = tile_index(tile);
-  struct pf_normal_node *node = pfnm->lattice + tindex;
+  struct pf_normal_node *node = pf_normal_map_node(pfnm, tindex);
   const struct pf_parameter *params = pf_map_parameter(pfm);
   int cost_of_path;
   enum pf_move_scope scope = node->move_scope;
@@ -632,7 +928,7 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
       /* Calculate the cost of every adjacent position and set them in the
        * priority queue for next call to pf_normal_map_iterate(). */
       int tindex1 = tile_index(tile1);
-      struct pf_normal_node *node1 = pfnm->lattice + tindex1;
+      struct pf_normal_node *node1 = pf_normal_map_node(pfnm, tindex1);
       int cost;
       int extra = 0;
 
@@ -712,8 +1008,14 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
         node1->extra_cost = extra;
         node1->cost = cost;
         node1->dir_to_here = dir;
-        /* As we prefer lower costs, let's reverse the cost of the path. */
-        map_index_pq_insert(pfnm->queue, tindex1, -cost_of_path);
+        if (NULL != pfnm->goal) {
+          map_index_goal_pq_insert(pfnm->goal_queue, tindex1,
+                                   pf_normal_map_goal_priority(pfnm, tile1,
+                                                               cost, extra));
+        } else {
+          /* As we prefer lower costs, let's reverse the cost of the path. */
+          map_index_pq_insert(pfnm->queue, tindex1, -cost_of_path);
+        }
       } else if (cost_of_path < pf_total_CC(params, node1->cost,
                                             node1->extra_cost)) {
         /* We found a better route to 'tile1'. Let's register 'tindex1' to
@@ -722,25 +1024,33 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
         node1->extra_cost = extra;
         node1->cost = cost;
         node1->dir_to_here = dir;
-        /* As we prefer lower costs, let's reverse the cost of the path. */
-        map_index_pq_replace(pfnm->queue, tindex1, -cost_of_path);
+        if (NULL != pfnm->goal) {
+          map_index_goal_pq_replace(pfnm->goal_queue, tindex1,
+                                    pf_normal_map_goal_priority(pfnm, tile1,
+                                                                cost, extra));
+        } else {
+          /* As we prefer lower costs, let's reverse the cost of the path. */
+          map_index_pq_replace(pfnm->queue, tindex1, -cost_of_path);
+        }
       }
     } adjc_dir_iterate_end;
   }
 
   /* Get the next node (the index with the highest priority). */
-  if (!map_index_pq_remove(pfnm->queue, &tindex)) {
+  if (NULL != pfnm->goal
+      ? !map_index_goal_pq_remove(pfnm->goal_queue, &tindex)
+      : !map_index_pq_remove(pfnm->queue, &tindex)) {
     /* No more indexes in the priority queue, iteration end. */
     return FALSE;
   }
 
 #ifdef PF_DEBUG
-  fc_assert(NS_NEW == pfnm->lattice[tindex].status);
+  fc_assert(NS_NEW == pf_normal_map_node(pfnm, tindex)->status);
 #endif
 
   /* Change the pf_map iterator. Node status step C. to D. */
   pfm->tile = index_to_tile(params->map, tindex);
-  pfnm->lattice[tindex].status = NS_PROCESSED;
+  pf_normal_map_node(pfnm, tindex)->status = NS_PROCESSED;
 
   return TRUE;
 }
@@ -752,7 +1062,7 @@ static inline bool pf_normal_map_iterate_until(struct pf_normal_map *pfnm,
                                                struct tile *ptile)
 {
   struct pf_map *pfm = PF_MAP(pfnm);
-  struct pf_normal_node *node = pfnm->lattice + tile_index(ptile);
+  struct pf_normal_node *node = pf_normal_map_node(pfnm, tile_index(ptile));
 
   if (NULL == pf_map_parameter(pfm)->get_costs) {
     /* Start position is handled in every function calling this function. */
@@ -791,7 +1101,7 @@ static int pf_normal_map_move_cost(struct pf_map *pfm, struct tile *ptile)
   if (ptile == pfm->params.start_tile) {
     return 0;
   } else if (pf_normal_map_iterate_until(pfnm, ptile)) {
-    return (pfnm->lattice[tile_index(ptile)].cost
+    return (pf_normal_map_node(pfnm, tile_index(ptile))->cost
             - pf_move_rate(pf_map_parameter(pfm))
             + pf_moves_left_initially(pf_map_parameter(pfm)));
   } else {
@@ -845,8 +1155,10 @@ static void pf_normal_map_destroy(struct pf_map *pfm)
 {
   struct pf_normal_map *pfnm = PF_NORMAL_MAP(pfm);
 
-  free(pfnm->lattice);
-  map_index_pq_destroy(pfnm->queue);
+  if (NULL != pfnm->goal_queue) {
+    map_index_goal_pq_destroy(pfnm->goal_queue);
+  }
+  pf_workspace_release(pfm->ws);
   free(pfnm);
 }
 
@@ -869,8 +1181,14 @@ static struct pf_map *pf_normal_map_new(const struct pf_parameter *parameter)
 #endif /* PF_DEBUG */
 
   /* Allocate the map. */
-  pfnm->lattice = fc_calloc(MAP_INDEX_SIZE, sizeof(struct pf_normal_node));
-  pfnm->queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
+  base_map->ws = pf_workspace_get(PF_MAP_NORMAL,
+                                  sizeof(struct pf_normal_node), NULL, FALSE);
+  base_map->generation = base_map->ws->generation;
+  pfnm->lattice = base_map->ws->lattice;
+  pfnm->queue = base_map->ws->queue;
+  pfnm->goal = NULL;
+  pfnm->min_step = 0;
+  pfnm->goal_queue = NULL;
 
   if (NULL == parameter->get_costs) {
     /* 'get_MC' callback must be set. */
@@ -895,7 +1213,7 @@ static struct pf_map *pf_normal_map_new(const struct pf_parameter *parameter)
   }
 
   /* Initialise starting node. */
-  node = pfnm->lattice + tile_index(params->start_tile);
+  node = pf_normal_map_node(pfnm, tile_index(params->start_tile));
   if (NULL == params->get_costs) {
     if (!pf_normal_node_init(pfnm, node, params->start_tile, PF_MS_NONE)) {
       /* Always fails. */
@@ -961,6 +1279,7 @@ struct pf_danger_node {
   bool is_dangerous : 1;        /* Whether we cannot end the turn there. */
   bool waited : 1;              /* TRUE if waited to get there. */
   unsigned short extra_tile;    /* EC */
+  unsigned short generation;    /* See struct pf_workspace. */
 
   /* Segment leading across the danger area back to the nearest safe node:
    * need to remeber costs and stuff. */
@@ -1001,6 +1320,43 @@ pf_danger_map_check(struct pf_map *pfm, const char *file,
 
 /* ===============  Specific pf_danger_* mode functions ================== */
 
+/************************************************************************//**
+  Return the node of the lattice at the given index, resetting it first if
+  it's stale (see struct pf_workspace).
+****************************************************************************/
+static inline struct pf_danger_node *
+pf_danger_map_node(const struct pf_danger_map *pfdm, int tindex)
+{
+  struct pf_danger_node *node = pfdm->lattice + tindex;
+
+  if (node->generation != pfdm->base_map.generation) {
+    if (NULL != node->danger_segment) {
+      free(node->danger_segment);
+    }
+    memset(node, 0, sizeof(*node));
+    node->generation = pfdm->base_map.generation;
+    pfdm->base_map.ws->nodes++;
+  }
+
+  return node;
+}
+
+/************************************************************************//**
+  Free the danger segments of all the nodes of a lattice.
+****************************************************************************/
+static void pf_danger_lattice_purge(void *lattice, int size)
+{
+  struct pf_danger_node *node = lattice;
+  int i;
+
+  for (i = 0; i < size; i++, node++) {
+    if (NULL != node->danger_segment) {
+      free(node->danger_segment);
+      node->danger_segment = NULL;
+    }
+  }
+}
+
 /************************************************************************//**
   Calculates cached values of the target node. Set the node status to
   NS_INIT to avoid recalculating all values. Returns FALSE if we cannot
@@ -1078,7 +1434,7 @@ static inline bool pf_danger_node_init(struct pf_danger_map *pfdm,
       node->action = action;
 #ifdef ZERO_VARIABLES_FOR_SEARCHING
     } else {
-      /* Nodes are allocated by fc_calloc(), so should be already set to
+      /* Nodes are zeroed on first access, so should be already set to
        * 0. */
       node->action = PF_ACTION_NONE;
 #endif
@@ -1115,7 +1471,7 @@ static inline bool pf_danger_node_init(struct pf_danger_map *pfdm,
                           ? ZOC_ALLIED : ZOC_NO);
 #ifdef ZERO_VARIABLES_FOR_SEARCHING
     } else {
-      /* Nodes are allocated by fc_calloc(), so should be already set to
+      /* Nodes are zeroed on first access, so should be already set to
        * 0. */
       node->zoc_number = ZOC_MINE;
 #endif
@@ -1123,7 +1479,7 @@ static inline bool pf_danger_node_init(struct pf_danger_map *pfdm,
   } else {
     node->move_scope = PF_MS_NATIVE;
 #ifdef ZERO_VARIABLES_FOR_SEARCHING
-    /* Nodes are allocated by fc_calloc(), so  should be already set to 0. */
+    /* Nodes are zeroed on first access, so  should be already set to 0. */
     node->action = PF_ACTION_NONE;
     node->zoc_number = ZOC_MINE;
 #endif
@@ -1134,13 +1490,13 @@ static inline bool pf_danger_node_init(struct pf_danger_map *pfdm,
     node->extra_tile = params->get_EC(ptile, node_known_type, params);
 #ifdef ZERO_VARIABLES_FOR_SEARCHING
   } else {
-    /* Nodes are allocated by fc_calloc(), so should be already set to 0. */
+    /* Nodes are zeroed on first access, so should be already set to 0. */
     node->extra_tile = 0;
 #endif
   }
 
 #ifdef ZERO_VARIABLES_FOR_SEARCHING
-  /* Nodes are allocated by fc_calloc(), so should be already set to
+  /* Nodes are zeroed on first access, so should be already set to
    * FALSE. */
   node->waited = FALSE;
 #endif
@@ -1160,7 +1516,7 @@ static void pf_danger_map_fill_position(const struct pf_danger_map *pfdm,
                                         struct pf_position *pos)
 {
   int tindex = tile_index(ptile);
-  struct pf_danger_node *node = pfdm->lattice + tindex;
+  struct pf_danger_node *node = pf_danger_map_node(pfdm, tindex);
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfdm));
 
 #ifdef PF_DEBUG
@@ -1218,7 +1574,7 @@ pf_danger_map_construct_path(const struct pf_danger_map *pfdm,
   enum direction8 dir_next = direction8_invalid();
   struct pf_danger_pos *danger_seg = NULL;
   bool waited = FALSE;
-  struct pf_danger_node *node = pfdm->lattice + tile_index(ptile);
+  struct pf_danger_node *node = pf_danger_map_node(pfdm, tile_index(ptile));
   int length = 1;
   struct tile *iter_tile = ptile;
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfdm));
@@ -1255,7 +1611,7 @@ pf_danger_map_construct_path(const struct pf_danger_map *pfdm,
 
     /* Step backward. */
     iter_tile = mapstep(params->map, iter_tile, DIR_REVERSE(dir_next));
-    node = pfdm->lattice + tile_index(iter_tile);
+    node = pf_danger_map_node(pfdm, tile_index(iter_tile));
   }
 
   /* Allocate memory for path. */
@@ -1264,7 +1620,7 @@ pf_danger_map_construct_path(const struct pf_danger_map *pfdm,
 
   /* Reset variables for main iteration. */
   iter_tile = ptile;
-  node = pfdm->lattice + tile_index(ptile);
+  node = pf_danger_map_node(pfdm, tile_index(ptile));
   danger_seg = NULL;
   waited = FALSE;
 
@@ -1346,7 +1702,7 @@ pf_danger_map_construct_path(const struct pf_danger_map *pfdm,
 
     /* 5: Step further back. */
     iter_tile = mapstep(params->map, iter_tile, DIR_REVERSE(dir_next));
-    node = pfdm->lattice + tile_index(iter_tile);
+    node = pf_danger_map_node(pfdm, tile_index(iter_tile));
   }
 
   fc_assert_msg(FALSE, "Cannot get to the starting point!");
@@ -1375,7 +1731,7 @@ static void pf_danger_map_create_segment(struct pf_danger_map *pfdm,
                                          struct pf_danger_node *node1)
 {
   struct tile *ptile = PF_MAP(pfdm)->tile;
-  struct pf_danger_node *node = pfdm->lattice + tile_index(ptile);
+  struct pf_danger_node *node = pf_danger_map_node(pfdm, tile_index(ptile));
   struct pf_danger_pos *pos;
   int length = 0, i;
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfdm));
@@ -1390,7 +1746,7 @@ static void pf_danger_map_create_segment(struct pf_danger_map *pfdm,
   while (node->is_dangerous && direction8_is_valid(node->dir_to_here)) {
     length++;
     ptile = mapstep(params->map, ptile, DIR_REVERSE(node->dir_to_here));
-    node = pfdm->lattice + tile_index(ptile);
+    node = pf_danger_map_node(pfdm, tile_index(ptile));
   }
 
   /* Allocate memory for segment */
@@ -1398,7 +1754,7 @@ static void pf_danger_map_create_segment(struct pf_danger_map *pfdm,
 
   /* Reset tile and node pointers for main iteration */
   ptile = PF_MAP(pfdm)->tile;
-  node = pfdm->lattice + tile_index(ptile);
+  node = pf_danger_map_node(pfdm, tile_index(ptile));
 
   /* Now fill the positions */
   for (i = 0, pos = node1->danger_segment; i < length; i++, pos++) {
@@ -1413,7 +1769,7 @@ static void pf_danger_map_create_segment(struct pf_danger_map *pfdm,
 
     /* Step further down the tree */
     ptile = mapstep(params->map, ptile, DIR_REVERSE(node->dir_to_here));
-    node = pfdm->lattice + tile_index(ptile);
+    node = pf_danger_map_node(pfdm, tile_index(ptile));
   }
 
 #ifdef PF_DEBUG
@@ -1487,7 +1843,7 @@ static bool pf_danger_map_iterate(struct pf_map *pfm)
   const struct pf_parameter *const params = pf_map_parameter(pfm);
   struct tile *tile = pfm->tile;
   int tindex = tile_index(tile);
-  struct pf_danger_node *node = pfdm->lattice + tindex;
+  struct pf_danger_node *node = pf_danger_map_node(pfdm, tindex);
   enum pf_move_scope scope = node->move_scope;
 
   /* The previous position is defined by 'tile' (tile pointer), 'node'
@@ -1528,7 +1884,7 @@ static bool pf_danger_map_iterate(struct pf_map *pfm)
         /* Calculate the cost of every adjacent position and set them in
          * the priority queues for next call to pf_danger_map_iterate(). */
         int tindex1 = tile_index(tile1);
-        struct pf_danger_node *node1 = pfdm->lattice + tindex1;
+        struct pf_danger_node *node1 = pf_danger_map_node(pfdm, tindex1);
         int cost;
         int extra = 0;
 
@@ -1698,7 +2054,7 @@ static bool pf_danger_map_iterate(struct pf_map *pfm)
       /* Change the pf_map iterator and reset data. */
       tile = index_to_tile(params->map, tindex);
       pfm->tile = tile;
-      node = pfdm->lattice + tindex;
+      node = pf_danger_map_node(pfdm, tindex);
     } else {
       /* No dangerous nodes to process, go for a safe one. */
       if (!map_index_pq_remove(pfdm->queue, &tindex)) {
@@ -1707,13 +2063,13 @@ static bool pf_danger_map_iterate(struct pf_map *pfm)
       }
 
 #ifdef PF_DEBUG
-      fc_assert(NS_PROCESSED != pfdm->lattice[tindex].status);
+      fc_assert(NS_PROCESSED != pf_danger_map_node(pfdm, tindex)->status);
 #endif
 
       /* Change the pf_map iterator and reset data. */
       tile = index_to_tile(params->map, tindex);
       pfm->tile = tile;
-      node = pfdm->lattice + tindex;
+      node = pf_danger_map_node(pfdm, tindex);
       if (NS_WAITING != node->status) {
         /* Node status step C. and D. */
 #ifdef PF_DEBUG
@@ -1750,7 +2106,7 @@ static inline bool pf_danger_map_iterate_until(struct pf_danger_map *pfdm,
                                                struct tile *ptile)
 {
   struct pf_map *pfm = PF_MAP(pfdm);
-  struct pf_danger_node *node = pfdm->lattice + tile_index(ptile);
+  struct pf_danger_node *node = pf_danger_map_node(pfdm, tile_index(ptile));
 
   /* Start position is handled in every function calling this function. */
 
@@ -1789,7 +2145,7 @@ static int pf_danger_map_move_cost(struct pf_map *pfm, struct tile *ptile)
   if (ptile == pfm->params.start_tile) {
     return 0;
   } else if (pf_danger_map_iterate_until(pfdm, ptile)) {
-    return (pfdm->lattice[tile_index(ptile)].cost
+    return (pf_danger_map_node(pfdm, tile_index(ptile))->cost
             - pf_move_rate(pf_map_parameter(pfm))
             + pf_moves_left_initially(pf_map_parameter(pfm)));
   } else {
@@ -1842,18 +2198,9 @@ static bool pf_danger_map_position(struct pf_map *pfm, struct tile *ptile,
 static void pf_danger_map_destroy(struct pf_map *pfm)
 {
   struct pf_danger_map *pfdm = PF_DANGER_MAP(pfm);
-  struct pf_danger_node *node;
-  int i;
 
-  /* Need to clean up the dangling danger segments. */
-  for (i = 0, node = pfdm->lattice; i < MAP_INDEX_SIZE; i++, node++) {
-    if (node->danger_segment) {
-      free(node->danger_segment);
-    }
-  }
-  free(pfdm->lattice);
-  map_index_pq_destroy(pfdm->queue);
-  map_index_pq_destroy(pfdm->danger_queue);
+  /* The danger segments are freed with the stale nodes. */
+  pf_workspace_release(pfm->ws);
   free(pfdm);
 }
 
@@ -1876,9 +2223,13 @@ static struct pf_map *pf_danger_map_new(const struct pf_parameter *parameter)
 #endif /* PF_DEBUG */
 
   /* Allocate the map. */
-  pfdm->lattice = fc_calloc(MAP_INDEX_SIZE, sizeof(struct pf_danger_node));
-  pfdm->queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
-  pfdm->danger_queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
+  base_map->ws = pf_workspace_get(PF_MAP_DANGER,
+                                  sizeof(struct pf_danger_node),
+                                  pf_danger_lattice_purge, TRUE);
+  base_map->generation = base_map->ws->generation;
+  pfdm->lattice = base_map->ws->lattice;
+  pfdm->queue = base_map->ws->queue;
+  pfdm->danger_queue = base_map->ws->queue2;
 
   /* 'get_MC' callback must be set. */
   fc_assert_ret_val(parameter->get_MC != NULL, NULL);
@@ -1900,7 +2251,7 @@ static struct pf_map *pf_danger_map_new(const struct pf_parameter *parameter)
   base_map->iterate = pf_danger_map_iterate;
 
   /* Initialise starting node. */
-  node = pfdm->lattice + tile_index(params->start_tile);
+  node = pf_danger_map_node(pfdm, tile_index(params->start_tile));
   if (!pf_danger_node_init(pfdm, node, params->start_tile, PF_MS_NONE)) {
     /* Always fails. */
     fc_assert(TRUE == pf_danger_node_init(pfdm, node, params->start_tile,
@@ -1964,6 +2315,7 @@ struct pf_fuel_node {
                                  * constant move costs! */
   unsigned short extra_tile;    /* EC */
   unsigned short cost_to_here[DIR8_MAGIC_MAX]; /* Step cost[dir to here] */
+  unsigned short generation;    /* See struct pf_workspace. */
 
   /* Segment leading across the danger area back to the nearest safe node:
    * need to remember costs and stuff. */
@@ -2015,6 +2367,44 @@ pf_fuel_map_check(struct pf_map *pfm, const char *file,
 
 /* =================  Specific pf_fuel_* mode functions ================== */
 
+static inline void pf_fuel_pos_unref(struct pf_fuel_pos *pos);
+
+/************************************************************************//**
+  Return the node of the lattice at the given index, resetting it first if
+  it's stale (see struct pf_workspace).
+****************************************************************************/
+static inline struct pf_fuel_node *
+pf_fuel_map_node(const struct pf_fuel_map *pffm, int tindex)
+{
+  struct pf_fuel_node *node = pffm->lattice + tindex;
+
+  if (node->generation != pffm->base_map.generation) {
+    pf_fuel_pos_unref(node->pos);
+    pf_fuel_pos_unref(node->segment);
+    memset(node, 0, sizeof(*node));
+    node->generation = pffm->base_map.generation;
+    pffm->base_map.ws->nodes++;
+  }
+
+  return node;
+}
+
+/************************************************************************//**
+  Forget the fuel segments of all the nodes of a lattice.
+****************************************************************************/
+static void pf_fuel_lattice_purge(void *lattice, int size)
+{
+  struct pf_fuel_node *node = lattice;
+  int i;
+
+  for (i = 0; i < size; i++, node++) {
+    pf_fuel_pos_unref(node->pos);
+    pf_fuel_pos_unref(node->segment);
+    node->pos = NULL;
+    node->segment = NULL;
+  }
+}
+
 /************************************************************************//**
   Obtain cost-of-path from pure cost, extra cost and safety.
 ****************************************************************************/
@@ -2113,7 +2503,7 @@ static inline bool pf_fuel_node_init(struct pf_fuel_map *pffm,
 #endif
     } else {
 #ifdef ZERO_VARIABLES_FOR_SEARCHING
-      /* Nodes are allocated by fc_calloc(), so should be already set to
+      /* Nodes are zeroed on first access, so should be already set to
        * 0. */
       node->action = PF_ACTION_NONE;
 #endif
@@ -2161,7 +2551,7 @@ static inline bool pf_fuel_node_init(struct pf_fuel_map *pffm,
                           ? ZOC_ALLIED : ZOC_NO);
 #ifdef ZERO_VARIABLES_FOR_SEARCHING
     } else {
-      /* Nodes are allocated by fc_calloc(), so should be already set to
+      /* Nodes are zeroed on first access, so should be already set to
        * 0. */
       node->zoc_number = ZOC_MINE;
 #endif
@@ -2181,7 +2571,7 @@ static inline bool pf_fuel_node_init(struct pf_fuel_map *pffm,
 
     node->move_scope = PF_MS_NATIVE;
 #ifdef ZERO_VARIABLES_FOR_SEARCHING
-    /* Nodes are allocated by fc_calloc(), so  should be already set to 0. */
+    /* Nodes are zeroed on first access, so  should be already set to 0. */
     node->action = PF_ACTION_NONE;
     node->zoc_number = ZOC_MINE;
 #endif
@@ -2192,13 +2582,13 @@ static inline bool pf_fuel_node_init(struct pf_fuel_map *pffm,
     node->extra_tile = params->get_EC(ptile, node_known_type, params);
 #ifdef ZERO_VARIABLES_FOR_SEARCHING
   } else {
-    /* Nodes are allocated by fc_calloc(), so should be already set to 0. */
+    /* Nodes are zeroed on first access, so should be already set to 0. */
     node->extra_tile = 0;
 #endif
   }
 
 #ifdef ZERO_VARIABLES_FOR_SEARCHING
-  /* Nodes are allocated by fc_calloc(), so should be already set to 0. */
+  /* Nodes are zeroed on first access, so should be already set to 0. */
   node->pos = NULL;
   node->segment = NULL;
 #endif
@@ -2324,7 +2714,7 @@ static void pf_fuel_map_fill_position(const struct pf_fuel_map *pffm,
                                       struct pf_position *pos)
 {
   int tindex = tile_index(ptile);
-  struct pf_fuel_node *node = pffm->lattice + tindex;
+  struct pf_fuel_node *node = pf_fuel_map_node(pffm, tindex);
   struct pf_fuel_pos *head = node->segment;
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pffm));
 
@@ -2366,7 +2756,7 @@ pf_fuel_map_construct_path(const struct pf_fuel_map *pffm,
 {
   struct pf_path *path = fc_malloc(sizeof(*path));
   enum direction8 dir_next = direction8_invalid();
-  struct pf_fuel_node *node = pffm->lattice + tile_index(ptile);
+  struct pf_fuel_node *node = pf_fuel_map_node(pffm, tile_index(ptile));
   struct pf_fuel_pos *segment = node->segment;
   int length = 1;
   struct tile *iter_tile = ptile;
@@ -2399,7 +2789,7 @@ pf_fuel_map_construct_path(const struct pf_fuel_map *pffm,
     /* Step backward. */
     iter_tile = mapstep(params->map, iter_tile,
                         DIR_REVERSE(segment->dir_to_here));
-    node = pffm->lattice + tile_index(iter_tile);
+    node = pf_fuel_map_node(pffm, tile_index(iter_tile));
     segment = segment->prev;
 #ifdef PF_DEBUG
     fc_assert(NULL != segment);
@@ -2416,7 +2806,7 @@ pf_fuel_map_construct_path(const struct pf_fuel_map *pffm,
 
   /* Reset variables for main iteration. */
   iter_tile = ptile;
-  node = pffm->lattice + tile_index(ptile);
+  node = pf_fuel_map_node(pffm, tile_index(ptile));
   segment = node->segment;
 
   for (i = length - 1; i >= 0; i--) {
@@ -2469,7 +2859,7 @@ pf_fuel_map_construct_path(const struct pf_fuel_map *pffm,
 
     /* 5: Step further back. */
     iter_tile = mapstep(params->map, iter_tile, DIR_REVERSE(dir_next));
-    node = pffm->lattice + tile_index(iter_tile);
+    node = pf_fuel_map_node(pffm, tile_index(iter_tile));
     segment = segment->prev;
 #ifdef PF_DEBUG
     fc_assert(NULL != segment);
@@ -2511,7 +2901,7 @@ static inline void pf_fuel_map_create_segment(struct pf_fuel_map *pffm,
   do {
     next = pos;
     ptile = mapstep(params->map, ptile, DIR_REVERSE(node->dir_to_here));
-    node = pffm->lattice + tile_index(ptile);
+    node = pf_fuel_map_node(pffm, tile_index(ptile));
     pos = node->pos;
     if (NULL != pos) {
       if (pos->cost == node->cost
@@ -2621,7 +3011,7 @@ static bool pf_fuel_map_iterate(struct pf_map *pfm)
   const struct pf_parameter *const params = pf_map_parameter(pfm);
   struct tile *tile = pfm->tile;
   int tindex = tile_index(tile);
-  struct pf_fuel_node *node = pffm->lattice + tindex;
+  struct pf_fuel_node *node = pf_fuel_map_node(pffm, tindex);
   enum pf_move_scope scope = node->move_scope;
   int priority, waited_priority;
   bool waited = FALSE;
@@ -2667,7 +3057,7 @@ static bool pf_fuel_map_iterate(struct pf_map *pfm)
         /* Calculate the cost of every adjacent position and set them in
          * the priority queues for next call to pf_fuel_map_iterate(). */
         int tindex1 = tile_index(tile1);
-        struct pf_fuel_node *node1 = pffm->lattice + tindex1;
+        struct pf_fuel_node *node1 = pf_fuel_map_node(pffm, tindex1);
         int cost, extra = 0;
         int moves_left;
         int cost_of_path, old_cost_of_path;
@@ -2904,7 +3294,7 @@ static bool pf_fuel_map_iterate(struct pf_map *pfm)
       /* Change the pf_map iterator and reset data. */
       tile = index_to_tile(params->map, tindex);
       pfm->tile = tile;
-      node = pffm->lattice + tindex;
+      node = pf_fuel_map_node(pffm, tindex);
       waited = TRUE;
 #ifdef PF_DEBUG
       fc_assert(0 < node->moves_left_req);
@@ -2922,7 +3312,7 @@ static bool pf_fuel_map_iterate(struct pf_map *pfm)
       /* Change the pf_map iterator and reset data. */
       tile = index_to_tile(params->map, tindex);
       pfm->tile = tile;
-      node = pffm->lattice + tindex;
+      node = pf_fuel_map_node(pffm, tindex);
 
 #ifdef PF_DEBUG
       fc_assert(NS_PROCESSED != node->status);
@@ -2966,7 +3356,7 @@ static inline bool pf_fuel_map_iterate_until(struct pf_fuel_map *pffm,
                                              struct tile *ptile)
 {
   struct pf_map *pfm = PF_MAP(pffm);
-  struct pf_fuel_node *node = pffm->lattice + tile_index(ptile);
+  struct pf_fuel_node *node = pf_fuel_map_node(pffm, tile_index(ptile));
 
   /* Start position is handled in every function calling this function. */
 
@@ -3004,7 +3394,7 @@ static int pf_fuel_map_move_cost(struct pf_map *pfm, struct tile *ptile)
   if (ptile == pfm->params.start_tile) {
     return 0;
   } else if (pf_fuel_map_iterate_until(pffm, ptile)) {
-    const struct pf_fuel_node *node = pffm->lattice + tile_index(ptile);
+    const struct pf_fuel_node *node = pf_fuel_map_node(pffm, tile_index(ptile));
 
     return (node->segment->cost
             - pf_move_rate(pf_map_parameter(pfm))
@@ -3059,17 +3449,9 @@ static bool pf_fuel_map_position(struct pf_map *pfm, struct tile *ptile,
 static void pf_fuel_map_destroy(struct pf_map *pfm)
 {
   struct pf_fuel_map *pffm = PF_FUEL_MAP(pfm);
-  struct pf_fuel_node *node;
-  int i;
 
-  /* Need to clean up the dangling fuel segments. */
-  for (i = 0, node = pffm->lattice; i < MAP_INDEX_SIZE; i++, node++) {
-    pf_fuel_pos_unref(node->pos);
-    pf_fuel_pos_unref(node->segment);
-  }
-  free(pffm->lattice);
-  map_index_pq_destroy(pffm->queue);
-  map_index_pq_destroy(pffm->waited_queue);
+  /* The fuel segments are forgotten with the stale nodes. */
+  pf_workspace_release(pfm->ws);
   free(pffm);
 }
 
@@ -3092,9 +3474,12 @@ static struct pf_map *pf_fuel_map_new(const struct pf_parameter *parameter)
 #endif /* PF_DEBUG */
 
   /* Allocate the map. */
-  pffm->lattice = fc_calloc(MAP_INDEX_SIZE, sizeof(struct pf_fuel_node));
-  pffm->queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
-  pffm->waited_queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
+  base_map->ws = pf_workspace_get(PF_MAP_FUEL, sizeof(struct pf_fuel_node),
+                                  pf_fuel_lattice_purge, TRUE);
+  base_map->generation = base_map->ws->generation;
+  pffm->lattice = base_map->ws->lattice;
+  pffm->queue = base_map->ws->queue;
+  pffm->waited_queue = base_map->ws->queue2;
 
   /* 'get_MC' callback must be set. */
   fc_assert_ret_val(parameter->get_MC != NULL, NULL);
@@ -3116,7 +3501,7 @@ static struct pf_map *pf_fuel_map_new(const struct pf_parameter *parameter)
   base_map->iterate = pf_fuel_map_iterate;
 
   /* Initialise starting node. */
-  node = pffm->lattice + tile_index(params->start_tile);
+  node = pf_fuel_map_node(pffm, tile_index(params->start_tile));
   if (!pf_fuel_node_init(pffm, node, params->start_tile, PF_MS_NONE)) {
     /* Always fails. */
     fc_assert(TRUE == pf_fuel_node_init(pffm, node, params->start_tile,
@@ -3172,6 +3557,43 @@ struct pf_map *pf_map_new(const struct pf_parameter *parameter)
   return pf_normal_map_new(parameter);
 }
 
+/************************************************************************//**
+  Create a new map to be asked about 'goal' only, with pf_map_path(),
+  pf_map_position() or pf_map_move_cost(). The search is then directed
+  towards the goal instead of flooding the map by increasing cost, which
+  makes the order of iteration meaningless for any other use.
+
+  Falls back to a plain map when no useful lower bound of the move costs
+  is known, see pft_min_step_cost(). Danger, fuel and jumbo maps always
+  do.
+****************************************************************************/
+struct pf_map *pf_map_new_goal(const struct pf_parameter *parameter,
+                               struct tile *goal)
+{
+  struct pf_map *pfm = pf_map_new(parameter);
+  struct pf_normal_map *pfnm;
+  int min_step;
+
+  if (NULL != parameter->is_pos_dangerous
+      || NULL != parameter->get_moves_left_req
+      || NULL != parameter->get_costs
+      || 0 >= pf_move_rate(parameter)) {
+    return pfm;
+  }
+
+  min_step = pft_min_step_cost(parameter);
+  if (0 >= min_step) {
+    return pfm;
+  }
+
+  pfnm = PF_NORMAL_MAP(pfm);
+  pfnm->goal = goal;
+  pfnm->min_step = min_step;
+  pfnm->goal_queue = map_index_goal_pq_new(INITIAL_QUEUE_SIZE);
+
+  return pfm;
+}
+
 /************************************************************************//**
   After usage the map must be destroyed.
 ****************************************************************************/
@@ -3272,6 +3694,7 @@ bool pf_map_iterate(struct pf_map *pfm)
     pfm->tile = NULL;
     return FALSE;
   }
+  pfm->ws->expanded++;
 
   return TRUE;
 }
@@ -3340,6 +3763,17 @@ const struct pf_parameter *pf_map_parameter(const struct pf_map *pfm)
   return &pfm->params;
 }
 
+/************************************************************************//**
+  Return the number of positions the map has processed so far.
+****************************************************************************/
+unsigned long pf_map_nodes_expanded(const struct pf_map *pfm)
+{
+#ifdef PF_DEBUG
+  fc_assert_ret_val(NULL != pfm, 0);
+#endif
+  return pfm->ws->expanded;
+}
+
 
 /* ====================== pf_path public functions ======================= */
 
@@ -3556,9 +3990,13 @@ static void pf_reverse_map_destroy_param(struct pf_parameter *param);
 /* The reverse map structure. */
 struct pf_reverse_map {
   struct tile *target_tile;     /* Where we want to go. */
+  struct tile **target_tiles;   /* All targets, when more than one. */
+  int *target_index;            /* Target number + 1 by tile index. */
+  int num_targets;              /* The number of targets. */
   int max_turns;                /* The maximum of turns. */
   struct pf_parameter template; /* Keep a parameter ready for usage. */
-  struct pf_pos_hash *hash;     /* A hash where pf_position are stored. */
+  struct pf_pos_hash *hash;     /* A hash where pf_position are stored,
+                                 * one per target. */
 };
 
 /* Here goes all unit type flags which affect the move rules handled by
@@ -3664,6 +4102,9 @@ struct pf_reverse_map *pf_reverse_map_new(const struct player *pplayer,
   struct pf_parameter *param = &pfrm->template;
 
   pfrm->target_tile = target_tile;
+  pfrm->target_tiles = NULL;
+  pfrm->target_index = NULL;
+  pfrm->num_targets = 1;
   pfrm->max_turns = max_turns;
 
   /* Initialize the parameter. */
@@ -3678,6 +4119,59 @@ struct pf_reverse_map *pf_reverse_map_new(const struct player *pplayer,
   return pfrm;
 }
 
+/************************************************************************//**
+  Callback for the reverse maps with several targets: every target tile
+  is a tile to attack, every other tile is a tile to move through.
+****************************************************************************/
+static enum pf_action pf_reverse_map_get_action(const struct tile *ptile,
+                                                enum known_type known,
+                                                const struct pf_parameter *param)
+{
+  const struct pf_reverse_map *pfrm = param->data;
+
+  return (0 < pfrm->target_index[tile_index(ptile)]
+          ? PF_ACTION_ATTACK : PF_ACTION_NONE);
+}
+
+/************************************************************************//**
+  'pf_reverse_map' constructor for several target tiles. The map for a
+  unit is iterated once for all the targets, so this is much cheaper than
+  one reverse map per target when the same units are checked against all
+  of them. Note that, unlike separate reverse maps, the paths cannot pass
+  through the other targets. If 'max_turns' is positive, then it won't
+  try to iterate the maps beyond this number of turns.
+****************************************************************************/
+struct pf_reverse_map *pf_reverse_map_new_for_tiles(const struct player *pplayer,
+                                                    struct tile *const *targets,
+                                                    int num_targets,
+                                                    int max_turns,
+                                                    bool omniscient,
+                                                    const struct civ_map *map)
+{
+  struct pf_reverse_map *pfrm;
+  int i;
+
+  fc_assert_ret_val(0 < num_targets, NULL);
+
+  pfrm = pf_reverse_map_new(pplayer, targets[0], max_turns, omniscient, map);
+  if (1 == num_targets) {
+    return pfrm;
+  }
+
+  pfrm->num_targets = num_targets;
+  pfrm->target_tiles = fc_malloc(num_targets * sizeof(*pfrm->target_tiles));
+  pfrm->target_index = fc_calloc(MAP_INDEX_SIZE, sizeof(*pfrm->target_index));
+  for (i = 0; i < num_targets; i++) {
+    pfrm->target_tiles[i] = targets[i];
+    pfrm->target_index[tile_index(targets[i])] = i + 1;
+  }
+
+  pfrm->template.get_action = pf_reverse_map_get_action;
+  pfrm->template.data = pfrm;
+
+  return pfrm;
+}
+
 /************************************************************************//**
   'pf_reverse_map' constructor for city. If 'max_turns' is positive, then
   it won't try to iterate the maps beyond this number of turns.
@@ -3699,12 +4193,29 @@ void pf_reverse_map_destroy(struct pf_reverse_map *pfrm)
   fc_assert_ret(NULL != pfrm);
 
   pf_pos_hash_destroy(pfrm->hash);
+  free(pfrm->target_tiles);
+  free(pfrm->target_index);
   free(pfrm);
 }
 
 /************************************************************************//**
-  Returns the map for the unit type. Creates it if needed. Returns NULL if
-  'target_tile' is unreachable.
+  Returns the number of the target 'ptile', or -1 if it is not one of the
+  targets of the reverse map.
+****************************************************************************/
+static inline int pf_reverse_map_target(const struct pf_reverse_map *pfrm,
+                                        const struct tile *ptile)
+{
+  if (NULL == pfrm->target_index) {
+    return (ptile == pfrm->target_tile ? 0 : -1);
+  }
+
+  return pfrm->target_index[tile_index(ptile)] - 1;
+}
+
+/************************************************************************//**
+  Returns the positions for the unit type, one per target, with a NULL
+  tile for the unreachable targets. Creates them if needed. Returns NULL
+  if no target is reachable.
 ****************************************************************************/
 static const struct pf_position *
 pf_reverse_map_pos(struct pf_reverse_map *pfrm,
@@ -3713,9 +4224,7 @@ pf_reverse_map_pos(struct pf_reverse_map *pfrm,
   struct pf_position *pos;
   struct pf_map *pfm;
   struct pf_parameter *copy;
-  struct tile *target_tile;
-  const struct pf_normal_node *lattice;
-  int max_cost;
+  int max_cost, target, found = 0;
 
   /* Check if we already processed something similar. */
   if (pf_pos_hash_lookup(pfrm->hash, param, &pos)) {
@@ -3723,53 +4232,44 @@ pf_reverse_map_pos(struct pf_reverse_map *pfrm,
   }
 
   /* We didn't. Build map and iterate. */
+  pos = NULL;
   pfm = pf_normal_map_new(param);
-  lattice = PF_NORMAL_MAP(pfm)->lattice;
-  target_tile = pfrm->target_tile;
-  if (pfrm->max_turns >= 0) {
-    max_cost = param->move_rate * (pfrm->max_turns + 1);
-    do {
-      if (lattice[tile_index(pfm->tile)].cost >= max_cost) {
-        break;
-      } else if (pfm->tile == target_tile) {
-        /* Found our position. Insert in hash, destroy map, and return. */
-        pos = fc_malloc(sizeof(*pos));
-        pf_normal_map_fill_position(PF_NORMAL_MAP(pfm), target_tile, pos);
-        copy = fc_malloc(sizeof(*copy));
-        *copy = *param;
-        pf_pos_hash_insert(pfrm->hash, copy, pos);
-        pf_map_destroy(pfm);
-        return pos;
+  max_cost = (pfrm->max_turns >= 0
+              ? param->move_rate * (pfrm->max_turns + 1) : -1);
+  do {
+    if (max_cost >= 0
+        && pf_normal_map_node(PF_NORMAL_MAP(pfm),
+                              tile_index(pfm->tile))->cost >= max_cost) {
+      break;
+    }
+
+    target = pf_reverse_map_target(pfrm, pfm->tile);
+    if (0 <= target) {
+      /* Found one of our positions. */
+      if (NULL == pos) {
+        pos = fc_calloc(pfrm->num_targets, sizeof(*pos));
       }
-    } while (pfm->iterate(pfm));
-  } else {
-    /* No limit for iteration. */
-    do {
-      if (pfm->tile == target_tile) {
-        /* Found our position. Insert in hash, destroy map, and return. */
-        pos = fc_malloc(sizeof(*pos));
-        pf_normal_map_fill_position(PF_NORMAL_MAP(pfm), target_tile, pos);
-        copy = fc_malloc(sizeof(*copy));
-        *copy = *param;
-        pf_pos_hash_insert(pfrm->hash, copy, pos);
-        pf_map_destroy(pfm);
-        return pos;
+      pf_normal_map_fill_position(PF_NORMAL_MAP(pfm), pfm->tile,
+                                  pos + target);
+      if (++found == pfrm->num_targets) {
+        break;
       }
-    } while (pfm->iterate(pfm));
-  }
+    }
+  } while (pfm->iterate(pfm));
   pf_map_destroy(pfm);
 
-  /* Position not found. Let's insert NULL as position to avoid to iterate
+  /* Insert in hash, even if no position was found, to avoid to iterate
    * the map again. */
   copy = fc_malloc(sizeof(*copy));
   *copy = *param;
-  pf_pos_hash_insert(pfrm->hash, copy, NULL);
-  return NULL;
+  pf_pos_hash_insert(pfrm->hash, copy, pos);
+  return pos;
 }
 
 /************************************************************************//**
-  Returns the position for the unit. Creates it if needed. Returns NULL if
-  'target_tile' is unreachable.
+  Returns the positions for the unit, one per target, with a NULL tile
+  for the unreachable targets. Creates them if needed. Returns NULL if no
+  target is reachable.
 ****************************************************************************/
 static inline const struct pf_position *
 pf_reverse_map_unit_pos(struct pf_reverse_map *pfrm,
@@ -3789,8 +4289,9 @@ pf_reverse_map_unit_pos(struct pf_reverse_map *pfrm,
 }
 
 /************************************************************************//**
-  Returns the position for the unit type. Creates it if needed. Returns NULL
-  if 'target_tile' is unreachable.
+  Returns the positions for the unit type, one per target, with a NULL
+  tile for the unreachable targets. Creates them if needed. Returns NULL
+  if no target is reachable.
 ****************************************************************************/
 static inline const struct pf_position *
 pf_reverse_map_utype_pos(struct pf_reverse_map *pfrm,
@@ -3826,7 +4327,8 @@ int pf_reverse_map_utype_move_cost(struct pf_reverse_map *pfrm,
   const struct pf_position *pos = pf_reverse_map_utype_pos(pfrm, punittype,
                                                            ptile);
 
-  return (pos != NULL ? pos->total_MC : PF_IMPOSSIBLE_MC);
+  return (pos != NULL && pos->tile != NULL
+          ? pos->total_MC : PF_IMPOSSIBLE_MC);
 }
 
 /************************************************************************//**
@@ -3838,7 +4340,8 @@ int pf_reverse_map_unit_move_cost(struct pf_reverse_map *pfrm,
 {
   const struct pf_position *pos = pf_reverse_map_unit_pos(pfrm, punit);
 
-  return (pos != NULL ? pos->total_MC : PF_IMPOSSIBLE_MC);
+  return (pos != NULL && pos->tile != NULL
+          ? pos->total_MC : PF_IMPOSSIBLE_MC);
 }
 
 /************************************************************************//**
@@ -3852,7 +4355,7 @@ bool pf_reverse_map_utype_position(struct pf_reverse_map *pfrm,
   const struct pf_position *mypos = pf_reverse_map_utype_pos(pfrm, punittype,
                                                              ptile);
 
-  if (mypos != NULL) {
+  if (mypos != NULL && mypos->tile != NULL) {
     *pos = *mypos;
     return TRUE;
   } else {
@@ -3869,10 +4372,34 @@ bool pf_reverse_map_unit_position(struct pf_reverse_map *pfrm,
 {
   const struct pf_position *mypos = pf_reverse_map_unit_pos(pfrm, punit);
 
-  if (mypos != NULL) {
+  if (mypos != NULL && mypos->tile != NULL) {
     *pos = *mypos;
     return TRUE;
   } else {
     return FALSE;
   }
 }
+
+/************************************************************************//**
+  Fill the position of the unit for the target 'ptarget', which must be
+  one of the targets of the reverse map. Return TRUE if the target is
+  reachable.
+****************************************************************************/
+bool pf_reverse_map_unit_target_position(struct pf_reverse_map *pfrm,
+                                         const struct unit *punit,
+                                         const struct tile *ptarget,
+                                         struct pf_position *pos)
+{
+  int target = pf_reverse_map_target(pfrm, ptarget);
+  const struct pf_position *mypos;
+
+  fc_assert_ret_val(0 <= target, FALSE);
+
+  mypos = pf_reverse_map_unit_pos(pfrm, punit);
+  if (mypos != NULL && mypos[target].tile != NULL) {
+    *pos = mypos[target];
+    return TRUE;
+  } else {
+    return FALSE;
+  }
+}
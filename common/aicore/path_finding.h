@@ -194,6 +194,12 @@ extern "C" {
  *
  * You may call pf_map_path() multiple times with the same pfm.
  *
+ * If 'ptile' is the only position the map will be asked about, create it
+ * with pf_map_new_goal(&parameter, ptile) instead. The search then
+ * heads for 'ptile' rather than expanding all the positions closer to the
+ * start, and finds a path of the same cost; but the map must not be used
+ * for anything else.
+ *
  * B) the caller doesn't know the map position of the goal yet (but knows
  * what he is looking for, e.g. a port) and wants to iterate over
  * all paths in order of increasing costs (total_CC):
@@ -467,6 +473,28 @@ struct pf_map;
 /* The reverse map strucure. Opaque type. */
 struct pf_reverse_map;
 
+/* The kinds of pf_map, see pf_map_new(). */
+#define SPECENUM_NAME pf_map_type
+#define SPECENUM_VALUE0 PF_MAP_NORMAL
+#define SPECENUM_VALUE0NAME "Normal"
+#define SPECENUM_VALUE1 PF_MAP_DANGER
+#define SPECENUM_VALUE1NAME "Danger"
+#define SPECENUM_VALUE2 PF_MAP_FUEL
+#define SPECENUM_VALUE2NAME "Fuel"
+#define SPECENUM_COUNT PF_MAP_TYPE_COUNT
+#include "specenum_gen.h"
+
+/* Statistics about the pf_maps of one kind. The memory of a map is
+ * recycled for the next map of the same kind when it is destroyed. */
+struct pf_map_stats {
+  unsigned long maps;           /* Maps created. */
+  unsigned long allocated;      /* Maps which needed fresh memory. */
+  unsigned long reused;         /* Maps which reused a previous map's. */
+  unsigned long nodes;          /* Nodes initialized by the maps. */
+  unsigned long expanded;       /* Nodes processed by the maps. */
+  double seconds;               /* Time from creation to destruction. */
+};
+
 
 
 /* ========================= Public Interface ============================ */
@@ -474,6 +502,9 @@ struct pf_reverse_map;
 /* Create and free. */
 struct pf_map *pf_map_new(const struct pf_parameter *parameter)
                fc__warn_unused_result;
+struct pf_map *pf_map_new_goal(const struct pf_parameter *parameter,
+                               struct tile *goal)
+               fc__warn_unused_result;
 void pf_map_destroy(struct pf_map *pfm);
 
 /* Method A) functions. */
@@ -494,6 +525,13 @@ void pf_map_iter_position(struct pf_map *pfm, struct pf_position *pos);
 
 /* Other related functions. */
 const struct pf_parameter *pf_map_parameter(const struct pf_map *pfm);
+unsigned long pf_map_nodes_expanded(const struct pf_map *pfm);
+
+/* Memory pool and statistics. */
+void pf_workspaces_init(void);
+void pf_workspaces_free(void);
+void pf_map_stats_get(enum pf_map_type type, struct pf_map_stats *stats);
+void pf_map_stats_reset(void);
 
 
 /* Paths functions. */
@@ -522,6 +560,13 @@ struct pf_reverse_map *pf_reverse_map_new_for_city(const struct city *pcity,
                                                    int max_turns, bool omniscient,
                                                    const struct civ_map *map)
                        fc__warn_unused_result;
+struct pf_reverse_map *pf_reverse_map_new_for_tiles(const struct player *pplayer,
+                                                    struct tile *const *targets,
+                                                    int num_targets,
+                                                    int max_turns,
+                                                    bool omniscient,
+                                                    const struct civ_map *map)
+                       fc__warn_unused_result;
 void pf_reverse_map_destroy(struct pf_reverse_map *prfm);
 
 int pf_reverse_map_utype_move_cost(struct pf_reverse_map *pfrm,
@@ -536,6 +581,10 @@ bool pf_reverse_map_utype_position(struct pf_reverse_map *pfrm,
 bool pf_reverse_map_unit_position(struct pf_reverse_map *pfrm,
                                   const struct unit *punit,
                                   struct pf_position *pos);
+bool pf_reverse_map_unit_target_position(struct pf_reverse_map *pfrm,
+                                         const struct unit *punit,
+                                         const struct tile *ptarget,
+                                         struct pf_position *pos);
 
 
 
@@ -25,8 +25,11 @@
 /* common */
 #include "base.h"
 #include "combat.h"
+#include "effects.h"
 #include "game.h"
 #include "movement.h"
+#include "road.h"
+#include "terrain.h"
 #include "tile.h"
 #include "unit.h"
 #include "unittype.h"
@@ -424,6 +427,135 @@ static int amphibious_move(const struct tile *ptile,
   return cost;
 }
 
+/* Cheapest steps into native tiles of a unit class the map has to offer,
+ * see pft_map_step_costs(). */
+static struct {
+  unsigned int stamp;
+  int terrain_cost;     /* Cheapest terrain native only through extras */
+  int road_cost;        /* Cheapest bonus road */
+} pft_step_cache[UCL_LAST];
+
+/************************************************************************//**
+  Find the cheapest terrain only native to the class through the extras
+  on it, and the cheapest of the bonus roads of the class, among the tiles
+  of the map. Either is FC_INFINITY if the map has none. The results are
+  remembered until the map changes.
+****************************************************************************/
+static void pft_map_step_costs(const struct civ_map *nmap,
+                               const struct unit_class *pclass,
+                               int *terrain_cost, int *road_cost)
+{
+  int idx = uclass_index(pclass);
+  unsigned int stamp = (nmap == &(wld.map) ? effect_cache_map_stamp() : 0);
+  bool doubtful[MAX_NUM_TERRAINS];
+  bv_extras roads;
+
+  if (stamp != 0 && pft_step_cache[idx].stamp == stamp) {
+    *terrain_cost = pft_step_cache[idx].terrain_cost;
+    *road_cost = pft_step_cache[idx].road_cost;
+    return;
+  }
+
+  *terrain_cost = FC_INFINITY;
+  *road_cost = FC_INFINITY;
+
+  terrain_type_iterate(pterrain) {
+    doubtful[terrain_index(pterrain)]
+      = (0 < extra_type_list_size(pclass->cache.native_tile_extras)
+         && !is_native_to_class(pclass, pterrain, NULL));
+  } terrain_type_iterate_end;
+  BV_CLR_ALL(roads);
+  extra_type_list_iterate(pclass->cache.bonus_roads, pextra) {
+    BV_SET(roads, extra_index(pextra));
+  } extra_type_list_iterate_end;
+
+  whole_map_iterate(nmap, ptile) {
+    const struct terrain *pterrain = tile_terrain(ptile);
+
+    if (NULL != pterrain && doubtful[terrain_index(pterrain)]
+        && is_native_tile_to_class(pclass, ptile)) {
+      *terrain_cost = MIN(*terrain_cost,
+                          pterrain->movement_cost * SINGLE_MOVE);
+    }
+    if (BV_CHECK_MASK(ptile->extras, roads)) {
+      extra_type_list_iterate(pclass->cache.bonus_roads, pextra) {
+        if (tile_has_extra(ptile, pextra)) {
+          *road_cost = MIN(*road_cost, extra_road_get(pextra)->move_cost);
+        }
+      } extra_type_list_iterate_end;
+    }
+  } whole_map_iterate_end;
+
+  /* The cache must not be written while other threads may read it. */
+  if (stamp != 0 && !effect_cache_is_frozen()) {
+    pft_step_cache[idx].stamp = stamp;
+    pft_step_cache[idx].terrain_cost = *terrain_cost;
+    pft_step_cache[idx].road_cost = *road_cost;
+  }
+}
+
+/************************************************************************//**
+  Lower bound of the cost of any single step the map built with this
+  parameter may consider, for goal-directed searches. Returns 0 when there
+  is no useful bound, including when the move cost callback isn't one of
+  those set by this module. The bound holds for the map as it is now, so
+  it must not be kept across changes of the map.
+****************************************************************************/
+int pft_min_step_cost(const struct pf_parameter *param)
+{
+  const struct unit_class *pclass = utype_class(param->utype);
+  int cost;
+
+  if (param->get_MC != normal_move && param->get_MC != overlap_move) {
+    return 0;
+  }
+
+  /* Actions, unknown tiles, and moves one step out of native terrain. */
+  cost = MIN(SINGLE_MOVE, param->move_rate);
+  cost = MIN(cost, param->utype->unknown_move_cost);
+
+  if (uclass_has_flag(pclass, UCF_TERRAIN_SPEED)) {
+    bool extra_native
+      = (0 < extra_type_list_size(pclass->cache.native_tile_extras));
+    bool scan = FALSE;
+
+    if (utype_has_flag(param->utype, UTYF_IGTER)) {
+      cost = MIN(cost, MOVE_COST_IGTER);
+    }
+
+    /* Terrain cost only applies to steps into native tiles. Terrains not
+     * native by themselves only count where an extra makes them native. */
+    terrain_type_iterate(pterrain) {
+      int tcost = pterrain->movement_cost * SINGLE_MOVE;
+
+      if (is_native_to_class(pclass, pterrain, NULL)) {
+        cost = MIN(cost, tcost);
+      } else if (tcost < cost && extra_native) {
+        scan = TRUE;
+      }
+    } terrain_type_iterate_end;
+
+    /* Likewise cheaper roads only count if there are some on the map.
+     * Rulesets often have free moves along railroads, which would leave
+     * no bound at all for the most part of the game. */
+    extra_type_list_iterate(pclass->cache.bonus_roads, pextra) {
+      if (extra_road_get(pextra)->move_cost < cost) {
+        scan = TRUE;
+      }
+    } extra_type_list_iterate_end;
+
+    if (scan) {
+      int terrain_cost, road_cost;
+
+      pft_map_step_costs(param->map, pclass, &terrain_cost, &road_cost);
+      cost = MIN(cost, terrain_cost);
+      cost = MIN(cost, road_cost);
+    }
+  }
+
+  return MAX(cost, 0);
+}
+
 /* ===================== Extra Cost Callbacks ======================== */
 
 /************************************************************************//**
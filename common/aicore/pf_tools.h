@@ -66,6 +66,7 @@ void pft_fill_reverse_parameter(struct pf_parameter *parameter,
                                 struct tile *target_tile);
 
 void pft_fill_amphibious_parameter(struct pft_amphibious *parameter);
+int pft_min_step_cost(const struct pf_parameter *param);
 enum tile_behavior no_fights_or_unknown(const struct tile *ptile,
                                         enum known_type known,
                                         const struct pf_parameter *param);
@@ -804,9 +804,10 @@ bool can_city_build_improvement_direct(const struct city *pcity,
     return FALSE;
   }
 
-  return are_reqs_active(city_owner(pcity), NULL, pcity, NULL,
-                         pcity->tile, NULL, NULL, NULL, NULL, NULL,
-                         &(pimprove->reqs), RPT_CERTAIN);
+  return are_reqs_active_prog(city_owner(pcity), NULL, pcity, NULL,
+                              pcity->tile, NULL, NULL, NULL, NULL, NULL,
+                              &(pimprove->reqs), &(pimprove->reqs_prog),
+                              RPT_CERTAIN);
 }
 
 /**********************************************************************//**
@@ -1216,23 +1217,126 @@ int city_improvement_upkeep(const struct city *pcity,
 }
 
 /**********************************************************************//**
-  Calculate the output for the tile.
-  pcity may be NULL.
-  is_celebrating may be speculative.
-  otype is the output type (generally O_FOOD, O_TRADE, or O_SHIELD).
+  Tile output cache. On the server the results of city_tile_output() for
+  real cities and tiles are remembered in a map-wide table with one entry
+  per tile and celebration state, shared by city refresh, the CM and the
+  advisors.
+
+  An entry belongs to one city and records the tile's terrain and extras
+  and the properties of the city and its owner that the effect cache
+  keys on. It is stamped with the sum of the effect cache stamps of the
+  effect types city_tile_output() reads, so building, tech and tile
+  changes and city creation and removal invalidate it. The output types
+  are filled in as they are asked for.
+**************************************************************************/
+#undef TILE_OUTPUT_CACHE_DEBUGGING
+
+struct tile_output_entry {
+  unsigned int stamp; /* 0 for unused entries */
+  int city_id;
+  const struct government *gov;
+  const struct terrain *terrain;
+  bv_extras extras;
+  short city_size;
+  short city_radius_sq;
+  short ai_level;
+  unsigned char known; /* Bit for each output type in output[] */
+  short output[O_LAST];
+};
 
-  This can be used to calculate the benefits celebration would give.
+static struct {
+  /* Two entries for each tile; the second one is for celebration. */
+  struct tile_output_entry *entries;
+  const struct tile *tiles;
+  int num_tiles;
+} tile_output_cache;
+
+static const enum effect_type tile_output_effects[] = {
+  EFT_MINING_PCT,
+  EFT_IRRIGATION_PCT,
+  EFT_OUTPUT_ADD_TILE,
+  EFT_OUTPUT_PENALTY_TILE,
+  EFT_OUTPUT_INC_TILE_CELEBRATE,
+  EFT_OUTPUT_INC_TILE,
+  EFT_OUTPUT_PER_TILE,
+  EFT_OUTPUT_TILE_PUNISH_PCT
+};
+
+/**********************************************************************//**
+  Return the current stamp of the tile output cache, or 0 if the output
+  can't be remembered.
 **************************************************************************/
-int city_tile_output(const struct city *pcity, const struct tile *ptile,
-                     bool is_celebrating, Output_type_id otype)
+static unsigned int tile_output_cache_stamp(void)
+{
+  unsigned int stamp = 0;
+  int i;
+
+  for (i = 0; i < ARRAY_SIZE(tile_output_effects); i++) {
+    unsigned int type_stamp = effect_cache_stamp(tile_output_effects[i]);
+
+    if (type_stamp == 0) {
+      return 0;
+    }
+    stamp += type_stamp;
+  }
+
+  return stamp;
+}
+
+/**********************************************************************//**
+  Return the cache entry for the tile, or NULL if the tile output cache
+  can't be used for it.
+**************************************************************************/
+static struct tile_output_entry *
+tile_output_cache_entry(const struct tile *ptile, bool is_celebrating)
+{
+  if (wld.map.tiles == NULL
+      || ptile->index < 0 || ptile->index >= MAP_INDEX_SIZE
+      || ptile != wld.map.tiles + ptile->index) {
+    /* Virtual tile */
+    return NULL;
+  }
+
+  if (tile_output_cache.tiles != wld.map.tiles
+      || tile_output_cache.num_tiles != MAP_INDEX_SIZE) {
+    if (effect_cache_is_frozen()) {
+      return NULL;
+    }
+    free(tile_output_cache.entries);
+    tile_output_cache.entries
+      = fc_calloc(2 * MAP_INDEX_SIZE, sizeof(*tile_output_cache.entries));
+    tile_output_cache.tiles = wld.map.tiles;
+    tile_output_cache.num_tiles = MAP_INDEX_SIZE;
+  }
+
+  return &tile_output_cache.entries[2 * ptile->index
+                                    + (is_celebrating ? 1 : 0)];
+}
+
+/**********************************************************************//**
+  Free the tile output cache.
+**************************************************************************/
+void city_tile_output_cache_free(void)
+{
+  free(tile_output_cache.entries);
+  tile_output_cache.entries = NULL;
+  tile_output_cache.tiles = NULL;
+  tile_output_cache.num_tiles = 0;
+}
+
+/**********************************************************************//**
+  Calculate the output for the tile without using the tile output cache.
+  See city_tile_output().
+**************************************************************************/
+static int city_tile_output_eval(const struct city *pcity,
+                                 const struct tile *ptile,
+                                 bool is_celebrating, Output_type_id otype)
 {
   int prod;
   struct terrain *pterrain = tile_terrain(ptile);
   const struct output_type *output = &output_types[otype];
   struct player *pplayer = NULL;
 
-  fc_assert_ret_val(otype >= 0 && otype < O_LAST, 0);
-
   if (T_UNKNOWN == pterrain) {
     /* Special case for the client.  The server doesn't allow unknown tiles
      * to be worked but we don't necessarily know what player is involved. */
@@ -1311,6 +1415,80 @@ int city_tile_output(const struct city *pcity, const struct tile *ptile,
   return prod;
 }
 
+/**********************************************************************//**
+  Calculate the output for the tile.
+  pcity may be NULL.
+  is_celebrating may be speculative.
+  otype is the output type (generally O_FOOD, O_TRADE, or O_SHIELD).
+
+  This can be used to calculate the benefits celebration would give.
+**************************************************************************/
+int city_tile_output(const struct city *pcity, const struct tile *ptile,
+                     bool is_celebrating, Output_type_id otype)
+{
+  struct tile_output_entry *pentry;
+  const struct player *owner;
+  unsigned int stamp;
+  int ai_level, prod;
+
+  fc_assert_ret_val(otype >= 0 && otype < O_LAST, 0);
+
+  if (pcity == NULL || city_is_virtual(pcity)
+      || (stamp = tile_output_cache_stamp()) == 0
+      || (pentry = tile_output_cache_entry(ptile, is_celebrating)) == NULL) {
+    return city_tile_output_eval(pcity, ptile, is_celebrating, otype);
+  }
+
+  owner = city_owner(pcity);
+  ai_level = is_ai(owner) ? owner->ai_common.skill_level : -1;
+
+  if (pentry->stamp != stamp
+      || pentry->city_id != pcity->id
+      || pentry->city_size != city_size_get(pcity)
+      || pentry->city_radius_sq != city_map_radius_sq_get(pcity)
+      || pentry->gov != owner->government
+      || pentry->ai_level != ai_level
+      || pentry->terrain != tile_terrain(ptile)
+      || !BV_ARE_EQUAL(pentry->extras, *tile_extras(ptile))) {
+    if (effect_cache_is_frozen()) {
+      /* Can't store anything. */
+      return city_tile_output_eval(pcity, ptile, is_celebrating, otype);
+    }
+
+    pentry->stamp = stamp;
+    pentry->city_id = pcity->id;
+    pentry->city_size = city_size_get(pcity);
+    pentry->city_radius_sq = city_map_radius_sq_get(pcity);
+    pentry->gov = owner->government;
+    pentry->ai_level = ai_level;
+    pentry->terrain = tile_terrain(ptile);
+    pentry->extras = *tile_extras(ptile);
+    pentry->known = 0;
+  }
+
+  if (pentry->known & (1 << otype)) {
+#ifdef TILE_OUTPUT_CACHE_DEBUGGING
+    prod = city_tile_output_eval(pcity, ptile, is_celebrating, otype);
+    if (prod != pentry->output[otype]) {
+      log_error("Tile output cache: %s at (%d, %d) for %s cached as %d, "
+                "actually %d.", get_output_identifier(otype),
+                TILE_XY(ptile), city_name_get(pcity),
+                pentry->output[otype], prod);
+    }
+#endif /* TILE_OUTPUT_CACHE_DEBUGGING */
+    return pentry->output[otype];
+  }
+
+  prod = city_tile_output_eval(pcity, ptile, is_celebrating, otype);
+
+  if (!effect_cache_is_frozen()) {
+    pentry->output[otype] = prod;
+    pentry->known |= 1 << otype;
+  }
+
+  return prod;
+}
+
 /**********************************************************************//**
   Calculate the production output the given tile is capable of producing
   for the city.  The output type is given by 'otype' (generally O_FOOD,
@@ -1527,6 +1705,65 @@ bool is_gov_center(const struct city *pcity)
   return (get_city_bonus(pcity, EFT_GOV_CENTER) > 0);
 }
 
+/**********************************************************************//**
+  Can the list of government centers be remembered? The Gov_Center
+  effect must not read city properties which the effect cache stamp
+  does not cover.
+**************************************************************************/
+static bool gov_centers_cacheable(void)
+{
+  effect_list_iterate(get_effects(EFT_GOV_CENTER), peffect) {
+    requirement_vector_iterate(&peffect->reqs, preq) {
+      if (preq->source.kind == VUT_MINSIZE
+          || preq->source.kind == VUT_AI_LEVEL) {
+        return FALSE;
+      }
+    } requirement_vector_iterate_end;
+  } effect_list_iterate_end;
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Return the cities of the player that are government centers, or NULL
+  if they can't be remembered (on the client, or while the effect cache
+  is frozen and the list is out of date). The list is rebuilt when the
+  effect cache stamp of Gov_Center, the player's government or the
+  number of cities of the player changes.
+**************************************************************************/
+struct city_list *player_gov_centers(struct player *pplayer)
+{
+  unsigned int stamp = effect_cache_stamp(EFT_GOV_CENTER);
+
+  if (stamp == 0) {
+    return NULL;
+  }
+
+  if (pplayer->gov_centers_stamp == stamp
+      && pplayer->gov_centers_gov == pplayer->government
+      && pplayer->gov_centers_num_cities
+         == city_list_size(pplayer->cities)) {
+    return pplayer->gov_centers;
+  }
+
+  if (effect_cache_is_frozen() || !gov_centers_cacheable()) {
+    return NULL;
+  }
+
+  city_list_clear(pplayer->gov_centers);
+  city_list_iterate(pplayer->cities, pcity) {
+    if (is_gov_center(pcity)) {
+      city_list_append(pplayer->gov_centers, pcity);
+    }
+  } city_list_iterate_end;
+
+  pplayer->gov_centers_stamp = stamp;
+  pplayer->gov_centers_gov = pplayer->government;
+  pplayer->gov_centers_num_cities = city_list_size(pplayer->cities);
+
+  return pplayer->gov_centers;
+}
+
 /**********************************************************************//**
  This can be City Walls, Coastal defense... depending on attacker type.
  If attacker type is not given, just any defense effect will do.
@@ -2981,6 +3218,18 @@ static inline void city_support(struct city *pcity)
   If 'workers_map' is set, only basic updates are needed.
 **************************************************************************/
 void city_refresh_from_main_map(struct city *pcity, bool *workers_map)
+{
+  city_refresh_citizen_base(pcity, workers_map);
+  city_refresh_surpluses(pcity);
+}
+
+/**********************************************************************//**
+  First half of city_refresh_from_main_map(): everything up to and
+  including the citizen_base[] output. This only depends on the city
+  itself and on the main map, so it can be run for several cities at
+  once.
+**************************************************************************/
+void city_refresh_citizen_base(struct city *pcity, bool *workers_map)
 {
   if (workers_map == NULL) {
     /* do a full refresh */
@@ -2996,7 +3245,16 @@ void city_refresh_from_main_map(struct city *pcity, bool *workers_map)
   /* Calculate output from citizens (uses city_tile_cache_get_output()). */
   get_worked_tile_output(pcity, pcity->citizen_base, workers_map);
   add_specialist_output(pcity, pcity->citizen_base);
+}
 
+/**********************************************************************//**
+  Second half of city_refresh_from_main_map(): production, happiness and
+  surpluses. Trade routes read the partner cities' citizen_base[], so
+  when refreshing several cities at once, all of them must have gone
+  through city_refresh_citizen_base() before this is called for any.
+**************************************************************************/
+void city_refresh_surpluses(struct city *pcity)
+{
   set_city_production(pcity);
   citizen_base_mood(pcity);
   /* Note that pollution is calculated before unhappy_city_check() makes
@@ -3082,9 +3340,12 @@ int city_waste(const struct city *pcity, Output_type_id otype, int total,
         gov_center = pcity;
         min_dist = 0;
       } else {
-        city_list_iterate(city_owner(pcity)->cities, gc) {
+        struct player *owner = city_owner(pcity);
+        struct city_list *centers = player_gov_centers(owner);
+
+        city_list_iterate((centers != NULL ? centers : owner->cities), gc) {
           /* Do not recheck current city */
-          if (gc != pcity && is_gov_center(gc)) {
+          if (gc != pcity && (centers != NULL || is_gov_center(gc))) {
             int dist = real_map_distance(gc->tile, pcity->tile);
 
             if (dist < min_dist) {
@@ -3183,6 +3444,7 @@ void city_add_improvement(struct city *pcity,
 			  const struct impr_type *pimprove)
 {
   pcity->built[improvement_index(pimprove)].turn = game.info.turn; /*I_ACTIVE*/
+  effect_cache_changed(ECD_BUILDING);
 
   if (is_server() && is_wonder(pimprove)) {
     /* Client just read the info from the packets. */
@@ -3200,6 +3462,7 @@ void city_remove_improvement(struct city *pcity,
             improvement_rule_name(pimprove), pcity->name);
   
   pcity->built[improvement_index(pimprove)].turn = I_DESTROYED;
+  effect_cache_changed(ECD_BUILDING);
 
   if (is_server() && is_wonder(pimprove)) {
     /* Client just read the info from the packets. */
@@ -3342,6 +3605,7 @@ void destroy_city_virtual(struct city *pcity)
   if (pcity->tile_cache != NULL) {
     free(pcity->tile_cache);
   }
+  cm_clear_cache(pcity);
 
   if (!is_server()) {
     unit_list_destroy(pcity->client.info_units_supported);
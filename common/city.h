@@ -334,6 +334,10 @@ struct city {
    * radius. */
   int tile_cache_radius_sq;
 
+  /* Solver state of the citizen governor, kept between queries.
+   * (see cm_query_result() and cm_clear_cache()) */
+  struct cm_cache *cm_cache;
+
   /* the productions */
   int surplus[O_LAST]; /* Final surplus in each category. */
   int waste[O_LAST]; /* Waste/corruption in each category. */
@@ -587,6 +591,7 @@ bool city_has_building(const struct city *pcity,
 		       const struct impr_type *pimprove);
 bool is_capital(const struct city *pcity);
 bool is_gov_center(const struct city *pcity);
+struct city_list *player_gov_centers(struct player *pplayer);
 bool city_got_defense_effect(const struct city *pcity,
                              const struct unit_type *attacker);
 
@@ -644,6 +649,7 @@ void city_production_caravan_shields_init(void);
 /* output on spot */
 int city_tile_output(const struct city *pcity, const struct tile *ptile,
 		     bool is_celebrating, Output_type_id otype);
+void city_tile_output_cache_free(void);
 int city_tile_output_now(const struct city *pcity, const struct tile *ptile,
 			 Output_type_id otype);
 
@@ -695,6 +701,8 @@ void city_remove_improvement(struct city *pcity,
 
 /* city update functions */
 void city_refresh_from_main_map(struct city *pcity, bool *workers_map);
+void city_refresh_citizen_base(struct city *pcity, bool *workers_map);
+void city_refresh_surpluses(struct city *pcity);
 
 int city_waste(const struct city *pcity, Output_type_id otype, int total,
                int *breakdown);
@@ -16,6 +16,8 @@
 #endif
 
 #include <math.h>
+#include <stdint.h>
+#include <string.h>
 
 /* utility */
 #include "bitvector.h"
@@ -24,6 +26,7 @@
 
 /* common */
 #include "base.h"
+#include "effects.h"
 #include "game.h"
 #include "map.h"
 #include "movement.h"
@@ -248,22 +251,13 @@ bool can_unit_attack_tile(const struct unit *punit,
 }
 
 /*******************************************************************//**
-Returns the chance of the attacker winning, a number between 0 and 1.
-If you want the chance that the defender wins just use 1-chance(...)
-
-NOTE: this number can be _very_ small, fx in a battle between an
-ironclad and a battleship the ironclad has less than 1/100000 chance of
-winning.
-
-The algoritm calculates the probability of each possible number of HP's
-the attacker has left. Maybe that info should be preserved for use in
-the AI.
+  Returns the chance of the attacker winning, given the strengths of
+  both sides and the number of rounds each of them can lose. This is
+  all win_chance() depends on.
 ***********************************************************************/
-double win_chance(int as, int ahp, int afp, int ds, int dhp, int dfp)
+static double win_chance_rounds(int as, int att_N_lose,
+                                int ds, int def_N_lose)
 {
-  /* number of rounds a unit can fight without dying */
-  int att_N_lose = (ahp + dfp - 1) / dfp;
-  int def_N_lose = (dhp + afp - 1) / afp;
   /* Probability of losing one round */
   double att_P_lose1 = (as + ds == 0) ? 0.5 : (double) ds / (as + ds);
   double def_P_lose1 = 1 - att_P_lose1;
@@ -333,6 +327,124 @@ double win_chance(int as, int ahp, int afp, int ds, int dhp, int dfp)
   return accum_prob;
 }
 
+/*******************************************************************//**
+Returns the chance of the attacker winning, a number between 0 and 1.
+If you want the chance that the defender wins just use 1-chance(...)
+
+NOTE: this number can be _very_ small, fx in a battle between an
+ironclad and a battleship the ironclad has less than 1/100000 chance of
+winning.
+
+The algoritm calculates the probability of each possible number of HP's
+the attacker has left. Maybe that info should be preserved for use in
+the AI.
+***********************************************************************/
+double win_chance(int as, int ahp, int afp, int ds, int dhp, int dfp)
+{
+  /* number of rounds a unit can fight without dying */
+  int att_N_lose = (ahp + dfp - 1) / dfp;
+  int def_N_lose = (dhp + afp - 1) / afp;
+
+  return win_chance_rounds(as, att_N_lose, ds, def_N_lose);
+}
+
+/* What win_chance() depends on for one fight of a batch. */
+struct win_chance_key {
+  int att_strength, att_N_lose;
+  int def_strength, def_N_lose;
+  int index;
+};
+
+/* The number of fights win_chance_batch() handles without allocating. */
+#define WIN_CHANCE_BATCH_STACK 16
+
+/*******************************************************************//**
+  Compare the odds of two fights, ignoring where they are in the batch.
+***********************************************************************/
+static int win_chance_key_odds_cmp(const struct win_chance_key *a,
+                                   const struct win_chance_key *b)
+{
+  if (a->att_strength != b->att_strength) {
+    return a->att_strength < b->att_strength ? -1 : 1;
+  }
+  if (a->def_strength != b->def_strength) {
+    return a->def_strength < b->def_strength ? -1 : 1;
+  }
+  if (a->att_N_lose != b->att_N_lose) {
+    return a->att_N_lose < b->att_N_lose ? -1 : 1;
+  }
+  if (a->def_N_lose != b->def_N_lose) {
+    return a->def_N_lose < b->def_N_lose ? -1 : 1;
+  }
+
+  return 0;
+}
+
+/*******************************************************************//**
+  qsort() callback: order fights by their odds, then by their place in
+  the batch.
+***********************************************************************/
+static int win_chance_key_cmp(const void *va, const void *vb)
+{
+  const struct win_chance_key *a = va;
+  const struct win_chance_key *b = vb;
+  int diff = win_chance_key_odds_cmp(a, b);
+
+  if (diff != 0) {
+    return diff;
+  }
+
+  return a->index - b->index;
+}
+
+/*******************************************************************//**
+  Fill 'chances' with the chance of the attacker winning each of the
+  'count' fights. The results are exactly those of win_chance(), but
+  the odds of a fight identical to an earlier one, like when attacking
+  a stack of the same units, are only computed once: the fights are
+  sorted by their odds, so that identical ones end up next to each other.
+***********************************************************************/
+void win_chance_batch(const struct combat_odds *fights, int count,
+                      double *chances)
+{
+  struct win_chance_key keys_stack[WIN_CHANCE_BATCH_STACK];
+  struct win_chance_key *keys = keys_stack;
+  int i;
+
+  if (count > WIN_CHANCE_BATCH_STACK) {
+    keys = fc_malloc(count * sizeof(*keys));
+  }
+
+  for (i = 0; i < count; i++) {
+    const struct combat_odds *fight = fights + i;
+
+    keys[i].att_strength = fight->att_strength;
+    keys[i].att_N_lose = (fight->att_hp + fight->def_fp - 1) / fight->def_fp;
+    keys[i].def_strength = fight->def_strength;
+    keys[i].def_N_lose = (fight->def_hp + fight->att_fp - 1) / fight->att_fp;
+    keys[i].index = i;
+  }
+
+  qsort(keys, count, sizeof(*keys), win_chance_key_cmp);
+
+  for (i = 0; i < count; i++) {
+    const struct win_chance_key *key = keys + i;
+
+    if (i > 0 && 0 == win_chance_key_odds_cmp(key, key - 1)) {
+      chances[key->index] = chances[(key - 1)->index];
+    } else {
+      chances[key->index] = win_chance_rounds(key->att_strength,
+                                              key->att_N_lose,
+                                              key->def_strength,
+                                              key->def_N_lose);
+    }
+  }
+
+  if (keys != keys_stack) {
+    free(keys);
+  }
+}
+
 /*******************************************************************//**
 A unit's effective firepower depend on the situation.
 ***********************************************************************/
@@ -652,37 +764,210 @@ int get_fortified_defense_power(const struct unit *attacker,
                                 TRUE);
 }
 
+/*******************************************************************//**
+  Fill in the strengths of a fight between attacker and defender, as
+  used by win_chance().
+***********************************************************************/
+void get_combat_odds(const struct unit *attacker,
+                     const struct unit *defender,
+                     struct combat_odds *fight)
+{
+  fight->att_strength = get_total_attack_power(attacker, defender);
+  fight->att_hp = attacker->hp;
+  fight->def_strength = get_total_defense_power(attacker, defender);
+  fight->def_hp = defender->hp;
+  get_modified_firepower(attacker, defender,
+                         &fight->att_fp, &fight->def_fp);
+}
+
 /*******************************************************************//**
 A number indicating the defense strength.
 Unlike the one got from win chance this doesn't potentially get insanely
 small if the units are unevenly matched, unlike win_chance.
 ***********************************************************************/
-static int get_defense_rating(const struct unit *attacker,
-			      const struct unit *defender)
+static int get_defense_rating(const struct combat_odds *fight)
 {
-  int afp, dfp;
-
-  int rating = get_total_defense_power(attacker, defender);
-  get_modified_firepower(attacker, defender, &afp, &dfp);
+  int rating = fight->def_strength;
 
   /* How many rounds the defender will last */
-  rating *= (defender->hp + afp-1)/afp;
+  rating *= (fight->def_hp + fight->att_fp - 1) / fight->att_fp;
 
-  rating *= dfp;
+  rating *= fight->def_fp;
 
   return rating;
 }
 
+/* The number of defenders get_defender() handles without allocating. */
+#define GET_DEFENDER_STACK 16
+
+/*******************************************************************//**
+  Best defender cache. get_defender() is asked for the same stacks over
+  and over by the AI and by action probabilities, so on the server its
+  results are remembered in a direct mapped table keyed on the tile and
+  on everything about the attacker that the fight depends on.
+
+  An entry is valid as long as the effect cache stamps of the bonuses
+  involved and the tile generation are unchanged (together they cover
+  the state the bonuses read, terrain and extras of any tile and city
+  creation and removal) and the stack fingerprint matches. The
+  fingerprint covers, in list order, the properties of each unit on the
+  tile which the choice depends on; computing it is much cheaper than
+  rating the defenders.
+***********************************************************************/
+#undef DEFENDER_CACHE_DEBUGGING
+
+#define DEFENDER_CACHE_SIZE (1 << 12)
+
+struct defender_cache_key {
+  const struct tile *ptile;
+  const struct unit_type *att_type;
+  const struct player *att_owner;
+  const struct government *att_gov;
+  const struct tile *att_tile;
+  int att_ai_level;
+  int att_veteran;
+  int att_hp;
+  int att_moves;
+  int city_size;
+  int city_radius_sq;
+  bool tired_attack;
+  bool killstack;
+};
+
+struct defender_cache_entry {
+  unsigned int stamp; /* 0 for unused entries */
+  int stack_size;
+  uint64_t stack_hash;
+  struct defender_cache_key key;
+  struct unit *bestdef;
+};
+
+static struct defender_cache_entry *defender_cache = NULL;
+
+/*******************************************************************//**
+  Is the tile part of the real map, rather than a virtual copy?
+***********************************************************************/
+static bool defender_cache_tile_is_real(const struct tile *ptile)
+{
+  return (ptile != NULL && wld.map.tiles != NULL
+          && 0 <= ptile->index && ptile->index < MAP_INDEX_SIZE
+          && ptile == wld.map.tiles + ptile->index);
+}
+
 /*******************************************************************//**
-  Finds the best defender on the tile, given an attacker.  The diplomatic
-  relationship of attacker and defender is ignored; the caller should check
-  this.
+  Fingerprint of the units on the tile, as far as get_defender() cares.
 ***********************************************************************/
-struct unit *get_defender(const struct unit *attacker,
-			  const struct tile *ptile)
+static uint64_t defender_cache_stack_hash(const struct tile *ptile)
+{
+  uint64_t h = 0xcbf29ce484222325ULL;
+
+#define DC_MIX(_v) h = (h ^ (uint64_t) (_v)) * 0x100000001b3ULL
+  unit_list_iterate(ptile->units, punit) {
+    const struct player *owner = unit_owner(punit);
+    const struct unit *ptrans = unit_transport_get(punit);
+
+    DC_MIX(punit->id);
+    DC_MIX(utype_index(unit_type_get(punit)));
+    DC_MIX(punit->veteran);
+    DC_MIX(punit->hp);
+    DC_MIX(punit->activity);
+    DC_MIX(player_index(owner));
+    DC_MIX((uintptr_t) owner->government);
+    DC_MIX(is_ai(owner) ? owner->ai_common.skill_level : -1);
+    DC_MIX(ptrans != NULL ? ptrans->id : -1);
+  } unit_list_iterate_end;
+#undef DC_MIX
+
+  return h;
+}
+
+/*******************************************************************//**
+  Fill in the cache key of the attacker and the tile.
+***********************************************************************/
+static void defender_cache_key_init(struct defender_cache_key *key,
+                                    const struct unit *attacker,
+                                    const struct tile *ptile)
+{
+  const struct player *owner = unit_owner(attacker);
+  const struct city *pcity = tile_city(ptile);
+
+  /* Zero the padding too, keys are compared with memcmp(). */
+  memset(key, 0, sizeof(*key));
+  key->ptile = ptile;
+  key->att_type = unit_type_get(attacker);
+  key->att_owner = owner;
+  key->att_gov = owner->government;
+  key->att_tile = unit_tile(attacker);
+  key->att_ai_level = is_ai(owner) ? owner->ai_common.skill_level : -1;
+  key->att_veteran = attacker->veteran;
+  key->att_hp = attacker->hp;
+  /* Moves left only matter for tired attack. */
+  key->att_moves = game.info.tired_attack
+                   ? MIN(attacker->moves_left, SINGLE_MOVE) : 0;
+  if (pcity != NULL) {
+    key->city_size = city_size_get(pcity);
+    key->city_radius_sq = city_map_radius_sq_get(pcity);
+  }
+  key->tired_attack = game.info.tired_attack;
+  key->killstack = game.info.killstack;
+}
+
+/*******************************************************************//**
+  Table slot for the key.
+***********************************************************************/
+static struct defender_cache_entry *
+defender_cache_slot(const struct defender_cache_key *key)
+{
+  uintptr_t h = tile_index(key->ptile);
+
+#define DC_MIX(_v) h = (h ^ (uintptr_t) (_v)) * 0x9E3779B1u
+  DC_MIX(key->att_type);
+  DC_MIX(key->att_owner);
+  DC_MIX(key->att_tile);
+  DC_MIX(key->att_veteran);
+  DC_MIX(key->att_hp);
+  DC_MIX(key->att_moves);
+#undef DC_MIX
+
+  h ^= (h >> 15) ^ (h >> 29);
+
+  return &defender_cache[h & (DEFENDER_CACHE_SIZE - 1)];
+}
+
+/*******************************************************************//**
+  Free the best defender cache.
+***********************************************************************/
+void combat_cache_free(void)
+{
+  if (defender_cache != NULL) {
+    free(defender_cache);
+    defender_cache = NULL;
+  }
+}
+
+/*******************************************************************//**
+  Finds the best defender on the tile without using the cache.
+  See get_defender().
+***********************************************************************/
+static struct unit *get_defender_eval(const struct unit *attacker,
+                                      const struct tile *ptile)
 {
   struct unit *bestdef = NULL;
   int bestvalue = -99, best_cost = 0, rating_of_best = 0;
+  struct unit *defenders_stack[GET_DEFENDER_STACK];
+  struct combat_odds fights_stack[GET_DEFENDER_STACK];
+  double chances_stack[GET_DEFENDER_STACK];
+  struct unit **defenders = defenders_stack;
+  struct combat_odds *fights = fights_stack;
+  double *chances = chances_stack;
+  int count = 0, size = unit_list_size(ptile->units);
+  int i;
+
+  if (size > GET_DEFENDER_STACK) {
+    defenders = fc_malloc(size * sizeof(*defenders));
+    fights = fc_malloc(size * sizeof(*fights));
+    chances = fc_malloc(size * sizeof(*chances));
+  }
 
   /* Simply call win_chance with all the possible defenders in turn, and
    * take the best one.  It currently uses build cost as a tiebreaker in
@@ -698,42 +983,128 @@ struct unit *get_defender(const struct unit *attacker,
      * complicated and is now handled elsewhere. */
     if (unit_can_defend_here(&(wld.map), defender)
         && unit_attack_unit_at_tile_result(attacker, defender, ptile) == ATT_OK) {
-      bool change = FALSE;
-      int build_cost = unit_build_shield_cost_base(defender);
-      int defense_rating = get_defense_rating(attacker, defender);
-      /* This will make units roughly evenly good defenders look alike. */
-      int unit_def 
-        = (int) (100000 * (1 - unit_win_chance(attacker, defender)));
-
-      fc_assert_action(0 <= unit_def, continue);
-
-      if (unit_has_type_flag(defender, UTYF_GAMELOSS)
-          && !is_stack_vulnerable(unit_tile(defender))) {
-        unit_def = -1; /* then always use leader as last defender. */
-        /* FIXME: multiple gameloss units with varying defense value
-         * not handled. */
-      }
+      defenders[count] = defender;
+      get_combat_odds(attacker, defender, fights + count);
+      count++;
+    }
+  } unit_list_iterate_end;
 
-      if (unit_def > bestvalue) {
-	change = TRUE;
-      } else if (unit_def == bestvalue) {
-	if (build_cost < best_cost) {
-	  change = TRUE;
-	} else if (build_cost == best_cost) {
-	  if (rating_of_best < defense_rating) {	
-	    change = TRUE;
-	  }
-	}
-      }
+  /* The odds against identical defenders are computed only once. */
+  win_chance_batch(fights, count, chances);
+
+  for (i = 0; i < count; i++) {
+    struct unit *defender = defenders[i];
+    bool change = FALSE;
+    int build_cost = unit_build_shield_cost_base(defender);
+    int defense_rating = get_defense_rating(fights + i);
+    /* This will make units roughly evenly good defenders look alike. */
+    int unit_def = (int) (100000 * (1 - chances[i]));
+
+    fc_assert_action(0 <= unit_def, continue);
+
+    if (unit_has_type_flag(defender, UTYF_GAMELOSS)
+        && !is_stack_vulnerable(unit_tile(defender))) {
+      unit_def = -1; /* then always use leader as last defender. */
+      /* FIXME: multiple gameloss units with varying defense value
+       * not handled. */
+    }
 
-      if (change) {
-	bestvalue = unit_def;
-	bestdef = defender;
-	best_cost = build_cost;
-	rating_of_best = defense_rating;
+    if (unit_def > bestvalue) {
+      change = TRUE;
+    } else if (unit_def == bestvalue) {
+      if (build_cost < best_cost) {
+        change = TRUE;
+      } else if (build_cost == best_cost) {
+        if (rating_of_best < defense_rating) {
+          change = TRUE;
+        }
       }
     }
-  } unit_list_iterate_end;
+
+    if (change) {
+      bestvalue = unit_def;
+      bestdef = defender;
+      best_cost = build_cost;
+      rating_of_best = defense_rating;
+    }
+  }
+
+  if (defenders != defenders_stack) {
+    free(defenders);
+    free(fights);
+    free(chances);
+  }
+
+  return bestdef;
+}
+
+/*******************************************************************//**
+  Finds the best defender on the tile, given an attacker.  The diplomatic
+  relationship of attacker and defender is ignored; the caller should check
+  this.
+***********************************************************************/
+struct unit *get_defender(const struct unit *attacker,
+			  const struct tile *ptile)
+{
+  struct defender_cache_key key;
+  struct defender_cache_entry *pentry;
+  struct unit *bestdef;
+  unsigned int def_stamp, att_stamp, stamp;
+  uint64_t stack_hash;
+  int stack_size = unit_list_size(ptile->units);
+
+  if (stack_size < 2) {
+    /* Nothing to choose from. */
+    return get_defender_eval(attacker, ptile);
+  }
+
+  def_stamp = effect_cache_stamp(EFT_DEFEND_BONUS);
+  att_stamp = effect_cache_stamp(EFT_ATTACK_BONUS);
+  if (def_stamp == 0 || att_stamp == 0
+      || effect_cache_is_frozen()
+      || !is_server()
+      || !defender_cache_tile_is_real(ptile)
+      || !defender_cache_tile_is_real(unit_tile(attacker))) {
+    return get_defender_eval(attacker, ptile);
+  }
+
+  if (defender_cache == NULL) {
+    defender_cache = fc_calloc(DEFENDER_CACHE_SIZE,
+                               sizeof(*defender_cache));
+  }
+
+  /* Terrain and extras of the tiles matter even if the bonuses don't
+   * depend on them. */
+  stamp = def_stamp + att_stamp + effect_cache_generation(ECD_TILE);
+  defender_cache_key_init(&key, attacker, ptile);
+  stack_hash = defender_cache_stack_hash(ptile);
+
+  pentry = defender_cache_slot(&key);
+  if (pentry->stamp == stamp
+      && pentry->stack_size == stack_size
+      && pentry->stack_hash == stack_hash
+      && memcmp(&pentry->key, &key, sizeof(key)) == 0) {
+#ifdef DEFENDER_CACHE_DEBUGGING
+    bestdef = get_defender_eval(attacker, ptile);
+    if (bestdef != pentry->bestdef) {
+      log_error("Defender cache: %s cached as best defender at (%d, %d), "
+                "actually %s.",
+                pentry->bestdef != NULL
+                ? unit_rule_name(pentry->bestdef) : "nothing",
+                TILE_XY(ptile),
+                bestdef != NULL ? unit_rule_name(bestdef) : "nothing");
+    }
+#endif /* DEFENDER_CACHE_DEBUGGING */
+    return pentry->bestdef;
+  }
+
+  bestdef = get_defender_eval(attacker, ptile);
+
+  pentry->stamp = stamp;
+  pentry->stack_size = stack_size;
+  pentry->stack_hash = stack_hash;
+  pentry->key = key;
+  pentry->bestdef = bestdef;
 
   return bestdef;
 }
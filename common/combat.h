@@ -47,7 +47,18 @@ enum unit_attack_result unit_attack_units_at_tile_result(const struct unit *puni
 bool can_unit_attack_tile(const struct unit *punit,
 			  const struct tile *ptile);
 
+/* One fight, as seen by win_chance(). */
+struct combat_odds {
+  int att_strength, att_hp, att_fp;
+  int def_strength, def_hp, def_fp;
+};
+
 double win_chance(int as, int ahp, int afp, int ds, int dhp, int dfp);
+void win_chance_batch(const struct combat_odds *fights, int count,
+                      double *chances);
+void get_combat_odds(const struct unit *attacker,
+                     const struct unit *defender,
+                     struct combat_odds *fight);
 
 void get_modified_firepower(const struct unit *attacker,
 			    const struct unit *defender,
@@ -77,6 +88,8 @@ int get_total_attack_power(const struct unit *attacker,
 
 struct unit *get_defender(const struct unit *attacker,
 			  const struct tile *ptile);
+void combat_cache_free(void);
+
 struct unit *get_attacker(const struct unit *defender,
 			  const struct tile *ptile);
 
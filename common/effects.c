@@ -35,6 +35,7 @@
 #include "packets.h"
 #include "player.h"
 #include "tech.h"
+#include "unittype.h"
 
 #include "effects.h"
 
@@ -121,6 +122,68 @@ static struct {
   } reqs;
 } ruleset_cache;
 
+/**************************************************************************
+  Effect value cache. On the server the results of
+  get_target_bonus_effects() are remembered in a direct mapped table,
+  keyed on the effect type, the targets and the few properties of the
+  targets that requirements read directly (government, AI level, city
+  size and radius).
+
+  Every entry is stamped with the sum of the generation counters of the
+  effect_cache_dep classes its effect type depends on, so bumping one
+  counter invalidates all entries that might have been affected by the
+  change without touching the table. Effect types with requirements on
+  state that is not tracked (diplomatic states, unit state, calendar...)
+  are never cached. Player and city creation and removal flush the
+  whole cache, as they can change almost anything.
+**************************************************************************/
+#undef EFFECT_CACHE_DEBUGGING
+
+#define EFFECT_CACHE_SIZE (1 << 14)
+#define ECD_UNCACHEABLE (1 << ECD_COUNT)
+#define ECD_OBSOLETE_DEPTH 4
+
+struct effect_cache_key {
+  const struct player *target_player;
+  const struct player *other_player;
+  const struct city *target_city;
+  const struct impr_type *target_building;
+  const struct tile *target_tile;
+  const struct unit *target_unit;
+  const struct unit_type *target_unittype;
+  const struct output_type *target_output;
+  const struct specialist *target_specialist;
+  const struct action *target_action;
+  const struct government *gov;
+  int ai_level;
+  int city_size;
+  int city_radius_sq;
+  enum effect_type type;
+};
+
+struct effect_cache_entry {
+  unsigned int stamp; /* 0 for unused entries */
+  int value;
+  struct effect_cache_key key;
+};
+
+static struct {
+  struct effect_cache_entry *table;
+
+  /* ECD_* bits for each effect type. Computed when first needed. */
+  bool classified;
+  int deps[EFT_COUNT];
+
+  unsigned int flush_gen;
+  unsigned int gen[ECD_COUNT];
+
+  /* When frozen, lookups neither store results nor count them, so that
+   * they can be made from several threads at once. */
+  bool frozen;
+
+  struct effect_cache_stats stats;
+} effect_cache = { .flush_gen = 1 };
+
 
 /**********************************************************************//**
   Get a list of effects of this type.
@@ -180,6 +243,8 @@ struct effect *effect_new(enum effect_type type, int value,
   peffect->multiplier = pmul;
 
   requirement_vector_init(&peffect->reqs);
+  req_program_init(&peffect->reqs_prog);
+  effect_cache.classified = FALSE;
 
   /* Now add the effect to the ruleset cache. */
   effect_list_append(ruleset_cache.tracker, peffect);
@@ -211,6 +276,8 @@ void effect_req_append(struct effect *peffect, struct requirement req)
   struct effect_list *eff_list = get_req_source_effects(&req.source);
 
   requirement_vector_append(&peffect->reqs, req);
+  req_program_free(&peffect->reqs_prog);
+  effect_cache.classified = FALSE;
 
   if (eff_list) {
     effect_list_append(eff_list, peffect);
@@ -242,6 +309,13 @@ void ruleset_cache_init(void)
   for (i = 0; i < ARRAY_SIZE(ruleset_cache.reqs.advances); i++) {
     ruleset_cache.reqs.advances[i] = effect_list_new();
   }
+
+  if (is_server()) {
+    effect_cache.table = fc_calloc(EFFECT_CACHE_SIZE,
+                                   sizeof(*effect_cache.table));
+  }
+  effect_cache.classified = FALSE;
+  effect_cache_flush();
 }
 
 /**********************************************************************//**
@@ -256,6 +330,7 @@ void ruleset_cache_free(void)
   if (tracker_list) {
     effect_list_iterate(tracker_list, peffect) {
       requirement_vector_free(&peffect->reqs);
+      req_program_free(&peffect->reqs_prog);
       free(peffect);
     } effect_list_iterate_end;
     effect_list_destroy(tracker_list);
@@ -298,6 +373,11 @@ void ruleset_cache_free(void)
     }
   }
 
+  if (effect_cache.table != NULL) {
+    free(effect_cache.table);
+    effect_cache.table = NULL;
+  }
+
   initialized = FALSE;
 }
 
@@ -587,40 +667,299 @@ bool is_building_replaced(const struct city *pcity,
 }
 
 /**********************************************************************//**
-  Returns the effect bonus of a given type for any target.
+  Mark state of the given class as changed, invalidating the cached
+  values that may depend on it.
+**************************************************************************/
+void effect_cache_changed(enum effect_cache_dep dep)
+{
+  fc_assert_ret(dep >= 0 && dep < ECD_COUNT);
 
-  target gives the type of the target
-  (player,city,building,tile) give the exact target
-  effect_type gives the effect type to be considered
+  effect_cache.gen[dep]++;
+  effect_cache.stats.invalidations++;
+}
 
-  Returns the effect sources of this type _currently active_.
+/**********************************************************************//**
+  Is the tile part of the real map, rather than a virtual copy?
+**************************************************************************/
+static bool effect_cache_tile_is_real(const struct tile *ptile)
+{
+  return (wld.map.tiles != NULL
+          && 0 <= ptile->index && ptile->index < MAP_INDEX_SIZE
+          && ptile == wld.map.tiles + ptile->index);
+}
 
-  The returned vector must be freed (building_vector_free) when the caller
-  is done with it.
+/**********************************************************************//**
+  Terrain, extras, owner or continent of the tile changed. Changes to
+  virtual tiles don't affect the cache.
 **************************************************************************/
-int get_target_bonus_effects(struct effect_list *plist,
-                             const struct player *target_player,
-                             const struct player *other_player,
-                             const struct city *target_city,
-                             const struct impr_type *target_building,
-                             const struct tile *target_tile,
-                             const struct unit *target_unit,
-                             const struct unit_type *target_unittype,
-                             const struct output_type *target_output,
-                             const struct specialist *target_specialist,
-                             const struct action *target_action,
-                             enum effect_type effect_type)
+void effect_cache_tile_changed(const struct tile *ptile)
+{
+  if (effect_cache_tile_is_real(ptile)) {
+    effect_cache_changed(ECD_TILE);
+  }
+}
+
+/**********************************************************************//**
+  Invalidate every cached value.
+**************************************************************************/
+void effect_cache_flush(void)
+{
+  effect_cache.flush_gen++;
+  effect_cache.stats.invalidations++;
+}
+
+/**********************************************************************//**
+  While the cache is frozen, lookups don't modify it. Game state must not
+  change while frozen.
+**************************************************************************/
+void effect_cache_freeze(bool frozen)
+{
+  effect_cache.frozen = frozen;
+}
+
+/**********************************************************************//**
+  Is the cache frozen? See effect_cache_freeze().
+**************************************************************************/
+bool effect_cache_is_frozen(void)
+{
+  return effect_cache.frozen;
+}
+
+/**********************************************************************//**
+  Return the cache hit and miss counters.
+**************************************************************************/
+const struct effect_cache_stats *effect_cache_stats_get(void)
+{
+  return &effect_cache.stats;
+}
+
+/**********************************************************************//**
+  Reset the cache hit and miss counters.
+**************************************************************************/
+void effect_cache_stats_reset(void)
+{
+  memset(&effect_cache.stats, 0, sizeof(effect_cache.stats));
+}
+
+/**********************************************************************//**
+  Return the ECD_* bits of the state the requirement depends on, or
+  ECD_UNCACHEABLE if it reads something the cache does not track.
+**************************************************************************/
+static int effect_cache_req_deps(const struct requirement *preq, int depth)
+{
+  int deps = 0;
+
+  switch (preq->range) {
+  case REQ_RANGE_TRADEROUTE:
+  case REQ_RANGE_ALLIANCE:
+    /* Trade routes and diplomatic states are not tracked. */
+    return ECD_UNCACHEABLE;
+  case REQ_RANGE_CONTINENT:
+    deps |= 1 << ECD_TILE;
+    break;
+  default:
+    break;
+  }
+
+  switch (preq->source.kind) {
+  case VUT_NONE:
+  case VUT_GOVERNMENT:
+  case VUT_NATION:
+  case VUT_NATIONGROUP:
+  case VUT_STYLE:
+  case VUT_AI_LEVEL:
+  case VUT_UTYPE:
+  case VUT_UTFLAG:
+  case VUT_UCLASS:
+  case VUT_UCFLAG:
+  case VUT_OTYPE:
+  case VUT_SPECIALIST:
+  case VUT_MINSIZE:
+  case VUT_TOPO:
+  case VUT_IMPR_GENUS:
+  case VUT_ACTION:
+    /* Fixed for the game, or part of the key. */
+    break;
+  case VUT_ADVANCE:
+  case VUT_TECHFLAG:
+    deps |= 1 << ECD_TECH;
+    break;
+  case VUT_IMPROVEMENT:
+    deps |= 1 << ECD_BUILDING;
+    if (depth >= ECD_OBSOLETE_DEPTH) {
+      return ECD_UNCACHEABLE;
+    }
+    requirement_vector_iterate(&preq->source.value.building->obsolete_by,
+                               pobs) {
+      deps |= effect_cache_req_deps(pobs, depth + 1);
+    } requirement_vector_iterate_end;
+    break;
+  case VUT_TERRAIN:
+  case VUT_TERRAINCLASS:
+  case VUT_TERRFLAG:
+  case VUT_TERRAINALTER:
+  case VUT_EXTRA:
+  case VUT_EXTRAFLAG:
+  case VUT_BASEFLAG:
+  case VUT_ROADFLAG:
+  case VUT_CITYTILE:
+    deps |= 1 << ECD_TILE;
+    break;
+  default:
+    return ECD_UNCACHEABLE;
+  }
+
+  return deps;
+}
+
+/**********************************************************************//**
+  Work out which state the value of each effect type depends on.
+**************************************************************************/
+static void effect_cache_classify(void)
+{
+  enum effect_type type;
+
+  for (type = 0; type < EFT_COUNT; type++) {
+    int deps = 0;
+
+    effect_list_iterate(get_effects(type), peffect) {
+      if (peffect->multiplier != NULL) {
+        /* Multiplier values are not tracked */
+        deps |= ECD_UNCACHEABLE;
+      }
+      requirement_vector_iterate(&peffect->reqs, preq) {
+        deps |= effect_cache_req_deps(preq, 0);
+      } requirement_vector_iterate_end;
+    } effect_list_iterate_end;
+
+    effect_cache.deps[type] = deps;
+  }
+
+  effect_cache.classified = TRUE;
+}
+
+/**********************************************************************//**
+  Return a stamp that changes whenever the cached values of the effect
+  type may change, for callers that remember results computed from them.
+  Returns 0 if values of the type can't be remembered. While the cache
+  is frozen the stamp stays valid, but callers must not store anything
+  either.
+**************************************************************************/
+unsigned int effect_cache_stamp(enum effect_type type)
+{
+  unsigned int stamp;
+  int deps, dep;
+
+  if (effect_cache.table == NULL) {
+    return 0;
+  }
+
+  if (!effect_cache.classified) {
+    if (effect_cache.frozen) {
+      return 0;
+    }
+    effect_cache_classify();
+  }
+
+  deps = effect_cache.deps[type];
+  if (deps & ECD_UNCACHEABLE) {
+    return 0;
+  }
+
+  stamp = effect_cache.flush_gen;
+  for (dep = 0; dep < ECD_COUNT; dep++) {
+    if (deps & (1 << dep)) {
+      stamp += effect_cache.gen[dep];
+    }
+  }
+
+  return stamp;
+}
+
+/**********************************************************************//**
+  Return the generation counter of the class of state. It changes
+  whenever effect_cache_changed() is called for the class.
+**************************************************************************/
+unsigned int effect_cache_generation(enum effect_cache_dep dep)
+{
+  fc_assert_ret_val(dep >= 0 && dep < ECD_COUNT, 0);
+
+  return effect_cache.gen[dep];
+}
+
+/**********************************************************************//**
+  Return a stamp that changes whenever the terrain, extras, owner or
+  continent of any tile may have changed, for callers that remember
+  results computed from the whole map. Returns 0 if such changes are
+  not tracked.
+**************************************************************************/
+unsigned int effect_cache_map_stamp(void)
+{
+  if (effect_cache.table == NULL) {
+    return 0;
+  }
+
+  return effect_cache.flush_gen + effect_cache.gen[ECD_TILE];
+}
+
+/**********************************************************************//**
+  Table slot for the key.
+**************************************************************************/
+static struct effect_cache_entry *
+effect_cache_slot(const struct effect_cache_key *key)
+{
+  uintptr_t h = key->type;
+
+#define EC_MIX(_v) h = (h ^ (uintptr_t) (_v)) * 0x9E3779B1u
+  EC_MIX(key->target_player);
+  EC_MIX(key->other_player);
+  EC_MIX(key->target_city);
+  EC_MIX(key->target_building);
+  EC_MIX(key->target_tile);
+  EC_MIX(key->target_unit);
+  EC_MIX(key->target_unittype);
+  EC_MIX(key->target_output);
+  EC_MIX(key->target_specialist);
+  EC_MIX(key->target_action);
+  EC_MIX(key->gov);
+  EC_MIX(key->ai_level);
+  EC_MIX(key->city_size);
+  EC_MIX(key->city_radius_sq);
+#undef EC_MIX
+
+  h ^= (h >> 15) ^ (h >> 29);
+
+  return &effect_cache.table[h & (EFFECT_CACHE_SIZE - 1)];
+}
+
+/**********************************************************************//**
+  Sum of the effects of the type active for the targets, without going
+  through the cache. See get_target_bonus_effects().
+**************************************************************************/
+static int target_bonus_effects_eval(struct effect_list *plist,
+                                     const struct player *target_player,
+                                     const struct player *other_player,
+                                     const struct city *target_city,
+                                     const struct impr_type *target_building,
+                                     const struct tile *target_tile,
+                                     const struct unit *target_unit,
+                                     const struct unit_type *target_unittype,
+                                     const struct output_type *target_output,
+                                     const struct specialist *target_specialist,
+                                     const struct action *target_action,
+                                     enum effect_type effect_type)
 {
   int bonus = 0;
 
   /* Loop over all effects of this type. */
   effect_list_iterate(get_effects(effect_type), peffect) {
     /* For each effect, see if it is active. */
-    if (are_reqs_active(target_player, other_player, target_city,
-                        target_building, target_tile,
-                        target_unit, target_unittype,
-                        target_output, target_specialist, target_action,
-			&peffect->reqs, RPT_CERTAIN)) {
+    if (are_reqs_active_prog(target_player, other_player, target_city,
+                             target_building, target_tile,
+                             target_unit, target_unittype,
+                             target_output, target_specialist,
+                             target_action, &peffect->reqs,
+                             &peffect->reqs_prog, RPT_CERTAIN)) {
       /* This code will add value of effect. If there's multiplier for 
        * effect and target_player aren't null, then value is multiplied
        * by player's multiplier factor. */
@@ -643,6 +982,138 @@ int get_target_bonus_effects(struct effect_list *plist,
   return bonus;
 }
 
+/**********************************************************************//**
+  Returns the effect bonus of a given type for any target.
+
+  target gives the type of the target
+  (player,city,building,tile) give the exact target
+  effect_type gives the effect type to be considered
+
+  Returns the effect sources of this type _currently active_.
+
+  The returned vector must be freed (building_vector_free) when the caller
+  is done with it.
+**************************************************************************/
+int get_target_bonus_effects(struct effect_list *plist,
+                             const struct player *target_player,
+                             const struct player *other_player,
+                             const struct city *target_city,
+                             const struct impr_type *target_building,
+                             const struct tile *target_tile,
+                             const struct unit *target_unit,
+                             const struct unit_type *target_unittype,
+                             const struct output_type *target_output,
+                             const struct specialist *target_specialist,
+                             const struct action *target_action,
+                             enum effect_type effect_type)
+{
+  struct effect_cache_key key;
+  struct effect_cache_entry *pentry;
+  unsigned int stamp;
+  int deps, dep, bonus;
+
+  if (effect_cache.table == NULL || plist != NULL) {
+    return target_bonus_effects_eval(plist, target_player, other_player,
+                                     target_city, target_building,
+                                     target_tile, target_unit,
+                                     target_unittype, target_output,
+                                     target_specialist, target_action,
+                                     effect_type);
+  }
+
+  if (!effect_cache.classified && !effect_cache.frozen) {
+    effect_cache_classify();
+  }
+
+  deps = effect_cache.deps[effect_type];
+  if (!effect_cache.classified
+      || (deps & ECD_UNCACHEABLE)
+      || (target_tile != NULL && !effect_cache_tile_is_real(target_tile))
+      || city_is_virtual(target_city)) {
+    if (!effect_cache.frozen) {
+      effect_cache.stats.bypassed++;
+    }
+    return target_bonus_effects_eval(NULL, target_player, other_player,
+                                     target_city, target_building,
+                                     target_tile, target_unit,
+                                     target_unittype, target_output,
+                                     target_specialist, target_action,
+                                     effect_type);
+  }
+
+  /* Same normalization as is_req_active() does. */
+  if (target_unittype == NULL && target_unit != NULL) {
+    target_unittype = unit_type_get(target_unit);
+  }
+
+  /* Zero the padding too, keys are compared with memcmp(). */
+  memset(&key, 0, sizeof(key));
+  key.target_player = target_player;
+  key.other_player = other_player;
+  key.target_city = target_city;
+  key.target_building = target_building;
+  key.target_tile = target_tile;
+  key.target_unit = target_unit;
+  key.target_unittype = target_unittype;
+  key.target_output = target_output;
+  key.target_specialist = target_specialist;
+  key.target_action = target_action;
+  if (target_player != NULL) {
+    key.gov = target_player->government;
+    key.ai_level = is_ai(target_player)
+                   ? target_player->ai_common.skill_level : -1;
+  }
+  if (target_city != NULL) {
+    key.city_size = city_size_get(target_city);
+    key.city_radius_sq = city_map_radius_sq_get(target_city);
+  }
+  key.type = effect_type;
+
+  stamp = effect_cache.flush_gen;
+  for (dep = 0; dep < ECD_COUNT; dep++) {
+    if (deps & (1 << dep)) {
+      stamp += effect_cache.gen[dep];
+    }
+  }
+
+  pentry = effect_cache_slot(&key);
+  if (pentry->stamp == stamp
+      && memcmp(&pentry->key, &key, sizeof(key)) == 0) {
+#ifdef EFFECT_CACHE_DEBUGGING
+    bonus = target_bonus_effects_eval(NULL, target_player, other_player,
+                                      target_city, target_building,
+                                      target_tile, target_unit,
+                                      target_unittype, target_output,
+                                      target_specialist, target_action,
+                                      effect_type);
+    if (bonus != pentry->value) {
+      log_error("Effect cache: %s cached as %d, actually %d.",
+                effect_type_name(effect_type), pentry->value, bonus);
+    }
+#endif /* EFFECT_CACHE_DEBUGGING */
+    if (!effect_cache.frozen) {
+      effect_cache.stats.hits++;
+    }
+    return pentry->value;
+  }
+
+  bonus = target_bonus_effects_eval(NULL, target_player, other_player,
+                                    target_city, target_building,
+                                    target_tile, target_unit,
+                                    target_unittype, target_output,
+                                    target_specialist, target_action,
+                                    effect_type);
+
+  if (!effect_cache.frozen) {
+    effect_cache.stats.misses++;
+    pentry->stamp = stamp;
+    pentry->value = bonus;
+    pentry->key = key;
+  }
+
+  return bonus;
+}
+
 /**********************************************************************//**
   Returns the effect bonus for the whole world.
 **************************************************************************/
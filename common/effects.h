@@ -317,6 +317,7 @@ struct effect {
   /* An effect can have multiple requirements.  The effect will only be
    * active if all of these requirement are met. */
   struct requirement_vector reqs;
+  struct req_program reqs_prog;         /* Compiled form of reqs */
 };
 
 /* An effect_list is a list of effects. */
@@ -346,6 +347,34 @@ void ruleset_cache_free(void);
 void recv_ruleset_effect(const struct packet_ruleset_effect *packet);
 void send_ruleset_cache(struct conn_list *dest);
 
+/* Server side cache of get_target_bonus_effects() results. The classes
+ * are the kinds of game state a cached value may depend on; whoever
+ * changes such state must call effect_cache_changed() for its class. */
+enum effect_cache_dep {
+  ECD_TECH,      /* Known techs of any research */
+  ECD_BUILDING,  /* Buildings present in any city, wonder ownership */
+  ECD_TILE,      /* Terrain, extras, owner or continent of any tile */
+  ECD_COUNT
+};
+
+struct effect_cache_stats {
+  unsigned long hits;
+  unsigned long misses;
+  unsigned long bypassed;       /* Queries the cache can't answer */
+  unsigned long invalidations;
+};
+
+void effect_cache_changed(enum effect_cache_dep dep);
+void effect_cache_tile_changed(const struct tile *ptile);
+void effect_cache_flush(void);
+void effect_cache_freeze(bool frozen);
+bool effect_cache_is_frozen(void);
+unsigned int effect_cache_stamp(enum effect_type type);
+unsigned int effect_cache_generation(enum effect_cache_dep dep);
+unsigned int effect_cache_map_stamp(void);
+const struct effect_cache_stats *effect_cache_stats_get(void);
+void effect_cache_stats_reset(void);
+
 int effect_cumulative_max(enum effect_type type, struct universal *for_uni);
 int effect_cumulative_min(enum effect_type type, struct universal *for_uni);
 
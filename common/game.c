@@ -25,12 +25,14 @@
 
 /* aicore */
 #include "cm.h"
+#include "path_finding.h"
 
 /* common */
 #include "ai.h"
 #include "achievements.h"
 #include "actions.h"
 #include "city.h"
+#include "combat.h"
 #include "connection.h"
 #include "disaster.h"
 #include "extras.h"
@@ -417,6 +419,7 @@ static void game_defaults(bool keep_ruleset_value)
     game.server.savepalace        = GAME_DEFAULT_SAVEPALACE;
     game.server.scorelog          = GAME_DEFAULT_SCORELOG;
     game.server.scoreloglevel     = GAME_DEFAULT_SCORELOGLEVEL;
+    game.server.scorelogformat    = GAME_DEFAULT_SCORELOGFORMAT;
     game.server.scoreturn         = GAME_DEFAULT_SCORETURN - 1;
     game.server.seed              = GAME_DEFAULT_SEED;
     sz_strlcpy(game.server.start_units, GAME_DEFAULT_START_UNITS);
@@ -433,6 +436,7 @@ static void game_defaults(bool keep_ruleset_value)
     game.server.timeoutint        = GAME_DEFAULT_TIMEOUTINT;
     game.server.timeoutintinc     = GAME_DEFAULT_TIMEOUTINTINC;
     game.server.turnblock         = GAME_DEFAULT_TURNBLOCK;
+    game.server.turn_threads      = GAME_DEFAULT_TURN_THREADS;
     game.server.unitwaittime      = GAME_DEFAULT_UNITWAITTIME;
     game.server.plr_colors        = NULL;
   } else {
@@ -454,6 +458,7 @@ void game_init(bool keep_ruleset_value)
   game_ruleset_init();
   idex_init(&wld);
   cm_init();
+  pf_workspaces_init();
   researches_init();
   universal_found_functions_init();
 }
@@ -485,6 +490,9 @@ void game_free(void)
   game_ruleset_free();
   researches_free();
   cm_free();
+  pf_workspaces_free();
+  combat_cache_free();
+  city_tile_output_cache_free();
 }
 
 /**********************************************************************//**
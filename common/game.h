@@ -68,6 +68,11 @@ enum scorelog_level {
   SL_HUMANS
 };
 
+enum scorelog_format {
+  SLF_TEXT = 0,
+  SLF_BINARY
+};
+
 struct user_flag
 {
   char *name;
@@ -175,6 +180,7 @@ struct civ_game {
       int revolution_length;
       int spaceship_travel_time;
       bool threaded_save;
+      int turn_threads;
       int save_compress_level;
       enum fz_method save_compress_type;
       int save_nturns;
@@ -217,6 +223,7 @@ struct civ_game {
       char save_name[MAX_LEN_NAME];
       bool scorelog;
       enum scorelog_level scoreloglevel;
+      enum scorelog_format scorelogformat;
       char scorefile[MAX_LEN_NAME];
       int scoreturn;    /* next make_history_report() */
       int seed_setting;
@@ -542,6 +549,7 @@ extern struct world wld;
 
 #define GAME_DEFAULT_SCORELOG        FALSE
 #define GAME_DEFAULT_SCORELOGLEVEL   SL_ALL
+#define GAME_DEFAULT_SCORELOGFORMAT  SLF_TEXT
 #define GAME_DEFAULT_SCOREFILE       "freeciv-score.log"
 
 /* Turns between reports is random between SCORETURN and (2 x SCORETURN).
@@ -658,6 +666,10 @@ extern struct world wld;
 
 #define GAME_DEFAULT_THREADED_SAVE   FALSE
 
+#define GAME_DEFAULT_TURN_THREADS    1
+#define GAME_MIN_TURN_THREADS        1
+#define GAME_MAX_TURN_THREADS        64
+
 #define GAME_DEFAULT_USER_META_MESSAGE ""
 
 #define GAME_DEFAULT_SKILL_LEVEL     AI_LEVEL_EASY
@@ -977,6 +977,46 @@ static char *stats_%(name)s_names[] = {%(names)s};
             extro="}\n"
             return intro+body+extro
 
+    # Returns a code fragment which is the implementation of the equal
+    # function, comparing all non-key fields of two delta states, and
+    # the delta ops used to share the encoding of a broadcast between
+    # connections with the same delta state.
+    def get_delta_ops(self):
+        if self.other_fields:
+            body='''  const struct %(packet_name)s *old = (const struct %(packet_name)s *) vold1;
+  const struct %(packet_name)s *real_packet = (const struct %(packet_name)s *) vold2;
+  bool differ;
+
+'''%self.__dict__
+            for field in self.other_fields:
+                body=body+field.get_cmp()+'''
+  if (differ) {
+    return FALSE;
+  }
+'''
+            body=body+"\n"
+        else:
+            body=""
+        if self.cancel:
+            cancel="static const enum packet_type cancel_%s[] = {%s};\n\n" \
+                %(self.name,", ".join(self.cancel))
+            cancel_ref="cancel_%s"%self.name
+        else:
+            cancel=""
+            cancel_ref="NULL"
+        return '''static bool equal_%(name)s(const void *vold1, const void *vold2)
+{
+%(body)s  return TRUE;
+}
+
+%(cancel)sstatic const struct packet_delta_ops delta_ops_%(name)s = {
+  sizeof(struct %(packet_name)s), hash_%(name)s, cmp_%(name)s,
+  equal_%(name)s, %(ncancel)d, %(cancel_ref)s
+};
+
+'''%self.get_dict({"body":body,"cancel":cancel,"cancel_ref":cancel_ref,
+                   "ncancel":len(self.cancel)})
+
     # Returns a code fragment which is the implementation of the send
     # function. This is one of the two real functions. So it is rather
     # complex to create.
@@ -1497,20 +1537,99 @@ class Packet:
                 result=result+v.get_hash()
                 result=result+v.get_cmp()
                 result=result+v.get_bitvector()
+                if self.want_delta_lsend():
+                    result=result+v.get_delta_ops()
                 result=result+"#endif /* FREECIV_DELTA_PROTOCOL */\n\n"
             result=result+v.get_receive()
             result=result+v.get_send()
+        if self.want_delta_lsend():
+            result=result+self.get_delta_ops_lookup()
         return result
 
+    # Whether the lsend function shares the delta encoding between
+    # connections with the same delta state.
+    def want_delta_lsend(self):
+        return self.want_lsend and self.delta and not self.want_pre_send \
+            and not self.want_post_send
+
+    # Returns a code fragment which is the function returning the delta
+    # ops of the variant a connection uses.
+    def get_delta_ops_lookup(self):
+        if self.want_force:
+            func="force_to_send"
+            cast="int(*)(struct connection *, const void *, bool)"
+        else:
+            func="packet"
+            cast="int(*)(struct connection *, const void *)"
+        body=""
+        for v in self.variants:
+            body=body+'''  if (pc->phs.handlers->send[%s].%s == (%s) send_%s) {
+    return &delta_ops_%s;
+  }
+'''%(self.type,func,cast,v.name,v.name)
+        return '''#ifdef FREECIV_DELTA_PROTOCOL
+static const struct packet_delta_ops *delta_ops_%s(const struct connection *pc)
+{
+%s
+  return NULL;
+}
+#endif /* FREECIV_DELTA_PROTOCOL */
+
+'''%(self.name,body)
+
     # Returns a code fragment which is the implementation of the
     # lsend function.
     def get_lsend(self):
         if not self.want_lsend: return ""
-        return '''%(lsend_prototype)s
+        if self.want_delta_lsend():
+            return '''%(lsend_prototype)s
 {
+#ifdef FREECIV_DELTA_PROTOCOL
+  struct packet_delta_broadcast bcast;
+
+  packet_delta_broadcast_init(&bcast, %(type)s, packet);
+  conn_list_iterate(dest, pconn) {
+    if (!packet_delta_broadcast_resend(&bcast, pconn,
+                                       delta_ops_%(name)s(pconn))) {
+      send_%(name)s(pconn%(extra_send_args2)s);
+      pconn->broadcast = NULL;
+    }
+  } conn_list_iterate_end;
+  packet_delta_broadcast_free(&bcast);
+#else  /* FREECIV_DELTA_PROTOCOL */
   conn_list_iterate(dest, pconn) {
     send_%(name)s(pconn%(extra_send_args2)s);
   } conn_list_iterate_end;
+#endif /* FREECIV_DELTA_PROTOCOL */
+}
+
+'''%self.__dict__
+        if self.delta or self.want_pre_send or self.want_post_send \
+           or self.cancel:
+            return '''%(lsend_prototype)s
+{
+  conn_list_iterate(dest, pconn) {
+    send_%(name)s(pconn%(extra_send_args2)s);
+  } conn_list_iterate_end;
+}
+
+'''%self.__dict__
+
+        # Without delta state and send hooks the encoding depends only
+        # on the variant and the header layout: encode once and share.
+        return '''%(lsend_prototype)s
+{
+  struct packet_broadcast bcast;
+
+  packet_broadcast_init(&bcast, %(type)s);
+  conn_list_iterate(dest, pconn) {
+    if (!packet_broadcast_resend(&bcast, pconn)) {
+      pconn->broadcast = &bcast;
+      send_%(name)s(pconn%(extra_send_args2)s);
+      pconn->broadcast = NULL;
+    }
+  } conn_list_iterate_end;
+  packet_broadcast_free(&bcast);
 }
 
 '''%self.__dict__
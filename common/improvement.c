@@ -54,6 +54,7 @@ void improvements_init(void)
 
     p->item_number = i;
     requirement_vector_init(&p->reqs);
+    req_program_init(&p->reqs_prog);
     requirement_vector_init(&p->obsolete_by);
     p->ruledit_disabled = FALSE;
   }
@@ -70,6 +71,7 @@ static void improvement_free(struct impr_type *p)
   }
 
   requirement_vector_free(&p->reqs);
+  req_program_free(&p->reqs_prog);
   requirement_vector_free(&p->obsolete_by);
 }
 
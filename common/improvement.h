@@ -72,6 +72,7 @@ struct impr_type {
   char graphic_str[MAX_LEN_NAME];	/* city icon of improv. */
   char graphic_alt[MAX_LEN_NAME];	/* city icon of improv. */
   struct requirement_vector reqs;
+  struct req_program reqs_prog;         /* Compiled form of reqs */
   struct requirement_vector obsolete_by;
   int build_cost;			/* Use wrappers to access this. */
   int upkeep;
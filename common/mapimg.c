@@ -15,8 +15,13 @@
 #include <fc_config.h>
 #endif
 
+#include <limits.h>
 #include <stdarg.h>
 
+#ifdef FREECIV_HAVE_LIBZ
+#include <zlib.h>
+#endif /* FREECIV_HAVE_LIBZ */
+
 #ifdef HAVE_MAPIMG_MAGICKWAND
   #include <wand/MagickWand.h>
 #endif /* HAVE_MAPIMG_MAGICKWAND */
@@ -30,6 +35,7 @@
 #include "mem.h"
 #include "string_vector.h"
 #include "timing.h"
+#include "workerpool.h"
 
 /* common */
 #include "calendar.h"
@@ -265,6 +271,8 @@ BV_DEFINE(bv_mapdef_arg, MAPDEF_COUNT);
 #define SPECENUM_VALUE0NAME "ppm"
 #define SPECENUM_VALUE1     IMGTOOL_MAGICKWAND
 #define SPECENUM_VALUE1NAME "magick"
+#define SPECENUM_VALUE2     IMGTOOL_PNG
+#define SPECENUM_VALUE2NAME "png"
 #include "specenum_gen.h"
 
 /* player definitions */
@@ -361,6 +369,10 @@ struct mapdef;
 #define IMG_LINE_HEIGHT 5
 #define IMG_TEXT_HEIGHT 12
 
+/* Number of map rows whose tiles are evaluated in one go before they are
+ * plotted into the image. */
+#define IMG_BAND_ROWS 32
+
 struct img {
   struct mapdef *def; /* map definition */
   int turn; /* save turn */
@@ -383,20 +395,43 @@ struct img {
     int x;
     int y;
   } imgsize; /* image size */
-  const struct rgbcolor **map;
+
+  /* The image is saved as palette indices; index 0 is the background.
+   * palette[i - 1] is the color of index i. */
+  const struct rgbcolor **palette;
+  int palette_size;
+  int palette_alloc;
+  int palette_last;
+  unsigned short *map;
+};
+
+/* Up to four layers are plotted for each tile: terrain, area or border,
+ * city or unit and the fog of war. */
+#define IMG_TILE_PLOTS 4
+
+struct img_tile {
+  int count;
+  struct {
+    const struct rgbcolor *pcolor;
+    bv_pixel pixel;
+  } plot[IMG_TILE_PLOTS];
 };
 
 static struct img *img_new(struct mapdef *mapdef, int topo, int xsize, int ysize);
 static void img_destroy(struct img *pimg);
+static unsigned short img_palette_index(struct img *pimg,
+                                        const struct rgbcolor *pcolor);
+static const struct rgbcolor *img_palette_color(const struct img *pimg,
+                                                unsigned short pindex);
 static inline void img_set_pixel(struct img *pimg, const int mindex,
-                                 const struct rgbcolor *pcolor);
+                                 unsigned short pindex);
 static inline int img_index(const int x, const int y,
                             const struct img *pimg);
 static const char *img_playerstr(const struct player *pplayer);
 static void img_plot(struct img *pimg, int x, int y,
                      const struct rgbcolor *pcolor, const bv_pixel pixel);
-static void img_plot_tile(struct img *pimg, const struct tile *ptile,
-                          const struct rgbcolor *pcolor, const bv_pixel pixel);
+static void img_plot_index(struct img *pimg, int x, int y,
+                           unsigned short pindex, const bv_pixel pixel);
 static bool img_save(const struct img *pimg, const char *mapimgfile,
                      const char *path);
 static bool img_save_ppm(const struct img *pimg, const char *mapimgfile);
@@ -404,8 +439,14 @@ static bool img_save_ppm(const struct img *pimg, const char *mapimgfile);
 static bool img_save_magickwand(const struct img *pimg,
                                 const char *mapimgfile);
 #endif /* HAVE_MAPIMG_MAGICKWAND */
+#ifdef FREECIV_HAVE_LIBZ
+static bool img_save_png(const struct img *pimg, const char *mapimgfile);
+#endif /* FREECIV_HAVE_LIBZ */
 static bool img_filename(const char *mapimgfile, enum imageformat format,
                          char *filename, size_t filename_len);
+static void img_tile_layers(const struct img *pimg, const struct tile *ptile,
+                            const struct player *pplayer, bool plr_knowledge,
+                            struct img_tile *ptiledata);
 static void img_createmap(struct img *pimg);
 
 /* == image toolkits == */
@@ -433,6 +474,11 @@ static struct toolkit img_toolkits[] = {
               img_save_magickwand,
               N_("ImageMagick"))
 #endif /* HAVE_MAPIMG_MAGICKWAND */
+#ifdef FREECIV_HAVE_LIBZ
+  GEN_TOOLKIT(IMGTOOL_PNG, IMGFORMAT_PNG, IMGFORMAT_PNG,
+              img_save_png,
+              N_("Standard png files"))
+#endif /* FREECIV_HAVE_LIBZ */
 };
 
 static const int img_toolkits_count = ARRAY_SIZE(img_toolkits);
@@ -486,6 +532,7 @@ static struct {
   mapimg_tile_player_func mapimg_tile_unit;
   mapimg_plrcolor_count_func mapimg_plrcolor_count;
   mapimg_plrcolor_get_func mapimg_plrcolor_get;
+  mapimg_workers_func mapimg_workers;
 } mapimg = { .init = FALSE };
 
 /*
@@ -497,7 +544,9 @@ static struct {
 /************************************************************************//**
   Initialisation of the map image subsystem. The arguments are used to
   determine the map knowledge, the terrain type as well as the tile, city and
-  unit owner.
+  unit owner. 'mapimg_workers' may be NULL; else it returns the worker pool
+  used to evaluate the tiles of an image. The other callbacks have to be
+  safe to call from its threads.
 ****************************************************************************/
 void mapimg_init(mapimg_tile_known_func mapimg_tile_known,
                  mapimg_tile_terrain_func mapimg_tile_terrain,
@@ -505,7 +554,8 @@ void mapimg_init(mapimg_tile_known_func mapimg_tile_known,
                  mapimg_tile_player_func mapimg_tile_city,
                  mapimg_tile_player_func mapimg_tile_unit,
                  mapimg_plrcolor_count_func mapimg_plrcolor_count,
-                 mapimg_plrcolor_get_func mapimg_plrcolor_get)
+                 mapimg_plrcolor_get_func mapimg_plrcolor_get,
+                 mapimg_workers_func mapimg_workers)
 {
   if (mapimg_initialised()) {
     return;
@@ -527,6 +577,7 @@ void mapimg_init(mapimg_tile_known_func mapimg_tile_known,
   mapimg.mapimg_plrcolor_count = mapimg_plrcolor_count;
   fc_assert_ret(mapimg_plrcolor_get != NULL);
   mapimg.mapimg_plrcolor_get = mapimg_plrcolor_get;
+  mapimg.mapimg_workers = mapimg_workers;
 
   mapimg.init = TRUE;
 }
@@ -1931,11 +1982,13 @@ static struct img *img_new(struct mapdef *mapdef, int topo, int xsize, int ysize
     pimg->base_coor = base_coor_rect;
   }
 
-  /* Here the map image is saved as an array of RGB color values. */
+  /* Here the map image is saved as an array of palette indices. */
+  pimg->palette = NULL;
+  pimg->palette_size = 0;
+  pimg->palette_alloc = 0;
+  pimg->palette_last = 0;
   pimg->map = fc_calloc(pimg->imgsize.x * pimg->imgsize.y,
                         sizeof(*pimg->map));
-  /* Initialise map. */
-  memset(pimg->map, 0, pimg->imgsize.x * pimg->imgsize.y);
 
   return pimg;
 }
@@ -1947,24 +2000,80 @@ static void img_destroy(struct img *pimg)
 {
   if (pimg != NULL) {
     /* do not free pimg->def */
+    free(pimg->palette);
     free(pimg->map);
     free(pimg);
   }
 }
 
+/************************************************************************//**
+  Return the palette index of the color, adding it to the palette if
+  needed. NULL (the background) is index 0.
+****************************************************************************/
+static unsigned short img_palette_index(struct img *pimg,
+                                        const struct rgbcolor *pcolor)
+{
+  int i;
+
+  if (pcolor == NULL) {
+    return 0;
+  }
+
+  /* Neighbouring tiles mostly use the same color. */
+  if (pimg->palette_last > 0
+      && pimg->palette[pimg->palette_last - 1] == pcolor) {
+    return pimg->palette_last;
+  }
+
+  for (i = 0; i < pimg->palette_size; i++) {
+    if (pimg->palette[i] == pcolor) {
+      pimg->palette_last = i + 1;
+      return pimg->palette_last;
+    }
+  }
+
+  MAPIMG_ASSERT_RET_VAL(pimg->palette_size < USHRT_MAX, 0);
+
+  if (pimg->palette_size == pimg->palette_alloc) {
+    pimg->palette_alloc = MAX(16, 2 * pimg->palette_alloc);
+    pimg->palette = fc_realloc(pimg->palette,
+                               pimg->palette_alloc * sizeof(*pimg->palette));
+  }
+  pimg->palette[pimg->palette_size++] = pcolor;
+  pimg->palette_last = pimg->palette_size;
+
+  return pimg->palette_last;
+}
+
+/************************************************************************//**
+  Return the color of a palette index.
+****************************************************************************/
+static const struct rgbcolor *img_palette_color(const struct img *pimg,
+                                                unsigned short pindex)
+{
+  if (pindex == 0) {
+    return imgcolor_special(IMGCOLOR_BACKGROUND);
+  }
+
+  fc_assert_ret_val(pindex <= pimg->palette_size,
+                    imgcolor_special(IMGCOLOR_ERROR));
+
+  return pimg->palette[pindex - 1];
+}
+
 /************************************************************************//**
   Set the color of one pixel.
 ****************************************************************************/
 static inline void img_set_pixel(struct img *pimg, const int mindex,
-                                 const struct rgbcolor *pcolor)
+                                 unsigned short pindex)
 {
-  if (mindex < 0 || mindex > pimg->imgsize.x * pimg->imgsize.y) {
+  if (mindex < 0 || mindex >= pimg->imgsize.x * pimg->imgsize.y) {
     log_error("invalid index: 0 <= %d < %d", mindex,
               pimg->imgsize.x * pimg->imgsize.y);
     return;
   }
 
-  pimg->map[mindex] = pcolor;
+  pimg->map[mindex] = pindex;
 }
 
 /************************************************************************//**
@@ -1986,36 +2095,32 @@ static inline int img_index(const int x, const int y,
 static void img_plot(struct img *pimg, int x, int y,
                      const struct rgbcolor *pcolor, const bv_pixel pixel)
 {
-  int base_x, base_y, i, mindex;
-
   if (!BV_ISSET_ANY(pixel)) {
     return;
   }
 
+  img_plot_index(pimg, x, y, img_palette_index(pimg, pcolor), pixel);
+}
+
+/************************************************************************//**
+  Plot one tile at (x,y) using the palette index 'pindex'.
+****************************************************************************/
+static void img_plot_index(struct img *pimg, int x, int y,
+                           unsigned short pindex, const bv_pixel pixel)
+{
+  int base_x, base_y, i, mindex;
+
   pimg->base_coor(pimg, &base_x, &base_y, x, y);
 
   for (i = 0; i < NUM_PIXEL; i++) {
     if (BV_ISSET(pixel, i)) {
       mindex = img_index(base_x + pimg->tileshape->x[i],
                          base_y + pimg->tileshape->y[i], pimg);
-      img_set_pixel(pimg, mindex, pcolor);
+      img_set_pixel(pimg, mindex, pindex);
     }
   }
 }
 
-/************************************************************************//**
-  Plot one tile. Only the pixel of the tile set within 'pixel' are ploted.
-****************************************************************************/
-static void img_plot_tile(struct img *pimg, const struct tile *ptile,
-                          const struct rgbcolor *pcolor, const bv_pixel pixel)
-{
-  int x, y;
-
-  index_to_map_pos(&x, &y, tile_index(ptile));
-
-  img_plot(pimg, x, y, pcolor, pixel);
-}
-
 /************************************************************************//**
   Save an image as ppm file.
 ****************************************************************************/
@@ -2232,9 +2337,9 @@ static bool img_save_magickwand(const struct img *pimg,
       /* x coordinate */
       for (x = 0; x < pimg->imgsize.x; x++) {
         mindex = img_index(x, y, pimg);
-        pcolor = pimg->map[mindex];
 
-        if (pcolor != NULL) {
+        if (pimg->map[mindex] != 0) {
+          pcolor = img_palette_color(pimg, pimg->map[mindex]);
           SET_COLOR(str_color, pcolor);
 
           /* zoom for x */
@@ -2287,8 +2392,9 @@ static bool img_save_magickwand(const struct img *pimg,
 static bool img_save_ppm(const struct img *pimg, const char *mapimgfile)
 {
   char ppmname[MAX_LEN_PATH];
+  char (*pixelstr)[16];
   FILE *fp;
-  int x, y, xxx, yyy, mindex;
+  int i, x, y, xxx, yyy, mindex;
   const struct rgbcolor *pcolor;
 
   if (pimg->def->format != IMGFORMAT_PPM) {
@@ -2331,6 +2437,14 @@ static bool img_save_ppm(const struct img *pimg, const char *mapimgfile)
           pimg->imgsize.y * pimg->def->zoom);
   fprintf(fp, "255\n");
 
+  /* Format each palette entry only once. */
+  pixelstr = fc_malloc((pimg->palette_size + 1) * sizeof(*pixelstr));
+  for (i = 0; i <= pimg->palette_size; i++) {
+    pcolor = img_palette_color(pimg, i);
+    fc_snprintf(pixelstr[i], sizeof(pixelstr[i]), "%d %d %d\n",
+                pcolor->r, pcolor->g, pcolor->b);
+  }
+
   /* y coordinate */
   for (y = 0; y < pimg->imgsize.y; y++) {
     /* zoom for y */
@@ -2338,25 +2452,251 @@ static bool img_save_ppm(const struct img *pimg, const char *mapimgfile)
       /* x coordinate */
       for (x = 0; x < pimg->imgsize.x; x++) {
         mindex = img_index(x, y, pimg);
-        pcolor = pimg->map[mindex];
 
         /* zoom for x */
         for (xxx = 0; xxx < pimg->def->zoom; xxx++) {
-          if (pcolor == NULL) {
-            pcolor = imgcolor_special(IMGCOLOR_BACKGROUND);
-          }
-          fprintf(fp, "%d %d %d\n", pcolor->r, pcolor->g, pcolor->b);
+          fputs(pixelstr[pimg->map[mindex]], fp);
         }
       }
     }
   }
 
+  free(pixelstr);
+
   log_verbose("Map image saved as '%s'.", ppmname);
   fclose(fp);
 
   return TRUE;
 }
 
+#ifdef FREECIV_HAVE_LIBZ
+/* Size of the buffer for the compressed data of one IDAT chunk. */
+#define PNG_CHUNK_SIZE 65536
+
+/************************************************************************//**
+  Write a 32 bit value in network byte order.
+****************************************************************************/
+static void png_put_uint32(unsigned char *buf, unsigned long val)
+{
+  buf[0] = (val >> 24) & 0xff;
+  buf[1] = (val >> 16) & 0xff;
+  buf[2] = (val >> 8) & 0xff;
+  buf[3] = val & 0xff;
+}
+
+/************************************************************************//**
+  Write one png chunk.
+****************************************************************************/
+static bool png_write_chunk(FILE *fp, const char *type,
+                            const unsigned char *data, size_t len)
+{
+  unsigned char buf[4];
+  uLong crc;
+
+  crc = crc32(0L, (const Bytef *) type, 4);
+  if (len > 0) {
+    crc = crc32(crc, data, len);
+  }
+
+  png_put_uint32(buf, len);
+  if (fwrite(buf, 1, 4, fp) != 4 || fwrite(type, 1, 4, fp) != 4
+      || (len > 0 && fwrite(data, 1, len, fp) != len)) {
+    return FALSE;
+  }
+  png_put_uint32(buf, crc);
+
+  return fwrite(buf, 1, 4, fp) == 4;
+}
+
+/************************************************************************//**
+  Feed one image row to the compressor and write the IDAT chunks filled by
+  it. With 'flush' set to Z_FINISH the remaining data is written.
+****************************************************************************/
+static bool png_deflate_row(FILE *fp, z_stream *zs, unsigned char *row,
+                            size_t len, unsigned char *out, int flush)
+{
+  int zret;
+
+  zs->next_in = row;
+  zs->avail_in = len;
+
+  do {
+    zret = deflate(zs, flush);
+    if (zret == Z_STREAM_ERROR) {
+      return FALSE;
+    }
+
+    if (zs->avail_out == 0
+        || (flush == Z_FINISH && zs->avail_out < PNG_CHUNK_SIZE)) {
+      if (!png_write_chunk(fp, "IDAT", out,
+                           PNG_CHUNK_SIZE - zs->avail_out)) {
+        return FALSE;
+      }
+      zs->next_out = out;
+      zs->avail_out = PNG_CHUNK_SIZE;
+    }
+  } while (zs->avail_in > 0 || (flush == Z_FINISH && zret != Z_STREAM_END));
+
+  return TRUE;
+}
+
+/************************************************************************//**
+  Save an image as png file (toolkit: png). The image is written with
+  zlib, one row at a time. Images with at most 256 colors are saved as
+  indexed images.
+****************************************************************************/
+static bool img_save_png(const struct img *pimg, const char *mapimgfile)
+{
+  static const unsigned char png_signature[8] = {
+    137, 'P', 'N', 'G', '\r', '\n', 26, '\n'
+  };
+  char pngname[MAX_LEN_PATH];
+  /* Keyword of the iTXt chunk followed by its separator, the compression
+   * flag and method and the empty language tag and translated keyword. */
+  static const char itxt_keyword[] = "Comment\0\0\0\0";
+  struct astring comment = ASTRING_INIT;
+  unsigned char header[13], plte[3 * 256];
+  unsigned char *row, *out, *itxt;
+  size_t itxt_len;
+  const struct rgbcolor *pcolor;
+  bool indexed = (pimg->palette_size < 256);
+  int width = pimg->imgsize.x * pimg->def->zoom;
+  int bpp = indexed ? 1 : 3;
+  int i, x, y, xxx, yyy, mindex, pos;
+  bool ret = TRUE;
+  z_stream zs;
+  FILE *fp;
+
+  if (pimg->def->format != IMGFORMAT_PNG) {
+    MAPIMG_LOG(_("the png toolkit can only create images in the png "
+                 "format"));
+    return FALSE;
+  }
+
+  if (!img_filename(mapimgfile, IMGFORMAT_PNG, pngname, sizeof(pngname))) {
+    MAPIMG_LOG(_("error generating the file name"));
+    return FALSE;
+  }
+
+  fp = fc_fopen(pngname, "wb");
+  if (!fp) {
+    MAPIMG_LOG(_("could not open file: %s"), pngname);
+    return FALSE;
+  }
+
+  memset(&zs, 0, sizeof(zs));
+  if (deflateInit(&zs, Z_DEFAULT_COMPRESSION) != Z_OK) {
+    MAPIMG_LOG(_("could not initialise zlib"));
+    fclose(fp);
+    return FALSE;
+  }
+
+  row = fc_malloc(1 + width * bpp);
+  out = fc_malloc(PNG_CHUNK_SIZE);
+  zs.next_out = out;
+  zs.avail_out = PNG_CHUNK_SIZE;
+
+  /* Header: size, 8 bit depth, indexed (3) or RGB (2) colors. */
+  png_put_uint32(header, width);
+  png_put_uint32(header + 4, pimg->imgsize.y * pimg->def->zoom);
+  header[8] = 8;
+  header[9] = indexed ? 3 : 2;
+  header[10] = 0;
+  header[11] = 0;
+  header[12] = 0;
+
+  /* Same comment as in the ppm files, saved as UTF-8 text. */
+  astr_add(&comment, "version:2");
+  astr_add_line(&comment, "map definition: %s", pimg->def->maparg);
+  if (pimg->def->colortest) {
+    astr_add_line(&comment, "color test");
+  } else if (BV_ISSET_ANY(pimg->def->player.checked_plrbv)) {
+    players_iterate(pplayer) {
+      if (BV_ISSET(pimg->def->player.checked_plrbv, player_index(pplayer))) {
+        astr_add_line(&comment, "%s", img_playerstr(pplayer));
+      }
+    } players_iterate_end;
+  } else {
+    astr_add_line(&comment, "no players");
+  }
+
+  ret = (fwrite(png_signature, 1, sizeof(png_signature), fp)
+         == sizeof(png_signature))
+        && png_write_chunk(fp, "IHDR", header, sizeof(header));
+
+  if (ret && indexed) {
+    for (i = 0; i <= pimg->palette_size; i++) {
+      pcolor = img_palette_color(pimg, i);
+      plte[3 * i] = pcolor->r;
+      plte[3 * i + 1] = pcolor->g;
+      plte[3 * i + 2] = pcolor->b;
+    }
+    ret = png_write_chunk(fp, "PLTE", plte, 3 * (pimg->palette_size + 1));
+  }
+
+  if (ret) {
+    itxt_len = sizeof(itxt_keyword) + astr_len(&comment);
+    itxt = fc_malloc(itxt_len);
+    memcpy(itxt, itxt_keyword, sizeof(itxt_keyword));
+    memcpy(itxt + sizeof(itxt_keyword), astr_str(&comment),
+           astr_len(&comment));
+    ret = png_write_chunk(fp, "iTXt", itxt, itxt_len);
+    free(itxt);
+  }
+
+  /* y coordinate */
+  for (y = 0; ret && y < pimg->imgsize.y; y++) {
+    /* Filter type 'None' */
+    row[0] = 0;
+    /* x coordinate */
+    for (x = 0; x < pimg->imgsize.x; x++) {
+      mindex = img_index(x, y, pimg);
+      pcolor = indexed ? NULL : img_palette_color(pimg, pimg->map[mindex]);
+
+      /* zoom for x */
+      for (xxx = 0; xxx < pimg->def->zoom; xxx++) {
+        pos = 1 + (x * pimg->def->zoom + xxx) * bpp;
+        if (indexed) {
+          row[pos] = pimg->map[mindex];
+        } else {
+          row[pos] = pcolor->r;
+          row[pos + 1] = pcolor->g;
+          row[pos + 2] = pcolor->b;
+        }
+      }
+    }
+
+    /* zoom for y */
+    for (yyy = 0; ret && yyy < pimg->def->zoom; yyy++) {
+      ret = png_deflate_row(fp, &zs, row, 1 + width * bpp, out, Z_NO_FLUSH);
+    }
+  }
+
+  if (ret) {
+    ret = png_deflate_row(fp, &zs, NULL, 0, out, Z_FINISH)
+          && png_write_chunk(fp, "IEND", NULL, 0);
+  }
+
+  deflateEnd(&zs);
+  astr_free(&comment);
+  free(out);
+  free(row);
+
+  if (fclose(fp) != 0) {
+    ret = FALSE;
+  }
+
+  if (ret) {
+    log_verbose("Map image saved as '%s'.", pngname);
+  } else {
+    MAPIMG_LOG(_("error saving map image '%s'"), pngname);
+  }
+
+  return ret;
+}
+#undef PNG_CHUNK_SIZE
+#endif /* FREECIV_HAVE_LIBZ */
+
 /************************************************************************//**
   Generate the final filename.
 ****************************************************************************/
@@ -2388,112 +2728,199 @@ static const char *img_playerstr(const struct player *pplayer)
 }
 
 /************************************************************************//**
-  Create the map considering the options (terrain, player(s), cities,
-  units, borders, known, fogofwar, ...).
+  Evaluate the layers of one tile considering the options (terrain,
+  player(s), cities, units, borders, known, fogofwar, ...). The colors and
+  pixels to plot are saved in 'ptiledata' in the order they have to be
+  plotted. This does not modify the image and can be called for several
+  tiles at once.
 ****************************************************************************/
-static void img_createmap(struct img *pimg)
+static void img_tile_layers(const struct img *pimg, const struct tile *ptile,
+                            const struct player *pplayer, bool plr_knowledge,
+                            struct img_tile *ptiledata)
 {
   const struct rgbcolor *pcolor;
   bv_pixel pixel;
   int player_id;
-  struct player *pplayer = NULL;
   struct player *plr_tile = NULL, *plr_city = NULL, *plr_unit = NULL;
   enum known_type tile_knowledge = TILE_UNKNOWN;
   struct terrain *pterrain = NULL;
-  bool plr_knowledge = pimg->def->layers[MAPIMG_LAYER_KNOWLEDGE];
 
-  whole_map_iterate(&(wld.map), ptile) {
-    if (bvplayers_count(pimg->def) == 1) {
-      /* only one player; get player id for 'known' and 'fogofwar' */
-      players_iterate(aplayer) {
-        if (BV_ISSET(pimg->def->player.checked_plrbv,
-                     player_index(aplayer))) {
-          pplayer = aplayer;
-          tile_knowledge = mapimg.mapimg_tile_known(ptile, pplayer,
-                                                    plr_knowledge);
-          break;
-        }
-      } players_iterate_end;
-    }
+#define IMG_TILE_ADD(_pcolor, _pixel)                                       \
+  if (BV_ISSET_ANY(_pixel)) {                                               \
+    ptiledata->plot[ptiledata->count].pcolor = (_pcolor);                   \
+    ptiledata->plot[ptiledata->count].pixel = (_pixel);                     \
+    ptiledata->count++;                                                     \
+  }
 
-    /* known tiles */
-    if (plr_knowledge && pplayer != NULL && tile_knowledge == TILE_UNKNOWN) {
-      /* plot nothing iff tile is not known */
-      continue;
-    }
+  ptiledata->count = 0;
 
-    /* terrain */
-    pterrain = mapimg.mapimg_tile_terrain(ptile, pplayer, plr_knowledge);
-    if (pimg->def->layers[MAPIMG_LAYER_TERRAIN]) {
-      /* full terrain */
-      pixel = pimg->pixel_tile(ptile, pplayer, plr_knowledge);
-      pcolor = imgcolor_terrain(pterrain);
-      img_plot_tile(pimg, ptile, pcolor, pixel);
-    } else {
-      /* basic terrain */
+  if (pplayer != NULL) {
+    /* only one player; get the knowledge for 'known' and 'fogofwar' */
+    tile_knowledge = mapimg.mapimg_tile_known(ptile, pplayer,
+                                              plr_knowledge);
+  }
+
+  /* known tiles */
+  if (plr_knowledge && pplayer != NULL && tile_knowledge == TILE_UNKNOWN) {
+    /* plot nothing iff tile is not known */
+    return;
+  }
+
+  /* terrain */
+  pterrain = mapimg.mapimg_tile_terrain(ptile, pplayer, plr_knowledge);
+  pixel = pimg->pixel_tile(ptile, pplayer, plr_knowledge);
+  if (pimg->def->layers[MAPIMG_LAYER_TERRAIN]) {
+    /* full terrain */
+    pcolor = imgcolor_terrain(pterrain);
+  } else if (is_ocean(pterrain)) {
+    /* basic terrain */
+    pcolor = imgcolor_special(IMGCOLOR_OCEAN);
+  } else {
+    pcolor = imgcolor_special(IMGCOLOR_GROUND);
+  }
+  IMG_TILE_ADD(pcolor, pixel);
+
+  /* (land) area within borders and borders */
+  plr_tile = mapimg.mapimg_tile_owner(ptile, pplayer, plr_knowledge);
+  if (game.info.borders > 0 && NULL != plr_tile) {
+    player_id = player_index(plr_tile);
+    if (pimg->def->layers[MAPIMG_LAYER_AREA] && !is_ocean(pterrain)
+        && BV_ISSET(pimg->def->player.checked_plrbv, player_id)) {
+      /* the tile is land and inside the players borders */
       pixel = pimg->pixel_tile(ptile, pplayer, plr_knowledge);
-      if (is_ocean(pterrain)) {
-        img_plot_tile(pimg, ptile, imgcolor_special(IMGCOLOR_OCEAN), pixel);
-      } else {
-        img_plot_tile(pimg, ptile, imgcolor_special(IMGCOLOR_GROUND), pixel);
-      }
+      pcolor = imgcolor_player(player_id);
+      IMG_TILE_ADD(pcolor, pixel);
+    } else if (pimg->def->layers[MAPIMG_LAYER_BORDERS]
+               && (BV_ISSET(pimg->def->player.checked_plrbv, player_id)
+                   || (plr_knowledge && pplayer != NULL))) {
+      /* plot borders if player is selected or view range of the one
+       * displayed player */
+      pixel = pimg->pixel_border(ptile, pplayer, plr_knowledge);
+      pcolor = imgcolor_player(player_id);
+      IMG_TILE_ADD(pcolor, pixel);
     }
+  }
 
-    /* (land) area within borders and borders */
-    plr_tile = mapimg.mapimg_tile_owner(ptile, pplayer, plr_knowledge);
-    if (game.info.borders > 0 && NULL != plr_tile) {
-      player_id = player_index(plr_tile);
-      if (pimg->def->layers[MAPIMG_LAYER_AREA] && !is_ocean(pterrain)
-          && BV_ISSET(pimg->def->player.checked_plrbv, player_id)) {
-        /* the tile is land and inside the players borders */
-        pixel = pimg->pixel_tile(ptile, pplayer, plr_knowledge);
-        pcolor = imgcolor_player(player_id);
-        img_plot_tile(pimg, ptile, pcolor, pixel);
-      } else if (pimg->def->layers[MAPIMG_LAYER_BORDERS]
-                 && (BV_ISSET(pimg->def->player.checked_plrbv, player_id)
-                     || (plr_knowledge && pplayer != NULL))) {
-        /* plot borders if player is selected or view range of the one
-         * displayed player */
-        pixel = pimg->pixel_border(ptile, pplayer, plr_knowledge);
-        pcolor = imgcolor_player(player_id);
-        img_plot_tile(pimg, ptile, pcolor, pixel);
-      }
+  /* cities and units */
+  plr_city = mapimg.mapimg_tile_city(ptile, pplayer, plr_knowledge);
+  plr_unit = mapimg.mapimg_tile_unit(ptile, pplayer, plr_knowledge);
+  if (pimg->def->layers[MAPIMG_LAYER_CITIES] && plr_city) {
+    player_id = player_index(plr_city);
+    if (BV_ISSET(pimg->def->player.checked_plrbv, player_id)
+        || (plr_knowledge && pplayer != NULL)) {
+      /* plot cities if player is selected or view range of the one
+       * displayed player */
+      pixel = pimg->pixel_city(ptile, pplayer, plr_knowledge);
+      pcolor = imgcolor_player(player_id);
+      IMG_TILE_ADD(pcolor, pixel);
     }
+  } else if (pimg->def->layers[MAPIMG_LAYER_UNITS] && plr_unit) {
+    player_id = player_index(plr_unit);
+    if (BV_ISSET(pimg->def->player.checked_plrbv, player_id)
+        || (plr_knowledge && pplayer != NULL)) {
+      /* plot units if player is selected or view range of the one
+       * displayed player */
+      pixel = pimg->pixel_unit(ptile, pplayer, plr_knowledge);
+      pcolor = imgcolor_player(player_id);
+      IMG_TILE_ADD(pcolor, pixel);
+    }
+  }
 
-    /* cities and units */
-    plr_city = mapimg.mapimg_tile_city(ptile, pplayer, plr_knowledge);
-    plr_unit = mapimg.mapimg_tile_unit(ptile, pplayer, plr_knowledge);
-    if (pimg->def->layers[MAPIMG_LAYER_CITIES] && plr_city) {
-      player_id = player_index(plr_city);
-      if (BV_ISSET(pimg->def->player.checked_plrbv, player_id)
-          || (plr_knowledge && pplayer != NULL)) {
-        /* plot cities if player is selected or view range of the one
-         * displayed player */
-        pixel = pimg->pixel_city(ptile, pplayer, plr_knowledge);
-        pcolor = imgcolor_player(player_id);
-        img_plot_tile(pimg, ptile, pcolor, pixel);
+  /* fogofwar; if only 1 player is plotted */
+  if (game.info.fogofwar && pimg->def->layers[MAPIMG_LAYER_FOGOFWAR]
+      && pplayer != NULL
+      && tile_knowledge == TILE_KNOWN_UNSEEN) {
+    pixel = pimg->pixel_fogofwar(ptile, pplayer, plr_knowledge);
+    IMG_TILE_ADD(NULL, pixel);
+  }
+
+#undef IMG_TILE_ADD
+}
+
+/* One band of map rows evaluated by img_createmap(). */
+struct img_band {
+  const struct img *pimg;
+  const struct player *pplayer;
+  bool plr_knowledge;
+  int first_row;
+  struct img_tile *tiles;
+};
+
+/************************************************************************//**
+  Evaluate the tiles of one map row of a band; worker pool job.
+****************************************************************************/
+static void img_band_row(int idx, void *data)
+{
+  struct img_band *band = data;
+  int nat_y = band->first_row + idx;
+  int nat_x;
+
+  for (nat_x = 0; nat_x < wld.map.xsize; nat_x++) {
+    img_tile_layers(band->pimg,
+                    native_pos_to_tile(&(wld.map), nat_x, nat_y),
+                    band->pplayer, band->plr_knowledge,
+                    &band->tiles[idx * wld.map.xsize + nat_x]);
+  }
+}
+
+/************************************************************************//**
+  Create the map considering the options (terrain, player(s), cities,
+  units, borders, known, fogofwar, ...).
+
+  The map is handled in bands of IMG_BAND_ROWS rows. The tiles of a band
+  are evaluated on the worker pool (see mapimg_init()) and then plotted in
+  map order, so the image does not depend on the number of threads.
+****************************************************************************/
+static void img_createmap(struct img *pimg)
+{
+  struct fc_worker_pool *workers = NULL;
+  struct img_band band;
+  int rows, i, j, x, y;
+
+  band.pimg = pimg;
+  band.pplayer = NULL;
+  band.plr_knowledge = pimg->def->layers[MAPIMG_LAYER_KNOWLEDGE];
+  band.tiles = fc_malloc(IMG_BAND_ROWS * wld.map.xsize
+                         * sizeof(*band.tiles));
+
+  if (bvplayers_count(pimg->def) == 1) {
+    /* only one player; get player for 'known' and 'fogofwar' */
+    players_iterate(aplayer) {
+      if (BV_ISSET(pimg->def->player.checked_plrbv,
+                   player_index(aplayer))) {
+        band.pplayer = aplayer;
+        break;
       }
-    } else if (pimg->def->layers[MAPIMG_LAYER_UNITS] && plr_unit) {
-      player_id = player_index(plr_unit);
-      if (BV_ISSET(pimg->def->player.checked_plrbv, player_id)
-          || (plr_knowledge && pplayer != NULL)) {
-        /* plot units if player is selected or view range of the one
-         * displayed player */
-        pixel = pimg->pixel_unit(ptile, pplayer, plr_knowledge);
-        pcolor = imgcolor_player(player_id);
-        img_plot_tile(pimg, ptile, pcolor, pixel);
+    } players_iterate_end;
+  }
+
+  if (mapimg.mapimg_workers != NULL) {
+    workers = mapimg.mapimg_workers();
+  }
+
+  for (band.first_row = 0; band.first_row < wld.map.ysize;
+       band.first_row += IMG_BAND_ROWS) {
+    rows = MIN(IMG_BAND_ROWS, wld.map.ysize - band.first_row);
+
+    fc_worker_pool_run(workers, rows, img_band_row, &band);
+
+    for (i = 0; i < rows * wld.map.xsize; i++) {
+      const struct img_tile *ptiledata = &band.tiles[i];
+
+      if (ptiledata->count == 0) {
+        continue;
       }
-    }
 
-    /* fogofwar; if only 1 player is plotted */
-    if (game.info.fogofwar && pimg->def->layers[MAPIMG_LAYER_FOGOFWAR]
-        && pplayer != NULL
-        && tile_knowledge == TILE_KNOWN_UNSEEN) {
-      pixel = pimg->pixel_fogofwar(ptile, pplayer, plr_knowledge);
-      pcolor = NULL;
-      img_plot_tile(pimg, ptile, pcolor, pixel);
+      index_to_map_pos(&x, &y, band.first_row * wld.map.xsize + i);
+      for (j = 0; j < ptiledata->count; j++) {
+        img_plot_index(pimg, x, y,
+                       img_palette_index(pimg, ptiledata->plot[j].pcolor),
+                       ptiledata->plot[j].pixel);
+      }
     }
-  } whole_map_iterate_end;
+  }
+
+  free(band.tiles);
 }
 
 /*
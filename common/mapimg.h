@@ -103,6 +103,9 @@ typedef struct player
 typedef int (*mapimg_plrcolor_count_func)(void);
 typedef struct rgbcolor *(*mapimg_plrcolor_get_func)(int);
 
+struct fc_worker_pool;
+typedef struct fc_worker_pool *(*mapimg_workers_func)(void);
+
 /* map definition */
 struct mapdef;
 
@@ -112,7 +115,8 @@ void mapimg_init(mapimg_tile_known_func mapimg_tile_known,
                  mapimg_tile_player_func mapimg_tile_city,
                  mapimg_tile_player_func mapimg_tile_unit,
                  mapimg_plrcolor_count_func mapimg_plrcolor_count,
-                 mapimg_plrcolor_get_func mapimg_plrcolor_get);
+                 mapimg_plrcolor_get_func mapimg_plrcolor_get,
+                 mapimg_workers_func mapimg_workers);
 void mapimg_reset(void);
 void mapimg_free(void);
 int mapimg_count(void);
@@ -31,6 +31,9 @@
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#ifdef HAVE_POLL_H
+#include <poll.h>
+#endif
 
 /* utility */
 #include "fcintl.h"
@@ -156,19 +159,74 @@ int read_socket_data(int sock, struct socket_packet_buffer *buffer)
   return -1;
 }
 
+/**********************************************************************//**
+  Drop 'n' bytes that were written from the front of the send buffer.
+**************************************************************************/
+static void send_buffer_consume(struct socket_packet_buffer *buf, int n)
+{
+  int own_done = 0;
+  int i = 0;
+
+  buf->ndata -= n;
+  while (n > 0) {
+    struct send_segment *seg = &buf->segments[i];
+    int done = MIN(n, seg->len);
+
+    if (seg->shared != NULL) {
+      seg->offset += done;
+    } else {
+      own_done += done;
+    }
+    seg->len -= done;
+    n -= done;
+
+    if (seg->len == 0) {
+      if (seg->shared != NULL) {
+        packet_shared_buffer_unref(seg->shared);
+      }
+      i++;
+    }
+  }
+
+  if (i > 0) {
+    buf->nsegments -= i;
+    memmove(buf->segments, buf->segments + i,
+            buf->nsegments * sizeof(*buf->segments));
+  }
+  if (own_done > 0) {
+    buf->nown -= own_done;
+    memmove(buf->data, buf->data + own_done, buf->nown);
+  }
+}
+
 /**********************************************************************//**
   write wrapper function -vasc
+  Writes until no more than 'limit' bytes are left in the buffer, or the
+  socket would block. Copied bytes and shared packets are gathered into
+  one write.
 **************************************************************************/
 static int write_socket_data(struct connection *pc,
 			     struct socket_packet_buffer *buf, int limit)
 {
-  int start, nput, nblock;
+  int start, nput;
 
   if (is_server() && pc->server.is_closing) {
     return 0;
   }
 
-  for (start=0; buf->ndata-start>limit;) {
+  for (start = 0; buf->ndata > limit;) {
+    bool exception, writable;
+#ifdef HAVE_POLL_H
+    /* The server may have sockets above FD_SETSIZE, which select()
+     * can't watch. */
+    struct pollfd pfd;
+
+    pfd.fd = pc->sock;
+    pfd.events = POLLOUT | POLLPRI;
+    pfd.revents = 0;
+
+    if (poll(&pfd, 1, 0) <= 0) {
+#else  /* HAVE_POLL_H */
     fd_set writefs, exceptfs;
     fc_timeval tv;
 
@@ -180,6 +238,7 @@ static int write_socket_data(struct connection *pc,
     tv.tv_sec = 0; tv.tv_usec = 0;
 
     if (fc_select(pc->sock+1, NULL, &writefs, &exceptfs, &tv) <= 0) {
+#endif /* HAVE_POLL_H */
       if (errno != EINTR) {
 	break;
       } else {
@@ -189,16 +248,39 @@ static int write_socket_data(struct connection *pc,
       }
     }
 
-    if (FD_ISSET(pc->sock, &exceptfs)) {
+#ifdef HAVE_POLL_H
+    exception = (pfd.revents & (POLLPRI | POLLERR | POLLNVAL)) != 0;
+    writable = (pfd.revents & POLLOUT) != 0;
+#else  /* HAVE_POLL_H */
+    exception = FD_ISSET(pc->sock, &exceptfs);
+    writable = FD_ISSET(pc->sock, &writefs);
+#endif /* HAVE_POLL_H */
+
+    if (exception) {
       connection_close(pc, _("network exception"));
       return -1;
     }
 
-    if (FD_ISSET(pc->sock, &writefs)) {
-      nblock=MIN(buf->ndata-start, MAX_LEN_PACKET);
-      log_debug("trying to write %d limit=%d", nblock, limit);
-      if ((nput = fc_writesocket(pc->sock, 
-                                 (const char *)buf->data+start, nblock)) == -1) {
+    if (writable) {
+      struct fc_iovec iov[FC_IOV_MAX];
+      int niov = MIN(buf->nsegments, FC_IOV_MAX);
+      int own_pos = 0;
+      int i;
+
+      for (i = 0; i < niov; i++) {
+        const struct send_segment *seg = &buf->segments[i];
+
+        if (seg->shared != NULL) {
+          iov[i].base = seg->shared->data + seg->offset;
+        } else {
+          iov[i].base = buf->data + own_pos;
+          own_pos += seg->len;
+        }
+        iov[i].len = seg->len;
+      }
+
+      log_debug("trying to write %d segments limit=%d", niov, limit);
+      if ((nput = fc_writevsocket(pc->sock, iov, niov)) == -1) {
 #ifdef NONBLOCKING_SOCKETS
 	if (errno == EWOULDBLOCK || errno == EAGAIN) {
 	  break;
@@ -207,13 +289,12 @@ static int write_socket_data(struct connection *pc,
         connection_close(pc, _("lagging connection"));
         return -1;
       }
+      send_buffer_consume(buf, nput);
       start += nput;
     }
   }
 
   if (start > 0) {
-    buf->ndata -= start;
-    memmove(buf->data, buf->data+start, buf->ndata);
     pc->last_write = timer_renew(pc->last_write, TIMER_USER, TIMER_ACTIVE);
     timer_start(pc->last_write);
   }
@@ -252,12 +333,40 @@ static void flush_connection_send_buffer_packets(struct connection *pc)
 #endif /* FREECIV_JSON_CONNECTION */
 
 /**********************************************************************//**
-  Add data to send to the connection.
+  Append a segment to the send queue, merging runs of copied bytes.
+**************************************************************************/
+static void send_buffer_push(struct socket_packet_buffer *buf,
+                             struct packet_shared_buffer *shared, int len)
+{
+  struct send_segment *last = (buf->nsegments > 0
+                               ? &buf->segments[buf->nsegments - 1] : NULL);
+
+  if (shared == NULL && last != NULL && last->shared == NULL) {
+    last->len += len;
+  } else {
+    if (buf->nsegments == buf->segments_size) {
+      buf->segments_size = MAX(16, 2 * buf->segments_size);
+      buf->segments = fc_realloc(buf->segments,
+                                 buf->segments_size * sizeof(*buf->segments));
+    }
+    buf->segments[buf->nsegments].shared = shared;
+    buf->segments[buf->nsegments].offset = 0;
+    buf->segments[buf->nsegments].len = len;
+    buf->nsegments++;
+  }
+  buf->ndata += len;
+}
+
+/**********************************************************************//**
+  Add data to send to the connection. Either 'data' is copied, or
+  'shared' queued by reference when not NULL.
 **************************************************************************/
 static bool add_connection_data(struct connection *pconn,
-                                const unsigned char *data, int len)
+                                const unsigned char *data, int len,
+                                struct packet_shared_buffer *shared)
 {
   struct socket_packet_buffer *buf;
+  bool was_empty;
 
   if (NULL == pconn
       || !pconn->used
@@ -267,21 +376,42 @@ static bool add_connection_data(struct connection *pconn,
 
   buf = pconn->send_buffer;
   log_debug("add %d bytes to %d (space =%d)", len, buf->ndata, buf->nsize);
-  if (!buffer_ensure_free_extra_space(buf, len)) {
+  was_empty = (0 == buf->ndata);
+
+  /* don't gobble up too much mem */
+  if (buf->ndata + len > MAX_LEN_BUFFER) {
     connection_close(pconn, _("buffer overflow"));
     return FALSE;
   }
 
-  memcpy(buf->data + buf->ndata, data, len);
-  buf->ndata += len;
+  if (shared != NULL) {
+    packet_shared_buffer_ref(shared);
+  } else {
+    if (buf->nsize - buf->nown < len) {
+      buf->nsize = buf->nown + len;
+      buf->data = (unsigned char *) fc_realloc(buf->data, buf->nsize);
+    }
+    memcpy(buf->data + buf->nown, data, len);
+    buf->nown += len;
+  }
+  send_buffer_push(buf, shared, len);
+
+  if (was_empty && is_server() && pconn->notify_of_writable_data) {
+    /* The server waits for writability while there is data to send; the
+     * flushes below report when it is gone. */
+    pconn->notify_of_writable_data(pconn, TRUE);
+  }
+
   return TRUE;
 }
 
 /**********************************************************************//**
-  Write data to socket. Return TRUE on success.
+  Queue data to send and flush what the buffering mode asks for.
+  Return TRUE on success.
 **************************************************************************/
-bool connection_send_data(struct connection *pconn,
-                          const unsigned char *data, int len)
+static bool connection_send_common(struct connection *pconn,
+                                   const unsigned char *data, int len,
+                                   struct packet_shared_buffer *shared)
 {
   if (NULL == pconn
       || !pconn->used
@@ -294,7 +424,7 @@ bool connection_send_data(struct connection *pconn,
 #ifndef FREECIV_JSON_CONNECTION
   if (0 < pconn->send_buffer->do_buffer_sends) {
     flush_connection_send_buffer_packets(pconn);
-    if (!add_connection_data(pconn, data, len)) {
+    if (!add_connection_data(pconn, data, len, shared)) {
       log_verbose("cut connection %s due to huge send buffer (1)",
                   conn_description(pconn));
       return FALSE;
@@ -304,7 +434,7 @@ bool connection_send_data(struct connection *pconn,
 #endif /* FREECIV_JSON_CONNECTION */
   {
     flush_connection_send_buffer_all(pconn);
-    if (!add_connection_data(pconn, data, len)) {
+    if (!add_connection_data(pconn, data, len, shared)) {
       log_verbose("cut connection %s due to huge send buffer (2)",
                   conn_description(pconn));
       return FALSE;
@@ -314,6 +444,64 @@ bool connection_send_data(struct connection *pconn,
   return TRUE;
 }
 
+/**********************************************************************//**
+  Write data to socket. Return TRUE on success.
+**************************************************************************/
+bool connection_send_data(struct connection *pconn,
+                          const unsigned char *data, int len)
+{
+  return connection_send_common(pconn, data, len, NULL);
+}
+
+/**********************************************************************//**
+  Write shared data to socket. The data is not copied; the connection
+  keeps a reference to it until it has been written. Return TRUE on
+  success.
+**************************************************************************/
+bool connection_send_shared(struct connection *pconn,
+                            struct packet_shared_buffer *shared)
+{
+  return connection_send_common(pconn, shared->data, shared->len, shared);
+}
+
+/**********************************************************************//**
+  Return a new shared buffer holding a copy of 'data', with a single
+  reference owned by the caller.
+**************************************************************************/
+struct packet_shared_buffer *packet_shared_buffer_new(const unsigned char *data,
+                                                      int len)
+{
+  struct packet_shared_buffer *shared = fc_malloc(sizeof(*shared));
+
+  shared->refcount = 1;
+  shared->len = len;
+  shared->data = fc_malloc(len);
+  memcpy(shared->data, data, len);
+
+  return shared;
+}
+
+/**********************************************************************//**
+  Take a new reference to the shared buffer.
+**************************************************************************/
+void packet_shared_buffer_ref(struct packet_shared_buffer *shared)
+{
+  shared->refcount++;
+}
+
+/**********************************************************************//**
+  Drop a reference to the shared buffer, freeing it with the last one.
+**************************************************************************/
+void packet_shared_buffer_unref(struct packet_shared_buffer *shared)
+{
+  fc_assert_ret(0 < shared->refcount);
+
+  if (0 == --shared->refcount) {
+    free(shared->data);
+    free(shared);
+  }
+}
+
 /**********************************************************************//**
   Turn on buffering, using a counter so that calls may be nested.
 **************************************************************************/
@@ -436,6 +624,10 @@ struct socket_packet_buffer *new_socket_packet_buffer(void)
   buf->do_buffer_sends = 0;
   buf->nsize = 10*MAX_LEN_PACKET;
   buf->data = (unsigned char *)fc_malloc(buf->nsize);
+  buf->nown = 0;
+  buf->nsegments = 0;
+  buf->segments_size = 0;
+  buf->segments = NULL;
   return buf;
 }
 
@@ -445,9 +637,17 @@ struct socket_packet_buffer *new_socket_packet_buffer(void)
 static void free_socket_packet_buffer(struct socket_packet_buffer *buf)
 {
   if (buf) {
+    int i;
+
     if (buf->data) {
       free(buf->data);
     }
+    for (i = 0; i < buf->nsegments; i++) {
+      if (buf->segments[i].shared != NULL) {
+        packet_shared_buffer_unref(buf->segments[i].shared);
+      }
+    }
+    free(buf->segments);
     free(buf);
   }
 }
@@ -593,6 +793,7 @@ void connection_common_init(struct connection *pconn)
   pconn->last_write = NULL;
   pconn->buffer = new_socket_packet_buffer();
   pconn->send_buffer = new_socket_packet_buffer();
+  pconn->broadcast = NULL;
   pconn->statistics.bytes_send = 0;
 #ifdef FREECIV_JSON_CONNECTION
   pconn->json_mode = TRUE;
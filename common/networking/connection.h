@@ -49,6 +49,7 @@ extern "C" {
 
 struct conn_pattern_list;
 struct genhash;
+struct packet_broadcast;
 struct packet_handlers;
 struct timer_list;
 
@@ -123,6 +124,30 @@ struct socket_packet_buffer {
   int do_buffer_sends;
   int nsize;
   unsigned char *data;
+
+  /* Send buffers only. There 'ndata' counts all the queued bytes, and
+   * 'nown' the ones copied to 'data'. 'segments' keeps those and the
+   * shared packets queued by reference in the order they are sent. */
+  int nown;
+  int nsegments;
+  int segments_size;
+  struct send_segment *segments;
+};
+
+/***********************************************************
+  A packet encoded once and queued by reference on several
+  connections, see connection_send_shared().
+***********************************************************/
+struct packet_shared_buffer {
+  int refcount;
+  int len;
+  unsigned char *data;
+};
+
+struct send_segment {
+  struct packet_shared_buffer *shared;  /* NULL for bytes in 'data' */
+  int offset;                           /* Shared bytes already sent */
+  int len;                              /* Bytes left to send */
 };
 
 struct packet_header {
@@ -158,6 +183,10 @@ struct connection {
   struct socket_packet_buffer *buffer;
   struct socket_packet_buffer *send_buffer;
   struct timer *last_write;
+
+  /* Set while a packet is encoded for a broadcast to several
+   * connections, see packet_broadcast_send(). */
+  struct packet_broadcast *broadcast;
 #ifdef FREECIV_JSON_CONNECTION
   bool json_mode;
   json_t *json_packet;
@@ -288,6 +317,13 @@ int read_socket_data(int sock, struct socket_packet_buffer *buffer);
 void flush_connection_send_buffer_all(struct connection *pc);
 bool connection_send_data(struct connection *pconn,
                           const unsigned char *data, int len);
+bool connection_send_shared(struct connection *pconn,
+                            struct packet_shared_buffer *shared);
+
+struct packet_shared_buffer *packet_shared_buffer_new(const unsigned char *data,
+                                                      int len);
+void packet_shared_buffer_ref(struct packet_shared_buffer *shared);
+void packet_shared_buffer_unref(struct packet_shared_buffer *shared);
 
 void connection_do_buffer(struct connection *pc);
 void connection_do_unbuffer(struct connection *pc);
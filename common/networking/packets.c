@@ -85,6 +85,8 @@ extern const char *const packet_functional_capability;
 
 static struct packet_handler_hash *packet_handlers = NULL;
 
+static struct packet_broadcast_stats broadcast_stats;
+
 #ifdef USE_COMPRESSION
 static int stat_size_alone = 0;
 static int stat_size_uncompressed = 0;
@@ -202,15 +204,18 @@ bool conn_compression_thaw(struct connection *pconn)
 
 
 /**********************************************************************//**
+  Send the packet data to the connection, either copying 'data' or
+  queueing 'shared' by reference when it's not NULL.
   It returns the request id of the outgoing packet (or 0 if is_server()).
 **************************************************************************/
-int send_packet_data(struct connection *pc, unsigned char *data, int len,
-                     enum packet_type packet_type)
+static int send_packet_common(struct connection *pc,
+                              const unsigned char *data, int len,
+                              struct packet_shared_buffer *shared,
+                              enum packet_type packet_type)
 {
   /* default for the server */
   int result = 0;
 
-
   log_packet("sending packet type=%s(%d) len=%d to %s",
              packet_name(packet_type), packet_type, len,
              is_server() ? pc->username : "server");
@@ -263,7 +268,11 @@ int send_packet_data(struct connection *pc, unsigned char *data, int len,
       stat_size_alone += size;
       log_compress("COMPRESS: sending %s alone (%d bytes total)",
                    packet_name(packet_type), stat_size_alone);
-      connection_send_data(pc, data, len);
+      if (shared != NULL) {
+        connection_send_shared(pc, shared);
+      } else {
+        connection_send_data(pc, data, len);
+      }
     }
 
     log_compress2("COMPRESS: STATS: alone=%d compression-expand=%d "
@@ -272,7 +281,11 @@ int send_packet_data(struct connection *pc, unsigned char *data, int len,
                   stat_size_uncompressed, stat_size_compressed);
   }
 #else  /* USE_COMPRESSION */
-  connection_send_data(pc, data, len);
+  if (shared != NULL) {
+    connection_send_shared(pc, shared);
+  } else {
+    connection_send_data(pc, data, len);
+  }
 #endif /* USE_COMPRESSION */
 
 #if PACKET_SIZE_STATISTICS
@@ -360,6 +373,230 @@ int send_packet_data(struct connection *pc, unsigned char *data, int len,
   return result;
 }
 
+/**********************************************************************//**
+  It returns the request id of the outgoing packet (or 0 if is_server()).
+**************************************************************************/
+int send_packet_data(struct connection *pc, unsigned char *data, int len,
+                     enum packet_type packet_type)
+{
+  struct packet_broadcast *bcast = pc->broadcast;
+
+  if (bcast != NULL && bcast->shared == NULL
+      && bcast->type == packet_type) {
+    /* First encoding of a broadcast packet; keep it for the others. */
+    bcast->shared = packet_shared_buffer_new(data, len);
+    bcast->handler = pc->phs.handlers->send[packet_type].packet;
+    bcast->header = pc->packet_header;
+#ifdef FREECIV_JSON_CONNECTION
+    bcast->json_mode = pc->json_mode;
+#endif /* FREECIV_JSON_CONNECTION */
+
+    return send_packet_common(pc, data, len, bcast->shared, packet_type);
+  }
+
+  return send_packet_common(pc, data, len, NULL, packet_type);
+}
+
+/**********************************************************************//**
+  Prepare to broadcast a packet of the given type.
+**************************************************************************/
+void packet_broadcast_init(struct packet_broadcast *bcast,
+                           enum packet_type type)
+{
+  bcast->type = type;
+  bcast->shared = NULL;
+  bcast->handler = NULL;
+}
+
+/**********************************************************************//**
+  Send the already encoded broadcast packet to 'pc' if it would encode it
+  the same way. Returns FALSE if the packet must be encoded for 'pc';
+  the caller sets pc->broadcast while doing that, so that the first
+  encoding gets kept for the next connections.
+**************************************************************************/
+bool packet_broadcast_resend(struct packet_broadcast *bcast,
+                             struct connection *pc)
+{
+  if (!pc->used) {
+    return FALSE;
+  }
+
+  if (bcast->shared == NULL
+      || bcast->handler != pc->phs.handlers->send[bcast->type].packet
+      || bcast->header.length != pc->packet_header.length
+      || bcast->header.type != pc->packet_header.type
+#ifdef FREECIV_JSON_CONNECTION
+      || bcast->json_mode != pc->json_mode
+#endif /* FREECIV_JSON_CONNECTION */
+      ) {
+    broadcast_stats.encoded++;
+    return FALSE;
+  }
+
+  send_packet_common(pc, bcast->shared->data, bcast->shared->len,
+                     bcast->shared, bcast->type);
+  broadcast_stats.reused++;
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Release the broadcast's reference to the encoded packet. Connections
+  that still have it queued keep it alive.
+**************************************************************************/
+void packet_broadcast_free(struct packet_broadcast *bcast)
+{
+  if (bcast->shared != NULL) {
+    packet_shared_buffer_unref(bcast->shared);
+    bcast->shared = NULL;
+  }
+}
+
+/**********************************************************************//**
+  Prepare to broadcast a delta packet of the given type.
+**************************************************************************/
+void packet_delta_broadcast_init(struct packet_delta_broadcast *dbcast,
+                                 enum packet_type type, const void *packet)
+{
+  dbcast->type = type;
+  dbcast->packet = packet;
+  dbcast->count = 0;
+}
+
+/**********************************************************************//**
+  Send the delta packet to 'pc' by reusing what was sent to a connection
+  with the same variant and the same previous state of the packet, and
+  update the delta state of 'pc' as sending would have done. 'ops' is
+  NULL when the variant of 'pc' has no delta state.
+  Returns FALSE if the packet must be sent to 'pc' the normal way. The
+  result is then kept for the next connections of the same group if
+  possible; pc->broadcast gets set and must be cleared after sending.
+**************************************************************************/
+bool packet_delta_broadcast_resend(struct packet_delta_broadcast *dbcast,
+                                   struct connection *pc,
+                                   const struct packet_delta_ops *ops)
+{
+  struct genhash **hash;
+  struct packet_delta_group *group = NULL;
+  void *old = NULL;
+  int i;
+
+  if (!pc->used) {
+    return FALSE;
+  }
+  if (ops == NULL) {
+    broadcast_stats.encoded++;
+    return FALSE;
+  }
+
+  hash = pc->phs.sent + dbcast->type;
+  if (NULL != *hash) {
+    genhash_lookup(*hash, dbcast->packet, &old);
+  }
+
+  for (i = 0; i < dbcast->count; i++) {
+    struct packet_delta_group *pgroup = &dbcast->groups[i];
+
+    if (pgroup->ops == ops
+        && pgroup->bcast.header.length == pc->packet_header.length
+        && pgroup->bcast.header.type == pc->packet_header.type
+#ifdef FREECIV_JSON_CONNECTION
+        && pgroup->bcast.json_mode == pc->json_mode
+#endif /* FREECIV_JSON_CONNECTION */
+        && (NULL == pgroup->prior
+            ? NULL == old
+            : NULL != old && ops->equal(pgroup->prior, old))) {
+      group = pgroup;
+      break;
+    }
+  }
+
+  if (NULL == group) {
+    /* A new group; its first connection encodes the packet. */
+    broadcast_stats.encoded++;
+    if (dbcast->count == PACKET_DELTA_GROUPS) {
+      return FALSE;
+    }
+
+    group = &dbcast->groups[dbcast->count++];
+    packet_broadcast_init(&group->bcast, dbcast->type);
+    group->bcast.header = pc->packet_header;
+#ifdef FREECIV_JSON_CONNECTION
+    group->bcast.json_mode = pc->json_mode;
+#endif /* FREECIV_JSON_CONNECTION */
+    group->ops = ops;
+    if (NULL != old) {
+      group->prior = fc_malloc(ops->size);
+      memcpy(group->prior, old, ops->size);
+    } else {
+      group->prior = NULL;
+    }
+    pc->broadcast = &group->bcast;
+
+    return FALSE;
+  }
+
+  broadcast_stats.reused++;
+  if (NULL == group->bcast.shared) {
+    /* Discarded as unchanged for the group, so for 'pc' too. */
+    return TRUE;
+  }
+
+  send_packet_common(pc, group->bcast.shared->data, group->bcast.shared->len,
+                     group->bcast.shared, dbcast->type);
+
+  /* Record the new state like the send function does. */
+  if (NULL == old) {
+    if (NULL == *hash) {
+      *hash = genhash_new_full(ops->hash, ops->cmp, NULL, NULL, NULL, free);
+    }
+    old = fc_malloc(ops->size);
+    memcpy(old, dbcast->packet, ops->size);
+    genhash_insert(*hash, old, old);
+  } else {
+    memcpy(old, dbcast->packet, ops->size);
+  }
+  for (i = 0; i < ops->cancel_count; i++) {
+    hash = pc->phs.sent + ops->cancel[i];
+    if (NULL != *hash) {
+      genhash_remove(*hash, dbcast->packet);
+    }
+  }
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Release the encodings and states kept for the delta broadcast.
+**************************************************************************/
+void packet_delta_broadcast_free(struct packet_delta_broadcast *dbcast)
+{
+  int i;
+
+  for (i = 0; i < dbcast->count; i++) {
+    packet_broadcast_free(&dbcast->groups[i].bcast);
+    free(dbcast->groups[i].prior);
+  }
+  dbcast->count = 0;
+}
+
+/**********************************************************************//**
+  Return the counters of broadcast encoding work.
+**************************************************************************/
+const struct packet_broadcast_stats *packet_broadcast_stats_get(void)
+{
+  return &broadcast_stats;
+}
+
+/**********************************************************************//**
+  Reset the counters of broadcast encoding work.
+**************************************************************************/
+void packet_broadcast_stats_reset(void)
+{
+  broadcast_stats.encoded = 0;
+  broadcast_stats.reused = 0;
+}
+
 /**********************************************************************//**
   Read and return a packet from the connection 'pc'. The type of the
   packet is written in 'ptype'. On error, the connection is closed and
@@ -21,6 +21,7 @@ struct connection;
 struct data_in;
 
 /* utility */
+#include "genhash.h"
 #include "shared.h"		/* MAX_LEN_ADDR */
 
 /* common */
@@ -193,6 +194,67 @@ void packets_deinit(void);
 
 int send_packet_data(struct connection *pc, unsigned char *data, int len,
                      enum packet_type packet_type);
+
+/* A packet sent to several connections. The bytes encoded for the first
+ * of them are queued by reference on the others that use the same send
+ * handler and header layout, see packet_broadcast_resend(). */
+struct packet_broadcast {
+  enum packet_type type;
+  struct packet_shared_buffer *shared;
+  int (*handler)(struct connection *pconn, const void *packet);
+  struct packet_header header;
+#ifdef FREECIV_JSON_CONNECTION
+  bool json_mode;
+#endif /* FREECIV_JSON_CONNECTION */
+};
+
+void packet_broadcast_init(struct packet_broadcast *bcast,
+                           enum packet_type type);
+bool packet_broadcast_resend(struct packet_broadcast *bcast,
+                             struct connection *pc);
+void packet_broadcast_free(struct packet_broadcast *bcast);
+
+/* Delta state handling of one packet variant. Connections whose
+ * previous state of a broadcast packet is the same get the same delta
+ * encoding, see packet_delta_broadcast_resend(). */
+struct packet_delta_ops {
+  size_t size;
+  genhash_val_t (*hash)(const void *key);
+  bool (*cmp)(const void *key1, const void *key2);
+  bool (*equal)(const void *old1, const void *old2);
+  int cancel_count;
+  const enum packet_type *cancel;
+};
+
+#define PACKET_DELTA_GROUPS 8
+
+/* A delta packet sent to several connections, encoded once for each
+ * group of connections sharing variant and previous state. */
+struct packet_delta_broadcast {
+  enum packet_type type;
+  const void *packet;
+  int count;
+  struct packet_delta_group {
+    struct packet_broadcast bcast;
+    const struct packet_delta_ops *ops;
+    void *prior;                        /* NULL if nothing sent before */
+  } groups[PACKET_DELTA_GROUPS];
+};
+
+void packet_delta_broadcast_init(struct packet_delta_broadcast *dbcast,
+                                 enum packet_type type, const void *packet);
+bool packet_delta_broadcast_resend(struct packet_delta_broadcast *dbcast,
+                                   struct connection *pc,
+                                   const struct packet_delta_ops *ops);
+void packet_delta_broadcast_free(struct packet_delta_broadcast *dbcast);
+
+struct packet_broadcast_stats {
+  unsigned long encoded;        /* Sends that ran the encoder */
+  unsigned long reused;         /* Sends that reused an encoding */
+};
+
+const struct packet_broadcast_stats *packet_broadcast_stats_get(void);
+void packet_broadcast_stats_reset(void);
 bool packet_check(struct data_in *din, struct connection *pc);
 
 /* Utilities to exchange strings and string vectors. */
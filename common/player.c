@@ -25,6 +25,7 @@
 /* common */
 #include "ai.h"
 #include "city.h"
+#include "effects.h"
 #include "fc_interface.h"
 #include "featured_text.h"
 #include "game.h"
@@ -555,6 +556,10 @@ static void player_defaults(struct player *pplayer)
   pplayer->music_style = -1;          /* even getting value 0 triggers change */
   pplayer->cities = city_list_new();
   pplayer->units = unit_list_new();
+  pplayer->gov_centers = city_list_new();
+  pplayer->gov_centers_stamp = 0;
+  pplayer->gov_centers_gov = NULL;
+  pplayer->gov_centers_num_cities = 0;
 
   pplayer->economic.gold    = 0;
   pplayer->economic.tax     = PLAYER_DEFAULT_TAX_RATE;
@@ -718,6 +723,7 @@ void player_destroy(struct player *pplayer)
   unit_list_destroy(pplayer->units);
   fc_assert(0 == city_list_size(pplayer->cities));
   city_list_destroy(pplayer->cities);
+  city_list_destroy(pplayer->gov_centers);
 
   fc_assert(conn_list_size(pplayer->connections) == 0);
   conn_list_destroy(pplayer->connections);
@@ -809,6 +815,7 @@ bool player_set_nation(struct player *pplayer, struct nation_type *pnation)
       pnation->player = pplayer;
     }
     pplayer->nation = pnation;
+    effect_cache_flush();
     return TRUE;
   }
   return FALSE;
@@ -265,6 +265,11 @@ struct player {
   int music_style;
   struct city_list *cities;
   struct unit_list *units;
+  /* Cities that are government centers; see player_gov_centers(). */
+  struct city_list *gov_centers;
+  unsigned int gov_centers_stamp;
+  const struct government *gov_centers_gov;
+  int gov_centers_num_cities;
   struct player_score score;
   struct player_economic economic;
 
@@ -310,6 +315,7 @@ struct player {
                             * (Previously 'capital'.) */
 
       struct player_tile *private_map;
+      struct player_tile_seen *private_seen;
 
       /* Player can see inside his borders. */
       bool border_vision;
@@ -343,7 +349,7 @@ struct player {
       /* Only used at the client (the server is omniscient; ./client/). */
 
       /* Corresponds to the result of
-         (player:server:private_map[tile_index]:seen_count[vlayer] != 0). */
+         (player:server:private_seen[tile_index]:seen_count[vlayer] != 0). */
       struct dbv tile_vision[V_COUNT];
 
       enum mood_type mood;
@@ -18,6 +18,7 @@
 #include "astring.h"
 #include "fcintl.h"
 #include "log.h"
+#include "mem.h"
 #include "support.h"
 
 /* common */
@@ -3143,6 +3144,284 @@ bool are_reqs_active(const struct player *target_player,
   return TRUE;
 }
 
+/* Opcodes of a compiled requirement. The specialized ones evaluate the
+ * requirement inline exactly as is_req_active() would; everything else
+ * goes through is_req_active(). */
+enum req_opcode {
+  ROP_GENERIC,
+  ROP_OTYPE,
+  ROP_SPECIALIST,
+  ROP_ACTION,
+  ROP_GOVERNMENT,
+  ROP_UTYPE,
+  ROP_UCLASS,
+  ROP_IMPR_GENUS,
+  ROP_MINSIZE
+};
+
+/**********************************************************************//**
+  Rough relative cost of evaluating the requirement: 0 for plain compares
+  against the targets, 1 for single lookups, 2 for anything that may have
+  to iterate over tiles, cities or players.
+**************************************************************************/
+static int req_eval_cost(const struct requirement *req)
+{
+  switch (req->source.kind) {
+  case VUT_NONE:
+  case VUT_OTYPE:
+  case VUT_SPECIALIST:
+  case VUT_ACTION:
+  case VUT_GOVERNMENT:
+  case VUT_IMPR_GENUS:
+  case VUT_AI_LEVEL:
+  case VUT_STYLE:
+  case VUT_UTYPE:
+  case VUT_UTFLAG:
+  case VUT_UCLASS:
+  case VUT_UCFLAG:
+  case VUT_MINVETERAN:
+  case VUT_UNITSTATE:
+  case VUT_MINMOVES:
+  case VUT_MINHP:
+  case VUT_AGE:
+  case VUT_MINYEAR:
+  case VUT_MINCALFRAG:
+  case VUT_TOPO:
+    return 0;
+  case VUT_MINSIZE:
+    return (req->range == REQ_RANGE_TRADEROUTE ? 2 : 0);
+  case VUT_ADVANCE:
+  case VUT_TECHFLAG:
+  case VUT_NATION:
+  case VUT_NATIONGROUP:
+    return (req->range <= REQ_RANGE_PLAYER ? 1 : 2);
+  case VUT_IMPROVEMENT:
+    return (req->range <= REQ_RANGE_CITY ? 1 : 2);
+  case VUT_EXTRA:
+  case VUT_TERRAIN:
+  case VUT_TERRFLAG:
+  case VUT_TERRAINCLASS:
+  case VUT_BASEFLAG:
+  case VUT_ROADFLAG:
+  case VUT_EXTRAFLAG:
+  case VUT_TERRAINALTER:
+  case VUT_CITYTILE:
+    return (req->range == REQ_RANGE_LOCAL ? 1 : 2);
+  case VUT_SERVERSETTING:
+  case VUT_MINTECHS:
+    return 1;
+  case VUT_GOOD:
+  case VUT_NATIONALITY:
+  case VUT_DIPLREL:
+  case VUT_MINCULTURE:
+  case VUT_MAXTILEUNITS:
+  case VUT_ACHIEVEMENT:
+  case VUT_COUNT:
+    break;
+  }
+
+  return 2;
+}
+
+/**********************************************************************//**
+  Opcode to evaluate the requirement with.
+**************************************************************************/
+static enum req_opcode req_opcode_for(const struct requirement *req)
+{
+  switch (req->source.kind) {
+  case VUT_OTYPE:
+    return ROP_OTYPE;
+  case VUT_SPECIALIST:
+    return ROP_SPECIALIST;
+  case VUT_ACTION:
+    return ROP_ACTION;
+  case VUT_GOVERNMENT:
+    return ROP_GOVERNMENT;
+  case VUT_UTYPE:
+    return (req->range == REQ_RANGE_LOCAL ? ROP_UTYPE : ROP_GENERIC);
+  case VUT_UCLASS:
+    return (req->range == REQ_RANGE_LOCAL ? ROP_UCLASS : ROP_GENERIC);
+  case VUT_IMPR_GENUS:
+    return ROP_IMPR_GENUS;
+  case VUT_MINSIZE:
+    return (req->range != REQ_RANGE_TRADEROUTE ? ROP_MINSIZE : ROP_GENERIC);
+  default:
+    return ROP_GENERIC;
+  }
+}
+
+/**********************************************************************//**
+  Initialize an empty, not yet compiled, requirement program.
+**************************************************************************/
+void req_program_init(struct req_program *prog)
+{
+  prog->compiled = FALSE;
+  prog->never = FALSE;
+  prog->source_size = 0;
+  prog->count = 0;
+  prog->ops = NULL;
+}
+
+/**********************************************************************//**
+  Compile the requirement vector into the program, replacing whatever
+  the program held before.
+**************************************************************************/
+void req_program_compile(struct req_program *prog,
+                         const struct requirement_vector *reqs)
+{
+  int n = 0;
+
+  req_program_free(prog);
+
+  prog->source_size = requirement_vector_size(reqs);
+  if (prog->source_size > 0) {
+    prog->ops = fc_malloc(prog->source_size * sizeof(*prog->ops));
+  }
+
+  requirement_vector_iterate(reqs, preq) {
+    int cost, i;
+
+    if (preq->source.kind == VUT_NONE) {
+      /* Always active when present, never when not. */
+      if (!preq->present) {
+        prog->never = TRUE;
+      }
+      continue;
+    }
+
+    /* Stable insertion by cost, so that equally cheap requirements keep
+     * the ruleset order. */
+    cost = req_eval_cost(preq);
+    for (i = n; i > 0 && req_eval_cost(&prog->ops[i - 1].req) > cost; i--) {
+      prog->ops[i] = prog->ops[i - 1];
+    }
+    prog->ops[i].opcode = req_opcode_for(preq);
+    prog->ops[i].req = *preq;
+    n++;
+  } requirement_vector_iterate_end;
+
+  prog->count = n;
+  prog->compiled = TRUE;
+}
+
+/**********************************************************************//**
+  Free the compiled form of the program. It's left in the initialized,
+  not compiled, state.
+**************************************************************************/
+void req_program_free(struct req_program *prog)
+{
+  if (prog->ops != NULL) {
+    free(prog->ops);
+  }
+  req_program_init(prog);
+}
+
+/**********************************************************************//**
+  Same as are_reqs_active(), but using the program compiled from reqs
+  when there is one. prog may be NULL.
+**************************************************************************/
+bool are_reqs_active_prog(const struct player *target_player,
+                          const struct player *other_player,
+                          const struct city *target_city,
+                          const struct impr_type *target_building,
+                          const struct tile *target_tile,
+                          const struct unit *target_unit,
+                          const struct unit_type *target_unittype,
+                          const struct output_type *target_output,
+                          const struct specialist *target_specialist,
+                          const struct action *target_action,
+                          const struct requirement_vector *reqs,
+                          const struct req_program *prog,
+                          const enum   req_problem_type prob_type)
+{
+  int i;
+
+  if (prog == NULL || !prog->compiled
+      || prog->source_size != requirement_vector_size(reqs)) {
+    return are_reqs_active(target_player, other_player, target_city,
+                           target_building, target_tile,
+                           target_unit, target_unittype,
+                           target_output, target_specialist, target_action,
+                           reqs, prob_type);
+  }
+
+  if (prog->never) {
+    return FALSE;
+  }
+
+  if (target_unittype == NULL && target_unit != NULL) {
+    target_unittype = unit_type_get(target_unit);
+  }
+
+  for (i = 0; i < prog->count; i++) {
+    const struct requirement *req = &prog->ops[i].req;
+    enum fc_tristate eval;
+
+    switch (prog->ops[i].opcode) {
+    case ROP_OTYPE:
+      eval = BOOL_TO_TRISTATE(target_output
+                              && target_output->index
+                                 == req->source.value.outputtype);
+      break;
+    case ROP_SPECIALIST:
+      eval = BOOL_TO_TRISTATE(target_specialist
+                              && target_specialist
+                                 == req->source.value.specialist);
+      break;
+    case ROP_ACTION:
+      eval = BOOL_TO_TRISTATE(target_action
+                              && action_number(target_action)
+                                 == action_number(req->source.value.action));
+      break;
+    case ROP_GOVERNMENT:
+      eval = (target_player == NULL ? TRI_MAYBE
+              : BOOL_TO_TRISTATE(government_of_player(target_player)
+                                 == req->source.value.govern));
+      break;
+    case ROP_UTYPE:
+      eval = (target_unittype == NULL ? TRI_MAYBE
+              : BOOL_TO_TRISTATE(target_unittype
+                                 == req->source.value.utype));
+      break;
+    case ROP_UCLASS:
+      eval = (target_unittype == NULL ? TRI_MAYBE
+              : BOOL_TO_TRISTATE(utype_class(target_unittype)
+                                 == req->source.value.uclass));
+      break;
+    case ROP_IMPR_GENUS:
+      eval = (target_building == NULL ? TRI_MAYBE
+              : BOOL_TO_TRISTATE(target_building->genus
+                                 == req->source.value.impr_genus));
+      break;
+    case ROP_MINSIZE:
+      eval = (target_city == NULL ? TRI_MAYBE
+              : BOOL_TO_TRISTATE(city_size_get(target_city)
+                                 >= req->source.value.minsize));
+      break;
+    case ROP_GENERIC:
+    default:
+      if (!is_req_active(target_player, other_player, target_city,
+                         target_building, target_tile,
+                         target_unit, target_unittype,
+                         target_output, target_specialist, target_action,
+                         req, prob_type)) {
+        return FALSE;
+      }
+      continue;
+    }
+
+    if (eval == TRI_MAYBE) {
+      if (prob_type != RPT_POSSIBLE) {
+        return FALSE;
+      }
+    } else if (req->present ? eval != TRI_YES : eval != TRI_NO) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
 /**********************************************************************//**
   Return TRUE if this is an "unchanging" requirement.  This means that
   if a target can't meet the requirement now, it probably won't ever be able
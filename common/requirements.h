@@ -86,6 +86,29 @@ struct requirement {
   TYPED_VECTOR_ITERATE(struct requirement, req_vec, preq)
 #define requirement_vector_iterate_end VECTOR_ITERATE_END
 
+/* A requirement vector compiled for faster evaluation: trivially true
+ * requirements are dropped and the rest ordered so that the cheapest
+ * checks, the ones most likely to reject the target, run first.
+ * The compiled form holds copies of the requirements, so it stays valid
+ * only as long as the vector it was compiled from is not edited. */
+struct req_op {
+  int opcode;                   /* enum req_opcode, see requirements.c */
+  struct requirement req;
+};
+
+struct req_program {
+  bool compiled;
+  bool never;                   /* Contains a requirement never active */
+  int source_size;              /* Size of the vector compiled from */
+  int count;
+  struct req_op *ops;
+};
+
+void req_program_init(struct req_program *prog);
+void req_program_compile(struct req_program *prog,
+                         const struct requirement_vector *reqs);
+void req_program_free(struct req_program *prog);
+
 /* General requirement functions. */
 struct requirement req_from_str(const char *type, const char *range,
                                 bool survives, bool present, bool quiet,
@@ -134,6 +157,19 @@ bool are_reqs_active(const struct player *target_player,
                      const struct action *target_action,
                      const struct requirement_vector *reqs,
                      const enum   req_problem_type prob_type);
+bool are_reqs_active_prog(const struct player *target_player,
+                          const struct player *other_player,
+                          const struct city *target_city,
+                          const struct impr_type *target_building,
+                          const struct tile *target_tile,
+                          const struct unit *target_unit,
+                          const struct unit_type *target_unittype,
+                          const struct output_type *target_output,
+                          const struct specialist *target_specialist,
+                          const struct action *target_action,
+                          const struct requirement_vector *reqs,
+                          const struct req_program *prog,
+                          const enum   req_problem_type prob_type);
 
 bool is_req_unchanging(const struct requirement *req);
 
@@ -22,6 +22,7 @@
 #include "support.h"
 
 /* common */
+#include "effects.h"
 #include "fc_types.h"
 #include "game.h"
 #include "player.h"
@@ -514,7 +515,8 @@ static bool research_get_root_reqs_known(const struct research *presearch,
   Mark as TECH_PREREQS_KNOWN each tech which is available, not known and
   which has all requirements fullfiled.
 
-  Recalculate presearch->num_known_tech_with_flag
+  Recalculate presearch->num_known_tech_with_flag and
+  presearch->techs_known.
   Should always be called after research_invention_set().
 ****************************************************************************/
 void research_update(struct research *presearch)
@@ -522,6 +524,8 @@ void research_update(struct research *presearch)
   enum tech_flag_id flag;
   int techs_researched;
 
+  presearch->techs_known = 0;
+
   advance_index_iterate(A_FIRST, i) {
     enum tech_state state = presearch->inventions[i].state;
     bool root_reqs_known = TRUE;
@@ -550,6 +554,9 @@ void research_update(struct research *presearch)
     presearch->inventions[i].state = state;
     presearch->inventions[i].reachable = reachable;
     presearch->inventions[i].root_reqs_known = root_reqs_known;
+    if (state == TECH_KNOWN) {
+      presearch->techs_known++;
+    }
 
     /* Updates required_techs, num_required_techs and bulbs_required. */
     BV_CLR_ALL(presearch->inventions[i].required_techs);
@@ -656,6 +663,7 @@ enum tech_state research_invention_set(struct research *presearch,
     return old;
   }
   presearch->inventions[tech].state = value;
+  effect_cache_changed(ECD_TECH);
 
   if (value == TECH_KNOWN) {
     if (!game.info.global_advances[tech]) {
@@ -88,6 +88,8 @@ struct research {
    * Cached values. Updated by research_update().
    */
   int num_known_tech_with_flag[TF_COUNT];
+  /* Number of known techs, not counting A_NONE. */
+  int techs_known;
 
   union {
     /* Add server side when needed */
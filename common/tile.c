@@ -21,6 +21,7 @@
 #include "support.h"
 
 /* common */
+#include "effects.h"
 #include "fc_interface.h"
 #include "game.h"
 #include "map.h"
@@ -70,6 +71,9 @@ void tile_set_owner(struct tile *ptile, struct player *pplayer,
                     struct tile *claimer)
 {
   if (BORDERS_DISABLED != game.info.borders) {
+    if (ptile->owner != pplayer) {
+      effect_cache_tile_changed(ptile);
+    }
     ptile->owner = pplayer;
     ptile->claimer = claimer;
   }
@@ -142,6 +146,9 @@ void tile_set_terrain(struct tile *ptile, struct terrain *pterrain)
                 terrain_number(pterrain), city_name_get(tile_city(ptile)),
                 tile_city(ptile)->id);
 
+  if (ptile->terrain != pterrain) {
+    effect_cache_tile_changed(ptile);
+  }
   ptile->terrain = pterrain;
   if (ptile->resource != NULL) {
     if (NULL != pterrain
@@ -408,6 +415,9 @@ Continent_id tile_continent(const struct tile *ptile)
 ****************************************************************************/
 void tile_set_continent(struct tile *ptile, Continent_id val)
 {
+  if (ptile->continent != val) {
+    effect_cache_tile_changed(ptile);
+  }
   ptile->continent = val;
 }
 
@@ -1012,8 +1022,9 @@ bool tile_has_cause_extra(const struct tile *ptile, enum extra_cause cause)
 ****************************************************************************/
 void tile_add_extra(struct tile *ptile, const struct extra_type *pextra)
 {
-  if (pextra != NULL) {
+  if (pextra != NULL && !BV_ISSET(ptile->extras, extra_index(pextra))) {
     BV_SET(ptile->extras, extra_index(pextra));
+    effect_cache_tile_changed(ptile);
   }
 }
 
@@ -1022,8 +1033,9 @@ void tile_add_extra(struct tile *ptile, const struct extra_type *pextra)
 ****************************************************************************/
 void tile_remove_extra(struct tile *ptile, const struct extra_type *pextra)
 {
-  if (pextra != NULL) {
+  if (pextra != NULL && BV_ISSET(ptile->extras, extra_index(pextra))) {
     BV_CLR(ptile->extras, extra_index(pextra));
+    effect_cache_tile_changed(ptile);
   }
 }
 
@@ -228,6 +228,9 @@ struct unit {
       /* The unit is in the process of dying. */
       bool dying;
 
+      /* The unit info is to be sent by unit_info_thaw(). */
+      bool info_pending;
+
       /* Call back to run on unit removal. */
       void (*removal_callback)(struct unit *punit);
 
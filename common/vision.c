@@ -40,6 +40,7 @@ struct vision *vision_new(struct player *pplayer, struct tile *ptile)
   vision->radius_sq[V_MAIN] = -1;
   vision->radius_sq[V_INVIS] = -1;
   vision->radius_sq[V_SUBSURFACE] = -1;
+  vision->linked = NULL;
 
   return vision;
 }
@@ -52,9 +53,22 @@ void vision_free(struct vision *vision)
   fc_assert(-1 == vision->radius_sq[V_MAIN]);
   fc_assert(-1 == vision->radius_sq[V_INVIS]);
   fc_assert(-1 == vision->radius_sq[V_SUBSURFACE]);
+  fc_assert(NULL == vision->linked);
   free(vision);
 }
 
+/************************************************************************//**
+  Undo the link between the vision source and the one it is linked to.
+  The caller has to take care of the seen counts of the tiles they share.
+****************************************************************************/
+void vision_unlink(struct vision *vision)
+{
+  if (NULL != vision->linked) {
+    vision->linked->linked = NULL;
+    vision->linked = NULL;
+  }
+}
+
 /************************************************************************//**
   Sets the can_reveal_tiles flag.
   Returns the old flag.
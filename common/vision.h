@@ -69,6 +69,11 @@ extern "C" {
   note that for all the code in the middle both the new and the old
   vision sources are active.  The same process applies when transferring
   a unit or city between players, etc.
+
+  When the new source is created for a move, vision_link() can be called
+  on it and the old source before its sight is set.  Then only the tiles
+  seen from one of the positions change their seen count, instead of all
+  tiles in both circles.
 ****************************************************************************/
 
 /* Invariants: V_MAIN vision ranges must always be more than V_INVIS
@@ -90,6 +95,10 @@ struct vision {
 
   /* The radius of the vision source. */
   v_radius_t radius_sq;
+
+  /* The source this one replaces, or is replaced by. The tiles seen by
+   * both count only once, see vision_link(). */
+  struct vision *linked;
 };
 
 /* Initialize a vision radius array. */
@@ -103,6 +112,7 @@ struct vision {
 
 struct vision *vision_new(struct player *pplayer, struct tile *ptile);
 void vision_free(struct vision *vision);
+void vision_unlink(struct vision *vision);
 
 bool vision_reveal_tiles(struct vision *vision, bool reveal_tiles);
 
@@ -142,7 +142,7 @@ static bool explorer_goto(struct unit *punit, struct tile *ptile)
 
   UNIT_LOG(LOG_DEBUG, punit, "explorer_goto to %d,%d", TILE_XY(ptile));
 
-  pfm = pf_map_new(&parameter);
+  pfm = pf_map_new_goal(&parameter, ptile);
   path = pf_map_path(pfm, ptile);
 
   if (path != NULL) {
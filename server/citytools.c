@@ -34,6 +34,7 @@
 #include "citizens.h"
 #include "city.h"
 #include "culture.h"
+#include "effects.h"
 #include "events.h"
 #include "game.h"
 #include "government.h"
@@ -64,6 +65,7 @@
 #include "notify.h"
 #include "plrhand.h"
 #include "sanitycheck.h"
+#include "score.h"
 #include "sernet.h"
 #include "spacerace.h"
 #include "srv_main.h"
@@ -1178,8 +1180,10 @@ bool transfer_city(struct player *ptaker, struct city *pcity,
   /* city_thaw_workers_queue() later */
 
   pcity->owner = ptaker;
+  effect_cache_flush();
   map_claim_ownership(pcenter, ptaker, pcenter, TRUE);
   city_list_prepend(ptaker->cities, pcity);
+  score_city_area_changed(pcenter, city_map_radius_sq_get(pcity));
 
   /* Hide/reveal units. Do it after vision have been given to taker, city
    * owner has been changed, and before any script could be spawned. */
@@ -1517,6 +1521,7 @@ void create_city(struct player *pplayer, struct tile *ptile,
    * It is possible to build a city on a tile that is already worked;
    * this will displace the worker on the newly-built city's tile -- Syela */
   tile_set_worked(ptile, pcity); /* instead of city_map_update_worker() */
+  effect_cache_flush();
 
   if (NULL != pwork) {
     /* was previously worked by another city */
@@ -1554,6 +1559,7 @@ void create_city(struct player *pplayer, struct tile *ptile,
   vision_reveal_tiles(pcity->server.vision, game.server.vision_reveal_tiles);
   city_refresh_vision(pcity);
   city_list_prepend(pplayer->cities, pcity);
+  score_city_area_changed(ptile, city_map_radius_sq_get(pcity));
 
   /* This is dependent on the current vision, so must be done after
    * vision is prepared and before arranging workers. */
@@ -1626,6 +1632,7 @@ void remove_city(struct city *pcity)
 {
   struct player *powner = city_owner(pcity);
   struct tile *pcenter = city_tile(pcity);
+  int radius_sq = city_map_radius_sq_get(pcity);
   bv_imprs had_small_wonders;
   struct vision *old_vision;
   int id = pcity->id; /* We need this even after memory has been freed */
@@ -1785,6 +1792,7 @@ void remove_city(struct city *pcity)
 
   /* Remove city from the map. */
   tile_set_worked(pcenter, NULL);
+  effect_cache_flush();
 
   /* Reveal units. */
   players_iterate(other_player) {
@@ -1802,6 +1810,7 @@ void remove_city(struct city *pcity)
   fc_allocate_mutex(&game.server.mutexes.city_list);
   game_remove_city(&wld, pcity);
   fc_release_mutex(&game.server.mutexes.city_list);
+  score_city_area_changed(pcenter, radius_sq);
 
   /* Remove any extras that were only there because the city was there. */
   extra_type_iterate(pextra) {
@@ -2123,6 +2132,7 @@ static void broadcast_city_info(struct city *pcity)
   struct packet_city_short_info sc_pack;
   struct player *powner = city_owner(pcity);
   struct traderoute_packet_list *routes = traderoute_packet_list_new();
+  struct conn_list *observers = NULL;
 
   /* Send to everyone who can see the city. */
   package_city(pcity, &packet, &web_packet, routes, FALSE);
@@ -2146,13 +2156,20 @@ static void broadcast_city_info(struct city *pcity)
     }
   } players_iterate_end;
 
-  /* Send to global observers. */
+  /* Send to global observers, encoding the packets once for all. */
   conn_list_iterate(game.est_connections, pconn) {
     if (conn_is_global_observer(pconn)) {
-      send_packet_city_info(pconn, &packet, FALSE);
-      web_send_packet(city_info_addition, pconn, &web_packet, FALSE);
+      if (NULL == observers) {
+        observers = conn_list_new();
+      }
+      conn_list_append(observers, pconn);
     }
   } conn_list_iterate_end;
+  if (NULL != observers) {
+    lsend_packet_city_info(observers, &packet, FALSE);
+    web_lsend_packet(city_info_addition, observers, &web_packet, FALSE);
+    conn_list_destroy(observers);
+  }
 
   traderoute_packet_list_iterate(routes, route_packet) {
     FC_FREE(route_packet);
@@ -2185,21 +2202,70 @@ void send_all_known_cities(struct conn_list *dest)
 }
 
 /************************************************************************//**
-  Send information about all his/her cities to player
+  Refresh the given cities and send each of them to its owner.
 ****************************************************************************/
-void send_player_cities(struct player *pplayer)
+static void send_cities_refreshed(struct city **cities, int count)
 {
-  city_list_iterate(pplayer->cities, pcity) {
-    if (city_refresh(pcity)) {
+  bool radius_changed[count];
+  int i;
+
+  city_refresh_array(cities, count, radius_changed);
+
+  for (i = 0; i < count; i++) {
+    if (radius_changed[i]) {
       log_error("%s radius changed while sending to player.",
-                city_name_get(pcity));
+                city_name_get(cities[i]));
 
       /* Make sure that no workers in illegal position outside radius. */
-      auto_arrange_workers(pcity);
+      auto_arrange_workers(cities[i]);
     }
-    send_city_info(pplayer, pcity);
+    send_city_info(city_owner(cities[i]), cities[i]);
+  }
+}
+
+/************************************************************************//**
+  Send information about all his/her cities to player
+****************************************************************************/
+void send_player_cities(struct player *pplayer)
+{
+  int n = city_list_size(pplayer->cities);
+
+  if (n > 0) {
+    struct city *cities[n];
+    int i = 0;
+
+    city_list_iterate(pplayer->cities, pcity) {
+      cities[i++] = pcity;
+    } city_list_iterate_end;
+
+    send_cities_refreshed(cities, n);
+  }
+}
+
+/************************************************************************//**
+  Like send_player_cities() for every player of the current phase, but
+  with the refresh of all their cities done in one batch.
+****************************************************************************/
+void send_phase_players_cities(void)
+{
+  int n = 0;
+
+  phase_players_iterate(pplayer) {
+    n += city_list_size(pplayer->cities);
+  } phase_players_iterate_end;
+
+  if (n > 0) {
+    struct city *cities[n];
+    int i = 0;
+
+    phase_players_iterate(pplayer) {
+      city_list_iterate(pplayer->cities, pcity) {
+        cities[i++] = pcity;
+      } city_list_iterate_end;
+    } phase_players_iterate_end;
+
+    send_cities_refreshed(cities, n);
   }
-  city_list_iterate_end;
 }
 
 /************************************************************************//**
@@ -3006,6 +3072,7 @@ void change_build_target(struct player *pplayer, struct city *pcity,
 void city_map_update_empty(struct city *pcity, struct tile *ptile)
 {
   tile_set_worked(ptile, NULL);
+  score_tile_changed(ptile);
   send_tile_info(NULL, ptile, FALSE);
   pcity->server.synced = FALSE;
 }
@@ -3018,6 +3085,7 @@ void city_map_update_empty(struct city *pcity, struct tile *ptile)
 void city_map_update_worker(struct city *pcity, struct tile *ptile)
 {
   tile_set_worked(ptile, pcity);
+  score_tile_changed(ptile);
   send_tile_info(NULL, ptile, FALSE);
   pcity->server.synced = FALSE;
 }
@@ -3035,6 +3103,7 @@ static bool city_map_update_tile_direct(struct tile *ptile, bool queued)
    && !is_free_worked(pwork, ptile)
    && !city_can_work_tile(pwork, ptile)) {
     tile_set_worked(ptile, NULL);
+    score_tile_changed(ptile);
     send_tile_info(NULL, ptile, FALSE);
 
     pwork->specialists[DEFAULT_SPECIALIST]++; /* keep city sanity */
@@ -3232,6 +3301,8 @@ bool city_map_update_radius_sq(struct city *pcity)
   citylog_map_workers(LOG_DEBUG, pcity);
 
   city_map_radius_sq_set(pcity, city_radius_sq_new);
+  score_city_area_changed(city_tile(pcity),
+                          MAX(city_radius_sq_old, city_radius_sq_new));
 
   if (city_tiles_old < city_tiles_new) {
     /* increased number of city tiles */
@@ -52,6 +52,7 @@ void send_city_info_at_tile(struct player *pviewer, struct conn_list *dest,
 			    struct city *pcity, struct tile *ptile);
 void send_all_known_cities(struct conn_list *dest);
 void send_player_cities(struct player *pplayer);
+void send_phase_players_cities(void);
 void package_city(struct city *pcity, struct packet_city_info *packet,
                   struct packet_web_city_info_addition *web_packet,
                   struct traderoute_packet_list *routes,
@@ -27,6 +27,7 @@
 #include "rand.h"
 #include "shared.h"
 #include "support.h"
+#include "workerpool.h"
 
 /* common/aicore */
 #include "cm.h"
@@ -39,6 +40,7 @@
 #include "citizens.h"
 #include "city.h"
 #include "culture.h"
+#include "effects.h"
 #include "events.h"
 #include "disaster.h"
 #include "game.h"
@@ -170,19 +172,111 @@ bool city_refresh(struct city *pcity)
   return retval;
 }
 
+/**********************************************************************//**
+  Worker pool job for city_refresh_array(): first half of the refresh.
+**************************************************************************/
+static void city_refresh_array_base(int idx, void *data)
+{
+  struct city **cities = data;
+
+  city_refresh_citizen_base(cities[idx], NULL);
+}
+
+/**********************************************************************//**
+  Worker pool job for city_refresh_array(): second half of the refresh.
+**************************************************************************/
+static void city_refresh_array_surpluses(int idx, void *data)
+{
+  struct city **cities = data;
+
+  city_refresh_surpluses(cities[idx]);
+  city_style_refresh(cities[idx]);
+}
+
+/**********************************************************************//**
+  Do city_refresh() for 'count' cities at once. radius_changed[] gets
+  what city_refresh() would have returned for each of them.
+
+  City radius and unit upkeep updates may touch other cities and send
+  packets, so they are done first, serially and in array order. The
+  refresh proper only writes to the city itself, and is spread over the
+  turn worker pool. The result does not depend on the number of threads.
+**************************************************************************/
+void city_refresh_array(struct city **cities, int count,
+                        bool *radius_changed)
+{
+  struct fc_worker_pool *workers = server_turn_workers();
+  bool threaded = (count > 1 && fc_worker_pool_threads(workers) > 1);
+  bool owner_done[MAX_NUM_PLAYER_SLOTS];
+  int i;
+
+  memset(owner_done, 0, sizeof(owner_done));
+  for (i = 0; i < count; i++) {
+    struct player *owner = city_owner(cities[i]);
+
+    cities[i]->server.needs_refresh = FALSE;
+    radius_changed[i] = city_map_update_radius_sq(cities[i]);
+    city_units_upkeep(cities[i]); /* update unit upkeep */
+
+    if (!owner_done[player_index(owner)]) {
+      /* Every city of the owner asks for these. Get them into the effect
+       * cache now: it won't store anything while frozen. */
+      player_content_citizens(owner);
+      player_angry_citizens(owner);
+      player_gov_centers(owner);
+      owner_done[player_index(owner)] = TRUE;
+    }
+  }
+
+  /* The effect cache is not safe to update from several threads. */
+  if (threaded) {
+    effect_cache_freeze(TRUE);
+  }
+
+  /* Trade routes read the partner's citizen_base[], so all cities have to
+   * finish the first half before any of them starts the second. */
+  fc_worker_pool_run(workers, count, city_refresh_array_base, cities);
+  fc_worker_pool_run(workers, count, city_refresh_array_surpluses, cities);
+
+  if (threaded) {
+    effect_cache_freeze(FALSE);
+  }
+
+  for (i = 0; i < count; i++) {
+    if (radius_changed[i]) {
+      /* Force a sync of the city after the change. */
+      send_city_info(city_owner(cities[i]), cities[i]);
+    }
+  }
+}
+
 /**********************************************************************//**
   Called on government change or wonder completion or stuff like that
   -- Syela
 **************************************************************************/
 void city_refresh_for_player(struct player *pplayer)
 {
+  int n = city_list_size(pplayer->cities);
+
   conn_list_do_buffer(pplayer->connections);
-  city_list_iterate(pplayer->cities, pcity) {
-    if (city_refresh(pcity)) {
-      auto_arrange_workers(pcity);
+  if (n > 0) {
+    struct city *cities[n];
+    bool radius_changed[n];
+    int i = 0;
+
+    city_list_iterate(pplayer->cities, pcity) {
+      cities[i++] = pcity;
+    } city_list_iterate_end;
+
+    city_refresh_array(cities, n, radius_changed);
+
+    for (i = 0; i < n; i++) {
+      if (radius_changed[i]) {
+        auto_arrange_workers(cities[i]);
+      }
+      send_city_info(pplayer, cities[i]);
     }
-    send_city_info(pplayer, pcity);
-  } city_list_iterate_end;
+  }
   conn_list_do_unbuffer(pplayer->connections);
 }
 
@@ -204,6 +298,10 @@ void city_refresh_queue_add(struct city *pcity)
 /**********************************************************************//**
   Refresh the listed cities.
   Called after significant changes to borders, and arranging workers.
+
+  The cities are grouped by owner and refreshed in one batch with
+  city_refresh_array(). All the city packets go out buffered, so each
+  connection gets them in a single burst at the end.
 **************************************************************************/
 void city_refresh_queue_processing(void)
 {
@@ -211,17 +309,50 @@ void city_refresh_queue_processing(void)
     return;
   }
 
-  city_list_iterate(city_refresh_queue, pcity) {
-    if (pcity->server.needs_refresh) {
-      if (city_refresh(pcity)) {
-        auto_arrange_workers(pcity);
+  conn_list_do_buffer(game.est_connections);
+
+  /* Cities may be queued again while processing; those get a new queue. */
+  while (NULL != city_refresh_queue) {
+    struct city_list *queue = city_refresh_queue;
+    int n = 0;
+
+    city_refresh_queue = NULL;
+
+    city_list_iterate(queue, pcity) {
+      if (pcity->server.needs_refresh) {
+        n++;
+      }
+    } city_list_iterate_end;
+
+    if (n > 0) {
+      struct city *cities[n];
+      bool radius_changed[n];
+      int i = 0;
+
+      /* Keep the queue order within each owner's group. */
+      players_iterate(pplayer) {
+        city_list_iterate(queue, pcity) {
+          if (pcity->server.needs_refresh && city_owner(pcity) == pplayer) {
+            cities[i++] = pcity;
+          }
+        } city_list_iterate_end;
+      } players_iterate_end;
+      fc_assert(i == n);
+
+      city_refresh_array(cities, n, radius_changed);
+
+      for (i = 0; i < n; i++) {
+        if (radius_changed[i]) {
+          auto_arrange_workers(cities[i]);
+        }
+        send_city_info(city_owner(cities[i]), cities[i]);
       }
-      send_city_info(city_owner(pcity), pcity);
     }
-  } city_list_iterate_end;
 
-  city_list_destroy(city_refresh_queue);
-  city_refresh_queue = NULL;
+    city_list_destroy(queue);
+  }
+
+  conn_list_do_unbuffer(game.est_connections);
 }
 
 /**********************************************************************//**
@@ -332,7 +463,6 @@ void auto_arrange_workers(struct city *pcity)
   city_refresh(pcity);
 
   sanity_check_city(pcity);
-  cm_clear_cache(pcity);
 
   cm_init_parameter(&cmp);
   cmp.require_happy = FALSE;
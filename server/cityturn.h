@@ -23,6 +23,8 @@ struct cm_result;
 
 bool city_refresh(struct city *pcity);          /* call if city has changed */
 void city_refresh_for_player(struct player *pplayer); /* tax/govt changed */
+void city_refresh_array(struct city **cities, int count,
+                        bool *radius_changed);
 
 void city_refresh_queue_add(struct city *pcity);
 void city_refresh_queue_processing(void);
@@ -206,8 +206,10 @@ static struct command commands[] = {
       "debug city <x> <y>\n"
       "debug units <x> <y>\n"
       "debug unit <id>\n"
+      "debug path <id> <x> <y>\n"
       "debug timing\n"
-      "debug info"),
+      "debug info\n"
+      "debug caches [reset]"),
    N_("Turn on or off AI debugging of given entity."),
    N_("Print AI debug information about given entity and turn continuous "
       "debugging output for this entity on or off."), NULL,
@@ -114,6 +114,8 @@ static bool make_island(int islemass, int starters,
 struct river_map {
   struct dbv blocked;
   struct dbv ok;
+  int *ok_tiles;       /* Indices of the tiles set in 'ok' */
+  int num_ok_tiles;
 };
 
 static int river_test_blocked(struct river_map *privermap,
@@ -795,7 +797,10 @@ static bool make_river(struct river_map *privermap, struct tile *ptile,
 
   while (TRUE) {
     /* Mark the current tile as river. */
-    dbv_set(&privermap->ok, tile_index(ptile));
+    if (!dbv_isset(&privermap->ok, tile_index(ptile))) {
+      dbv_set(&privermap->ok, tile_index(ptile));
+      privermap->ok_tiles[privermap->num_ok_tiles++] = tile_index(ptile);
+    }
     log_debug("The tile at (%d, %d) has been marked as river in river_map.",
               TILE_XY(ptile));
 
@@ -890,9 +895,21 @@ static bool make_river(struct river_map *privermap, struct tile *ptile,
   } /* end while; (Make a river.) */
 }
 
+/**********************************************************************//**
+  qsort() comparison of tile indices.
+**************************************************************************/
+static int compare_tile_index(const void *a, const void *b)
+{
+  return *(const int *) a - *(const int *) b;
+}
+
 /**********************************************************************//**
   Calls make_river until there are enough river tiles on the map. It stops
   when it has tried to create RIVERS_MAXTRIES rivers.           -Erik Sigra
+
+  Only tiles having some road extra can block a river of another type, so
+  those are kept in a list instead of scanning the whole map for every
+  river; likewise a river is applied from the list of its own tiles.
 **************************************************************************/
 static void make_rivers(void)
 {
@@ -900,6 +917,10 @@ static void make_rivers(void)
   struct terrain *pterrain;
   struct river_map rivermap;
   struct extra_type *road_river = NULL;
+  struct dbv has_road;
+  int *road_tiles;
+  int num_road_tiles = 0;
+  int i;
 
   /* Formula to make the river density similar om different sized maps. Avoids
      too few rivers on large maps and too many rivers on small maps. */
@@ -932,6 +953,20 @@ static void make_rivers(void)
 
   dbv_init(&rivermap.blocked, MAP_INDEX_SIZE);
   dbv_init(&rivermap.ok, MAP_INDEX_SIZE);
+  rivermap.ok_tiles = fc_malloc(MAP_INDEX_SIZE * sizeof(*rivermap.ok_tiles));
+  rivermap.num_ok_tiles = 0;
+
+  dbv_init(&has_road, MAP_INDEX_SIZE);
+  road_tiles = fc_malloc(MAP_INDEX_SIZE * sizeof(*road_tiles));
+  whole_map_iterate(&(wld.map), rtile) {
+    extra_type_by_cause_iterate(EC_ROAD, proad) {
+      if (tile_has_extra(rtile, proad)) {
+        dbv_set(&has_road, tile_index(rtile));
+        road_tiles[num_road_tiles++] = tile_index(rtile);
+        break;
+      }
+    } extra_type_by_cause_iterate_end;
+  } whole_map_iterate_end;
 
   /* The main loop in this function. */
   while (current_riverlength < desirable_riverlength
@@ -982,42 +1017,52 @@ static void make_rivers(void)
       /* Reset river map before making a new river. */
       dbv_clr_all(&rivermap.blocked);
       dbv_clr_all(&rivermap.ok);
+      rivermap.num_ok_tiles = 0;
 
       road_river = river_types[fc_rand(river_type_count)];
 
-      extra_type_by_cause_iterate(EC_ROAD, oriver) {
-        if (oriver != road_river) {
-          whole_map_iterate(&(wld.map), rtile) {
-            if (tile_has_extra(rtile, oriver)) {
-              dbv_set(&rivermap.blocked, tile_index(rtile));
-            }
-          } whole_map_iterate_end;
-        }
-      } extra_type_by_cause_iterate_end;
+      for (i = 0; i < num_road_tiles; i++) {
+        struct tile *rtile = index_to_tile(&(wld.map), road_tiles[i]);
+
+        extra_type_by_cause_iterate(EC_ROAD, oriver) {
+          if (oriver != road_river && tile_has_extra(rtile, oriver)) {
+            dbv_set(&rivermap.blocked, road_tiles[i]);
+            break;
+          }
+        } extra_type_by_cause_iterate_end;
+      }
 
       log_debug("Found a suitable starting tile for a river at (%d, %d)."
                 " Starting to make it.", TILE_XY(ptile));
 
       /* Try to make a river. If it is OK, apply it to the map. */
       if (make_river(&rivermap, ptile, road_river)) {
-        whole_map_iterate(&(wld.map), ptile1) {
-          if (dbv_isset(&rivermap.ok, tile_index(ptile1))) {
-            struct terrain *river_terrain = tile_terrain(ptile1);
-
-            if (!terrain_has_flag(river_terrain, TER_CAN_HAVE_RIVER)) {
-              /* We have to change the terrain to put a river here. */
-              river_terrain = pick_terrain_by_flag(TER_CAN_HAVE_RIVER);
-              if (river_terrain != NULL) {
-                tile_set_terrain(ptile1, river_terrain);
-              }
+        /* Apply in map order, as picking the terrain uses fc_rand(). */
+        qsort(rivermap.ok_tiles, rivermap.num_ok_tiles,
+              sizeof(*rivermap.ok_tiles), compare_tile_index);
+
+        for (i = 0; i < rivermap.num_ok_tiles; i++) {
+          struct tile *ptile1 = index_to_tile(&(wld.map),
+                                              rivermap.ok_tiles[i]);
+          struct terrain *river_terrain = tile_terrain(ptile1);
+
+          if (!terrain_has_flag(river_terrain, TER_CAN_HAVE_RIVER)) {
+            /* We have to change the terrain to put a river here. */
+            river_terrain = pick_terrain_by_flag(TER_CAN_HAVE_RIVER);
+            if (river_terrain != NULL) {
+              tile_set_terrain(ptile1, river_terrain);
             }
+          }
 
-            tile_add_extra(ptile1, road_river);
-            current_riverlength++;
-            map_set_placed(ptile1);
-            log_debug("Applied a river to (%d, %d).", TILE_XY(ptile1));
+          tile_add_extra(ptile1, road_river);
+          if (!dbv_isset(&has_road, rivermap.ok_tiles[i])) {
+            dbv_set(&has_road, rivermap.ok_tiles[i]);
+            road_tiles[num_road_tiles++] = rivermap.ok_tiles[i];
           }
-        } whole_map_iterate_end;
+          current_riverlength++;
+          map_set_placed(ptile1);
+          log_debug("Applied a river to (%d, %d).", TILE_XY(ptile1));
+        }
       } else {
         log_debug("mapgen.c: A river failed. It might have gotten stuck "
                   "in a helix.");
@@ -1031,6 +1076,9 @@ static void make_rivers(void)
 
   dbv_free(&rivermap.blocked);
   dbv_free(&rivermap.ok);
+  free(rivermap.ok_tiles);
+  dbv_free(&has_road);
+  free(road_tiles);
 
   destroy_placed_map();
 }
@@ -20,14 +20,17 @@
 /* utility */
 #include "log.h"
 #include "fcintl.h"
+#include "workerpool.h"
 
 /* common */
+#include "effects.h"
 #include "game.h"
 #include "map.h"
 #include "movement.h"
 
 /* server */
 #include "maphand.h"
+#include "srv_main.h"
 
 /* server/generator */
 #include "mapgen_topology.h"
@@ -115,6 +118,42 @@ static int get_tile_value(struct tile *ptile)
   return value;
 }
 
+/************************************************************************//**
+  Worker function filling in get_tile_value() for one row of the map.
+****************************************************************************/
+static void tile_value_row(int nat_y, void *data)
+{
+  int *values = data;
+  int nat_x;
+
+  for (nat_x = 0; nat_x < wld.map.xsize; nat_x++) {
+    struct tile *ptile = native_pos_to_tile(&(wld.map), nat_x, nat_y);
+
+    values[tile_index(ptile)] = get_tile_value(ptile);
+  }
+}
+
+/************************************************************************//**
+  Fill in get_tile_value() for every tile of the map. Tiles are valued
+  independently, so the rows are spread over the turn worker threads.
+****************************************************************************/
+static void get_tile_values(int *values)
+{
+  struct fc_worker_pool *workers = server_turn_workers();
+  bool threaded = (fc_worker_pool_threads(workers) > 1);
+
+  if (threaded) {
+    /* Lookups of a frozen effect cache are safe from several threads. */
+    effect_cache_freeze(TRUE);
+  }
+
+  fc_worker_pool_run(workers, wld.map.ysize, tile_value_row, values);
+
+  if (threaded) {
+    effect_cache_freeze(FALSE);
+  }
+}
+
 struct start_filter_data {
   int min_value;
   struct unit_type *initial_unit;
@@ -336,9 +375,7 @@ bool create_start_positions(enum map_startpos mode,
   tile_value = fc_calloc(MAP_INDEX_SIZE, sizeof(*tile_value));
 
   /* get the tile value */
-  whole_map_iterate(&(wld.map), value_tile) {
-    tile_value_aux[tile_index(value_tile)] = get_tile_value(value_tile);
-  } whole_map_iterate_end;
+  get_tile_values(tile_value_aux);
 
   /* select the best tiles */
   whole_map_iterate(&(wld.map), value_tile) {
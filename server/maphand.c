@@ -45,6 +45,7 @@
 #include "notify.h"
 #include "plrhand.h"
 #include "sanitycheck.h"
+#include "score.h"
 #include "sernet.h"
 #include "srv_main.h"
 #include "unithand.h"
@@ -460,6 +461,47 @@ bool send_tile_suppression(bool now)
   return formerly;
 }
 
+/**********************************************************************//**
+  Fill in the tile info fields that depend on what is seen of the tile,
+  as a viewer currently seeing it sees it. pplayer is NULL for global
+  observers.
+**************************************************************************/
+static void package_seen_tile(struct packet_tile_info *info,
+                              const struct tile *ptile,
+                              const struct player *pplayer)
+{
+  const struct player *owner = tile_owner(ptile);
+  const struct player *eowner = extra_owner(ptile);
+
+  info->known = TILE_KNOWN_SEEN;
+  info->continent = tile_continent(ptile);
+  info->owner = (owner ? player_number(owner) : MAP_TILE_OWNER_NULL);
+  info->extras_owner = (eowner ? player_number(eowner) : MAP_TILE_OWNER_NULL);
+  info->worked = (NULL != tile_worked(ptile))
+                 ? tile_worked(ptile)->id
+                 : IDENTITY_NUMBER_ZERO;
+
+  info->terrain = (NULL != tile_terrain(ptile))
+                  ? terrain_number(tile_terrain(ptile))
+                  : terrain_count();
+  info->resource = (NULL != tile_resource(ptile))
+                   ? extra_number(tile_resource(ptile))
+                   : MAX_EXTRA_TYPES;
+
+  if (pplayer != NULL) {
+    info->extras = map_get_player_tile(ptile, pplayer)->extras;
+  } else {
+    info->extras = ptile->extras;
+  }
+
+  if (ptile->label != NULL) {
+    /* Always leave final '\0' in place */
+    strncpy(info->label, ptile->label, sizeof(info->label) - 1);
+  } else {
+    info->label[0] = '\0';
+  }
+}
+
 /**********************************************************************//**
   Send tile information to all the clients in dest which know and see
   the tile. If dest is NULL, sends to all clients (game.est_connections)
@@ -474,6 +516,7 @@ void send_tile_info(struct conn_list *dest, struct tile *ptile,
   struct packet_tile_info info;
   const struct player *owner;
   const struct player *eowner;
+  struct conn_list *observers = NULL;
 
   if (dest == NULL) {
     CALL_FUNC_EACH_AI(tile_info, ptile);
@@ -502,37 +545,14 @@ void send_tile_info(struct conn_list *dest, struct tile *ptile,
       continue;
     }
 
-    if (!pplayer || map_is_known_and_seen(ptile, pplayer, V_MAIN)) {
-      info.known = TILE_KNOWN_SEEN;
-      info.continent = tile_continent(ptile);
-      owner = tile_owner(ptile);
-      eowner = extra_owner(ptile);
-      info.owner = (owner ? player_number(owner) : MAP_TILE_OWNER_NULL);
-      info.extras_owner = (eowner ? player_number(eowner) : MAP_TILE_OWNER_NULL);
-      info.worked = (NULL != tile_worked(ptile))
-                     ? tile_worked(ptile)->id
-                     : IDENTITY_NUMBER_ZERO;
-
-      info.terrain = (NULL != tile_terrain(ptile))
-                      ? terrain_number(tile_terrain(ptile))
-                      : terrain_count();
-      info.resource = (NULL != tile_resource(ptile))
-                       ? extra_number(tile_resource(ptile))
-                       : MAX_EXTRA_TYPES;
-
-      if (pplayer != NULL) {
-	info.extras = map_get_player_tile(ptile, pplayer)->extras;
-      } else {
-	info.extras = ptile->extras;
+    if (NULL == pplayer) {
+      /* Global observers all get the same info; broadcast it once below. */
+      if (NULL == observers) {
+        observers = conn_list_new();
       }
-
-      if (ptile->label != NULL) {
-        /* Always leave final '\0' in place */
-        strncpy(info.label, ptile->label, sizeof(info.label) - 1);
-      } else {
-        info.label[0] = '\0';
-      }
-
+      conn_list_append(observers, pconn);
+    } else if (map_is_known_and_seen(ptile, pplayer, V_MAIN)) {
+      package_seen_tile(&info, ptile, pplayer);
       send_packet_tile_info(pconn, &info);
     } else if (pplayer && map_is_known(ptile, pplayer)) {
       struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
@@ -541,20 +561,20 @@ void send_tile_info(struct conn_list *dest, struct tile *ptile,
       info.known = TILE_KNOWN_UNSEEN;
       info.continent = tile_continent(ptile);
       owner = (game.server.foggedborders
-               ? plrtile->owner
+               ? player_tile_owner(plrtile)
                : tile_owner(ptile));
-      eowner = plrtile->extras_owner;
+      eowner = player_tile_extras_owner(plrtile);
       info.owner = (owner ? player_number(owner) : MAP_TILE_OWNER_NULL);
       info.extras_owner = (eowner ? player_number(eowner) : MAP_TILE_OWNER_NULL);
       info.worked = (NULL != psite)
                     ? psite->identity
                     : IDENTITY_NUMBER_ZERO;
 
-      info.terrain = (NULL != plrtile->terrain)
-                      ? terrain_number(plrtile->terrain)
+      info.terrain = (0 != plrtile->terrain)
+                      ? plrtile->terrain - 1
                       : terrain_count();
-      info.resource = (NULL != plrtile->resource)
-                       ? extra_number(plrtile->resource)
+      info.resource = (0 != plrtile->resource)
+                       ? plrtile->resource - 1
                        : MAX_EXTRA_TYPES;
 
       info.extras = plrtile->extras;
@@ -585,6 +605,12 @@ void send_tile_info(struct conn_list *dest, struct tile *ptile,
     }
   }
   conn_list_iterate_end;
+
+  if (NULL != observers) {
+    package_seen_tile(&info, ptile, NULL);
+    lsend_packet_tile_info(observers, &info);
+    conn_list_destroy(observers);
+  }
 }
 
 /**********************************************************************//**
@@ -630,15 +656,45 @@ static void shared_vision_change_seen(struct player *pplayer,
 }
 
 /**********************************************************************//**
-  There doesn't have to be a city.
+  A tile got no seen count change from a vision update. It still has to be
+  revealed if it is seen but unknown, the same as map_change_seen() does
+  for a null change.
 **************************************************************************/
-void map_vision_update(struct player *pplayer, struct tile *ptile,
-                       const v_radius_t old_radius_sq,
-                       const v_radius_t new_radius_sq,
-                       bool can_reveal_tiles)
+static inline void map_reveal_seen(struct player *pplayer,
+                                   struct tile *ptile)
 {
+  static const v_radius_t no_change = V_RADIUS(0, 0, 0);
+
+  if (!map_is_known(ptile, pplayer)
+      && 0 < map_get_seen(pplayer, ptile, V_MAIN)) {
+    map_change_seen(pplayer, ptile, no_change, TRUE);
+  }
+}
+
+/**********************************************************************//**
+  Update the seen counts around 'ptile' for a vision source changing its
+  radius from 'old_radius_sq' to 'new_radius_sq'.
+
+  Only the tiles in the ring between both radii are changed, per vision
+  layer. If 'mask_tile' is set, the tiles of a layer which are within
+  'mask_radius_sq' of it are left alone too, or with 'mask_inside' only
+  those are changed. This is how linked vision sources skip the tiles
+  they share, see vision_link().
+**************************************************************************/
+static void map_vision_update_masked(struct player *pplayer,
+                                     struct tile *ptile,
+                                     const v_radius_t old_radius_sq,
+                                     const v_radius_t new_radius_sq,
+                                     bool can_reveal_tiles,
+                                     const struct tile *mask_tile,
+                                     const v_radius_t mask_radius_sq,
+                                     bool mask_inside)
+{
+  struct player *receivers[MAX_NUM_PLAYER_SLOTS];
+  int num_receivers = 0;
   v_radius_t change;
   int max_radius;
+  int i;
 
   if (old_radius_sq[V_MAIN] == new_radius_sq[V_MAIN]
       && old_radius_sq[V_INVIS] == new_radius_sq[V_INVIS]
@@ -666,22 +722,65 @@ void map_vision_update(struct player *pplayer, struct tile *ptile,
   } vision_layer_iterate_end;
 #endif /* FREECIV_DEBUG */
 
+  /* The players sharing the vision don't change during the update. */
+  players_iterate(pplayer2) {
+    if (really_gives_vision(pplayer, pplayer2)) {
+      receivers[num_receivers++] = pplayer2;
+    }
+  } players_iterate_end;
+
   buffer_shared_vision(pplayer);
   circle_dxyr_iterate(&(wld.map), ptile, max_radius, tile1, dx, dy, dr) {
+    int mask_dr = (NULL != mask_tile
+                   ? sq_map_distance(mask_tile, tile1) : 0);
+    bool changed = FALSE;
+
     vision_layer_iterate(v) {
-      if (dr > old_radius_sq[v] && dr <= new_radius_sq[v]) {
+      if (NULL != mask_tile
+          && (mask_dr <= mask_radius_sq[v]) != mask_inside) {
+        change[v] = 0;
+      } else if (dr > old_radius_sq[v] && dr <= new_radius_sq[v]) {
         change[v] = 1;
+        changed = TRUE;
       } else if (dr > new_radius_sq[v] && dr <= old_radius_sq[v]) {
         change[v] = -1;
+        changed = TRUE;
       } else {
         change[v] = 0;
       }
     } vision_layer_iterate_end;
-    shared_vision_change_seen(pplayer, tile1, change, can_reveal_tiles);
+
+    if (!changed) {
+      if (can_reveal_tiles) {
+        map_reveal_seen(pplayer, tile1);
+        for (i = 0; i < num_receivers; i++) {
+          map_reveal_seen(receivers[i], tile1);
+        }
+      }
+      continue;
+    }
+
+    map_change_own_seen(pplayer, tile1, change);
+    map_change_seen(pplayer, tile1, change, can_reveal_tiles);
+    for (i = 0; i < num_receivers; i++) {
+      map_change_seen(receivers[i], tile1, change, can_reveal_tiles);
+    }
   } circle_dxyr_iterate_end;
   unbuffer_shared_vision(pplayer);
 }
 
+/**********************************************************************//**
+  There doesn't have to be a city.
+**************************************************************************/
+void map_vision_update(struct player *pplayer, struct tile *ptile,
+                       const v_radius_t old_radius_sq,
+                       const v_radius_t new_radius_sq,
+                       bool can_reveal_tiles)
+{
+  map_vision_update_masked(pplayer, ptile, old_radius_sq, new_radius_sq,
+                           can_reveal_tiles, NULL, NULL, FALSE);
+}
+
 /**********************************************************************//**
   Turn a players ability to see inside his borders on or off.
 
@@ -869,7 +968,7 @@ static inline int map_get_seen(const struct player *pplayer,
                                const struct tile *ptile,
                                enum vision_layer vlayer)
 {
-  return map_get_player_tile(ptile, pplayer)->seen_count[vlayer];
+  return map_get_player_seen(ptile, pplayer)->seen_count[vlayer];
 }
 
 /**********************************************************************//**
@@ -883,7 +982,7 @@ void map_change_seen(struct player *pplayer,
                      const v_radius_t change,
                      bool can_reveal_tiles)
 {
-  struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+  struct player_tile_seen *plrseen = map_get_player_seen(ptile, pplayer);
   bool revealing_tile = FALSE;
 
 #ifdef FREECIV_DEBUG
@@ -892,7 +991,7 @@ void map_change_seen(struct player *pplayer,
             TILE_XY(ptile));
   vision_layer_iterate(v) {
     log_debug("  vision layer %d is changing from %d to %d.",
-              v, plrtile->seen_count[v], plrtile->seen_count[v] + change[v]);
+              v, plrseen->seen_count[v], plrseen->seen_count[v] + change[v]);
   } vision_layer_iterate_end;
 #endif /* FREECIV_DEBUG */
 
@@ -900,7 +999,7 @@ void map_change_seen(struct player *pplayer,
    * we must remove all units before fog of war because clients expect
    * the tile is empty when it is fogged. */
   if (0 > change[V_INVIS]
-      && plrtile->seen_count[V_INVIS] == -change[V_INVIS]) {
+      && plrseen->seen_count[V_INVIS] == -change[V_INVIS]) {
     log_debug("(%d, %d): hiding invisible units to player %s (nb %d).",
               TILE_XY(ptile), player_name(pplayer), player_number(pplayer));
 
@@ -912,7 +1011,7 @@ void map_change_seen(struct player *pplayer,
     } unit_list_iterate_end;
   }
   if (0 > change[V_SUBSURFACE]
-      && plrtile->seen_count[V_SUBSURFACE] == -change[V_SUBSURFACE]) {
+      && plrseen->seen_count[V_SUBSURFACE] == -change[V_SUBSURFACE]) {
     log_debug("(%d, %d): hiding subsurface units to player %s (nb %d).",
               TILE_XY(ptile), player_name(pplayer), player_number(pplayer));
 
@@ -925,7 +1024,7 @@ void map_change_seen(struct player *pplayer,
   }
 
   if (0 > change[V_MAIN]
-      && plrtile->seen_count[V_MAIN] == -change[V_MAIN]) {
+      && plrseen->seen_count[V_MAIN] == -change[V_MAIN]) {
     log_debug("(%d, %d): hiding visible units to player %s (nb %d).",
               TILE_XY(ptile), player_name(pplayer), player_number(pplayer));
 
@@ -939,8 +1038,8 @@ void map_change_seen(struct player *pplayer,
 
   vision_layer_iterate(v) {
     /* Avoid underflow. */
-    fc_assert(0 <= change[v] || -change[v] <= plrtile->seen_count[v]);
-    plrtile->seen_count[v] += change[v];
+    fc_assert(0 <= change[v] || -change[v] <= plrseen->seen_count[v]);
+    plrseen->seen_count[v] += change[v];
   } vision_layer_iterate_end;
 
   /* V_MAIN vision ranges must always be more than invisible ranges
@@ -948,13 +1047,13 @@ void map_change_seen(struct player *pplayer,
    * seen count cannot be inferior to V_INVIS or V_SUBSURFACE seen count.
    * Moreover, when the fog of war is disabled, V_MAIN has an extra
    * seen count point. */
-  fc_assert(plrtile->seen_count[V_INVIS] + !game.info.fogofwar
-            <= plrtile->seen_count[V_MAIN]);
-  fc_assert(plrtile->seen_count[V_SUBSURFACE] + !game.info.fogofwar
-            <= plrtile->seen_count[V_MAIN]);
+  fc_assert(plrseen->seen_count[V_INVIS] + !game.info.fogofwar
+            <= plrseen->seen_count[V_MAIN]);
+  fc_assert(plrseen->seen_count[V_SUBSURFACE] + !game.info.fogofwar
+            <= plrseen->seen_count[V_MAIN]);
 
   if (!map_is_known(ptile, pplayer)) {
-    if (0 < plrtile->seen_count[V_MAIN] && can_reveal_tiles) {
+    if (0 < plrseen->seen_count[V_MAIN] && can_reveal_tiles) {
       log_debug("(%d, %d): revealing tile to player %s (nb %d).",
                 TILE_XY(ptile), player_name(pplayer),
                 player_number(pplayer));
@@ -967,24 +1066,26 @@ void map_change_seen(struct player *pplayer,
   }
 
   /* Fog the tile. */
-  if (0 > change[V_MAIN] && 0 == plrtile->seen_count[V_MAIN]) {
+  if (0 > change[V_MAIN] && 0 == plrseen->seen_count[V_MAIN]) {
+    struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+
     log_debug("(%d, %d): fogging tile for player %s (nb %d).",
               TILE_XY(ptile), player_name(pplayer), player_number(pplayer));
 
     update_player_tile_last_seen(pplayer, ptile);
     if (game.server.foggedborders) {
-      plrtile->owner = tile_owner(ptile);
+      player_tile_set_owner(plrtile, tile_owner(ptile));
     }
-    plrtile->extras_owner = extra_owner(ptile);
+    player_tile_set_extras_owner(plrtile, extra_owner(ptile));
     send_tile_info(pplayer->connections, ptile, FALSE);
   }
 
-  if ((revealing_tile && 0 < plrtile->seen_count[V_MAIN])
+  if ((revealing_tile && 0 < plrseen->seen_count[V_MAIN])
       || (0 < change[V_MAIN]
-          /* plrtile->seen_count[V_MAIN] Always set to 1
+          /* plrseen->seen_count[V_MAIN] Always set to 1
             * when the fog of war is disabled. */
           && (change[V_MAIN] + !game.info.fogofwar
-              == (plrtile->seen_count[V_MAIN])))) {
+              == (plrseen->seen_count[V_MAIN])))) {
     struct city *pcity;
 
     log_debug("(%d, %d): unfogging tile for player %s (nb %d).",
@@ -1012,9 +1113,9 @@ void map_change_seen(struct player *pplayer,
     }
   }
 
-  if ((revealing_tile && 0 < plrtile->seen_count[V_INVIS])
+  if ((revealing_tile && 0 < plrseen->seen_count[V_INVIS])
       || (0 < change[V_INVIS]
-          && change[V_INVIS] == plrtile->seen_count[V_INVIS])) {
+          && change[V_INVIS] == plrseen->seen_count[V_INVIS])) {
     log_debug("(%d, %d): revealing invisible units to player %s (nb %d).",
               TILE_XY(ptile), player_name(pplayer),
               player_number(pplayer));
@@ -1025,9 +1126,9 @@ void map_change_seen(struct player *pplayer,
       }
     } unit_list_iterate_end;
   }
-  if ((revealing_tile && 0 < plrtile->seen_count[V_SUBSURFACE])
+  if ((revealing_tile && 0 < plrseen->seen_count[V_SUBSURFACE])
       || (0 < change[V_SUBSURFACE]
-          && change[V_SUBSURFACE] == plrtile->seen_count[V_SUBSURFACE])) {
+          && change[V_SUBSURFACE] == plrseen->seen_count[V_SUBSURFACE])) {
     log_debug("(%d, %d): revealing subsurface units to player %s (nb %d).",
               TILE_XY(ptile), player_name(pplayer),
               player_number(pplayer));
@@ -1050,7 +1151,7 @@ static inline int map_get_own_seen(const struct player *pplayer,
                                    const struct tile *ptile,
                                    enum vision_layer vlayer)
 {
-  return map_get_player_tile(ptile, pplayer)->own_seen[vlayer];
+  return map_get_player_seen(ptile, pplayer)->own_seen[vlayer];
 }
 
 /**********************************************************************//**
@@ -1060,10 +1161,10 @@ static void map_change_own_seen(struct player *pplayer,
                                 struct tile *ptile,
                                 const v_radius_t change)
 {
-  struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+  struct player_tile_seen *plrseen = map_get_player_seen(ptile, pplayer);
 
   vision_layer_iterate(v) {
-    plrtile->own_seen[v] += change[v];
+    plrseen->own_seen[v] += change[v];
   } vision_layer_iterate_end;
 }
 
@@ -1137,6 +1238,9 @@ void player_map_init(struct player *pplayer)
   pplayer->server.private_map
     = fc_realloc(pplayer->server.private_map,
                  MAP_INDEX_SIZE * sizeof(*pplayer->server.private_map));
+  pplayer->server.private_seen
+    = fc_realloc(pplayer->server.private_seen,
+                 MAP_INDEX_SIZE * sizeof(*pplayer->server.private_seen));
 
   whole_map_iterate(&(wld.map), ptile) {
     player_tile_init(ptile, pplayer);
@@ -1160,10 +1264,47 @@ void player_map_free(struct player *pplayer)
 
   free(pplayer->server.private_map);
   pplayer->server.private_map = NULL;
+  free(pplayer->server.private_seen);
+  pplayer->server.private_seen = NULL;
 
   dbv_free(&pplayer->tile_known);
 }
 
+/**********************************************************************//**
+  Log the memory used by the players' private maps.
+**************************************************************************/
+void player_maps_log_memory(void)
+{
+  size_t map_size = 0, seen_size = 0, known_size = 0;
+  int sites = 0, num_players = 0;
+
+  players_iterate(pplayer) {
+    if (NULL == pplayer->server.private_map) {
+      continue;
+    }
+
+    num_players++;
+    map_size += MAP_INDEX_SIZE * sizeof(*pplayer->server.private_map);
+    seen_size += MAP_INDEX_SIZE * sizeof(*pplayer->server.private_seen);
+    known_size += (MAP_INDEX_SIZE + 7) / 8;
+    whole_map_iterate(&(wld.map), ptile) {
+      if (NULL != map_get_player_site(ptile, pplayer)) {
+        sites++;
+      }
+    } whole_map_iterate_end;
+  } players_iterate_end;
+
+  log_verbose("Player maps of %d players: %lu kB knowledge (%d bytes "
+              "per tile), %lu kB seen counts (%d bytes per tile), "
+              "%lu kB known tiles, %d vision sites (%lu kB).",
+              num_players, (unsigned long) (map_size / 1024),
+              (int) sizeof(struct player_tile),
+              (unsigned long) (seen_size / 1024),
+              (int) sizeof(struct player_tile_seen),
+              (unsigned long) (known_size / 1024), sites,
+              (unsigned long) (sites * sizeof(struct vision_site) / 1024));
+}
+
 /**********************************************************************//**
   Remove all knowledge of a player from main map and other players'
   private maps, and send updates to connected clients.
@@ -1195,12 +1336,12 @@ void remove_player_from_maps(struct player *pplayer)
       }
 
       /* Remove references to player from others' maps */
-      if (aplrtile->owner == pplayer) {
-        aplrtile->owner = NULL;
+      if (player_tile_owner(aplrtile) == pplayer) {
+        player_tile_set_owner(aplrtile, NULL);
         changed = TRUE;
       }
-      if (aplrtile->extras_owner == pplayer) {
-        aplrtile->extras_owner = NULL;
+      if (player_tile_extras_owner(aplrtile) == pplayer) {
+        player_tile_set_extras_owner(aplrtile, NULL);
         changed = TRUE;
       }
 
@@ -1220,6 +1361,7 @@ void remove_player_from_maps(struct player *pplayer)
     /* Free all claimed tiles. */
     if (tile_owner(ptile) == pplayer) {
       tile_set_owner(ptile, NULL, NULL);
+      score_tile_changed(ptile);
       reality_changed = TRUE;
     }
     if (extra_owner(ptile) == pplayer) {
@@ -1242,11 +1384,12 @@ void remove_player_from_maps(struct player *pplayer)
 static void player_tile_init(struct tile *ptile, struct player *pplayer)
 {
   struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+  struct player_tile_seen *plrseen = map_get_player_seen(ptile, pplayer);
 
-  plrtile->terrain = T_UNKNOWN;
-  plrtile->resource = NULL;
-  plrtile->owner = NULL;
-  plrtile->extras_owner = NULL;
+  player_tile_set_terrain(plrtile, T_UNKNOWN);
+  player_tile_set_resource(plrtile, NULL);
+  player_tile_set_owner(plrtile, NULL);
+  player_tile_set_extras_owner(plrtile, NULL);
   plrtile->site = NULL;
   BV_CLR_ALL(plrtile->extras);
   if (!game.server.last_updated_year) {
@@ -1255,10 +1398,10 @@ static void player_tile_init(struct tile *ptile, struct player *pplayer)
     plrtile->last_updated = game.info.year;
   }
 
-  plrtile->seen_count[V_MAIN] = !game.server.fogofwar_old;
-  plrtile->seen_count[V_INVIS] = 0;
-  plrtile->seen_count[V_SUBSURFACE] = 0;
-  memcpy(plrtile->own_seen, plrtile->seen_count, sizeof(v_radius_t));
+  plrseen->seen_count[V_MAIN] = !game.server.fogofwar_old;
+  plrseen->seen_count[V_INVIS] = 0;
+  plrseen->seen_count[V_SUBSURFACE] = 0;
+  memcpy(plrseen->own_seen, plrseen->seen_count, sizeof(v_radius_t));
 }
 
 /**********************************************************************//**
@@ -1308,6 +1451,17 @@ struct player_tile *map_get_player_tile(const struct tile *ptile,
   return pplayer->server.private_map + tile_index(ptile);
 }
 
+/**********************************************************************//**
+  Returns the seen counts of the given tile for the player.
+**************************************************************************/
+struct player_tile_seen *map_get_player_seen(const struct tile *ptile,
+                                             const struct player *pplayer)
+{
+  fc_assert_ret_val(pplayer->server.private_seen, NULL);
+
+  return pplayer->server.private_seen + tile_index(ptile);
+}
+
 /**********************************************************************//**
   Give pplayer the correct knowledge about tile; return TRUE iff
   knowledge changed.
@@ -1321,16 +1475,20 @@ bool update_player_tile_knowledge(struct player *pplayer, struct tile *ptile)
   struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
   bool plrtile_owner_valid = game.server.foggedborders
                              && !map_is_known_and_seen(ptile, pplayer, V_MAIN);
-  struct player *owner = plrtile_owner_valid
-                         ? plrtile->owner
-                         : tile_owner(ptile);
+  struct player_tile real;
+
+  /* Compare in the packed form of the player map. */
+  player_tile_set_terrain(&real, ptile->terrain);
+  player_tile_set_resource(&real, ptile->resource);
+  player_tile_set_owner(&real, tile_owner(ptile));
+  player_tile_set_extras_owner(&real, extra_owner(ptile));
 
-  if (plrtile->terrain != ptile->terrain
+  if (plrtile->terrain != real.terrain
       || !BV_ARE_EQUAL(plrtile->extras, ptile->extras)
-      || plrtile->resource != ptile->resource
-      || owner != tile_owner(ptile)
-      || plrtile->extras_owner != extra_owner(ptile)) {
-    plrtile->terrain = ptile->terrain;
+      || plrtile->resource != real.resource
+      || (plrtile_owner_valid && plrtile->owner != real.owner)
+      || plrtile->extras_owner != real.extras_owner) {
+    plrtile->terrain = real.terrain;
     extra_type_iterate(pextra) {
       if (player_knows_extra_exist(pplayer, pextra, ptile)) {
 	BV_SET(plrtile->extras, extra_number(pextra));
@@ -1338,11 +1496,11 @@ bool update_player_tile_knowledge(struct player *pplayer, struct tile *ptile)
 	BV_CLR(plrtile->extras, extra_number(pextra));
       }
     } extra_type_iterate_end;
-    plrtile->resource = ptile->resource;
+    plrtile->resource = real.resource;
     if (plrtile_owner_valid) {
-      plrtile->owner = tile_owner(ptile);
+      plrtile->owner = real.owner;
     }
-    plrtile->extras_owner = extra_owner(ptile);
+    plrtile->extras_owner = real.extras_owner;
 
     return TRUE;
   }
@@ -1851,6 +2009,8 @@ void check_terrain_change(struct tile *ptile, struct terrain *oldter)
   struct terrain *newter = tile_terrain(ptile);
   struct tile *claimer;
 
+  score_tile_changed(ptile);
+
   /* Check if new terrain is a freshwater terrain next to non-freshwater.
    * In that case, the new terrain is *changed*. */
   if (is_ocean(newter) && terrain_has_flag(newter, TER_FRESHWATER)) {
@@ -2015,6 +2175,7 @@ static void map_claim_border_ownership(struct tile *ptile,
   }
 
   tile_set_owner(ptile, powner, psource);
+  score_tile_changed(ptile);
 
   /* Needed only when foggedborders enabled, but we do it unconditionally
    * in case foggedborders ever gets enabled later. Better to have correct
@@ -2326,6 +2487,19 @@ void map_claim_base(struct tile *ptile, struct extra_type *pextra,
   }
 }
 
+/**********************************************************************//**
+  Whether a vision source with this radius may be linked to another one.
+  The circles of linked sources must not wrap around the map onto
+  themselves, else the tiles they share would not be counted right.
+**************************************************************************/
+static bool vision_link_radius_ok(const v_radius_t radius_sq)
+{
+  int size = MIN(wld.map.xsize, wld.map.ysize);
+
+  /* The radius is at most a quarter of the smaller map dimension. */
+  return radius_sq[V_MAIN] * 16 < size * size;
+}
+
 /**********************************************************************//**
   Change the sight points for the vision source, fogging or unfogging tiles
   as needed.
@@ -2334,9 +2508,64 @@ void map_claim_base(struct tile *ptile, struct extra_type *pextra,
 **************************************************************************/
 void vision_change_sight(struct vision *vision, const v_radius_t radius_sq)
 {
-  map_vision_update(vision->player, vision->tile, vision->radius_sq,
-                    radius_sq, vision->can_reveal_tiles);
+  struct vision *linked = vision->linked;
+
+  if (NULL != linked && !vision_link_radius_ok(radius_sq)) {
+    /* Count the tiles shared with the linked source for this one again,
+     * and go on without the link. */
+    const v_radius_t no_radius_sq = V_RADIUS(-1, -1, -1);
+
+    map_vision_update_masked(vision->player, vision->tile, no_radius_sq,
+                             vision->radius_sq, vision->can_reveal_tiles,
+                             linked->tile, linked->radius_sq, TRUE);
+    vision_unlink(vision);
+    linked = NULL;
+  }
+
+  if (NULL != linked) {
+    map_vision_update_masked(vision->player, vision->tile,
+                             vision->radius_sq, radius_sq,
+                             vision->can_reveal_tiles,
+                             linked->tile, linked->radius_sq, FALSE);
+  } else {
+    map_vision_update(vision->player, vision->tile, vision->radius_sq,
+                      radius_sq, vision->can_reveal_tiles);
+  }
   memcpy(vision->radius_sq, radius_sq, sizeof(v_radius_t));
+
+  if (NULL != linked && 0 > radius_sq[V_MAIN]) {
+    /* Nothing left to share. */
+    vision_unlink(vision);
+  }
+}
+
+/**********************************************************************//**
+  Link the vision source 'new_vision' to 'old_vision', which it replaces.
+  'new_vision' must not have any sight points yet. Nothing is done unless
+  both have the same owner and can_reveal_tiles setting and neither is
+  linked already.
+
+  While they are linked, the tiles seen by both sources only count once,
+  so that a unit moving by a tile doesn't add and remove the seen count
+  of all the tiles it sees from both positions. The link is undone when
+  either source's sight is cleared.
+
+  See documentation in vision.h.
+**************************************************************************/
+void vision_link(struct vision *new_vision, struct vision *old_vision)
+{
+  fc_assert_ret(0 > new_vision->radius_sq[V_MAIN]);
+
+  if (new_vision->player != old_vision->player
+      || new_vision->can_reveal_tiles != old_vision->can_reveal_tiles
+      || NULL != new_vision->linked || NULL != old_vision->linked
+      || 0 > old_vision->radius_sq[V_MAIN]
+      || !vision_link_radius_ok(old_vision->radius_sq)) {
+    return;
+  }
+
+  new_vision->linked = old_vision;
+  old_vision->linked = new_vision;
 }
 
 /**********************************************************************//**
@@ -15,8 +15,10 @@
 
 #include "fc_types.h"
 
+#include "extras.h"
 #include "map.h"
 #include "packets.h"
+#include "player.h"
 #include "terrain.h"
 #include "vision.h"
 
@@ -26,23 +28,109 @@ struct section_file;
 struct conn_list;
 
 
+/* A player's knowledge of a tile. The terrain, resource and owners are
+ * kept as numbers (0 for none, else the number + 1) to keep the per
+ * player map small; use the player_tile_*() functions to access them. */
 struct player_tile {
   struct vision_site *site;		/* NULL for no vision site */
-  struct extra_type *resource;          /* NULL for no resource */
-  struct terrain *terrain;		/* NULL for unknown tiles */
-  struct player *owner; 		/* NULL for unowned */
-  struct player *extras_owner;
   bv_extras extras;
+  short last_updated;
+  unsigned char terrain;		/* 0 for unknown tiles */
+  unsigned char resource;		/* 0 for no resource */
+  unsigned short owner;			/* 0 for unowned */
+  unsigned short extras_owner;
+};
 
+/* The seen counts of a tile for a player. They are changed by every
+ * vision update, so they are kept apart from the rest of the knowledge
+ * in pplayer->server.private_seen. */
+struct player_tile_seen {
   /* If you build a city with an unknown square within city radius
      the square stays unknown. However, we still have to keep count
      of the seen points, so they are kept in here. When the tile
      then becomes known they are moved to seen. */
   v_radius_t own_seen;
   v_radius_t seen_count;
-  short last_updated;
 };
 
+/**********************************************************************//**
+  Return the terrain the player knows for the tile.
+**************************************************************************/
+static inline struct terrain *
+player_tile_terrain(const struct player_tile *plrtile)
+{
+  return (0 == plrtile->terrain
+          ? T_UNKNOWN : terrain_by_number(plrtile->terrain - 1));
+}
+
+/**********************************************************************//**
+  Set the terrain the player knows for the tile.
+**************************************************************************/
+static inline void player_tile_set_terrain(struct player_tile *plrtile,
+                                           const struct terrain *pterrain)
+{
+  plrtile->terrain = (T_UNKNOWN == pterrain
+                      ? 0 : terrain_number(pterrain) + 1);
+}
+
+/**********************************************************************//**
+  Return the resource the player knows for the tile.
+**************************************************************************/
+static inline struct extra_type *
+player_tile_resource(const struct player_tile *plrtile)
+{
+  return (0 == plrtile->resource
+          ? NULL : extra_by_number(plrtile->resource - 1));
+}
+
+/**********************************************************************//**
+  Set the resource the player knows for the tile.
+**************************************************************************/
+static inline void player_tile_set_resource(struct player_tile *plrtile,
+                                            const struct extra_type *pextra)
+{
+  plrtile->resource = (NULL == pextra ? 0 : extra_number(pextra) + 1);
+}
+
+/**********************************************************************//**
+  Return the owner the player knows for the tile.
+**************************************************************************/
+static inline struct player *
+player_tile_owner(const struct player_tile *plrtile)
+{
+  return (0 == plrtile->owner
+          ? NULL : player_by_number(plrtile->owner - 1));
+}
+
+/**********************************************************************//**
+  Set the owner the player knows for the tile.
+**************************************************************************/
+static inline void player_tile_set_owner(struct player_tile *plrtile,
+                                         const struct player *powner)
+{
+  plrtile->owner = (NULL == powner ? 0 : player_number(powner) + 1);
+}
+
+/**********************************************************************//**
+  Return the extras owner the player knows for the tile.
+**************************************************************************/
+static inline struct player *
+player_tile_extras_owner(const struct player_tile *plrtile)
+{
+  return (0 == plrtile->extras_owner
+          ? NULL : player_by_number(plrtile->extras_owner - 1));
+}
+
+/**********************************************************************//**
+  Set the extras owner the player knows for the tile.
+**************************************************************************/
+static inline void
+player_tile_set_extras_owner(struct player_tile *plrtile,
+                             const struct player *powner)
+{
+  plrtile->extras_owner = (NULL == powner ? 0 : player_number(powner) + 1);
+}
+
 void global_warming(int effect);
 void nuclear_winter(int effect);
 void climate_change(bool warming, int effect);
@@ -84,6 +172,7 @@ void show_map_to_all(void);
 
 void player_map_init(struct player *pplayer);
 void player_map_free(struct player *pplayer);
+void player_maps_log_memory(void);
 void remove_player_from_maps(struct player *pplayer);
 
 struct vision_site *map_get_player_city(const struct tile *ptile,
@@ -92,6 +181,8 @@ struct vision_site *map_get_player_site(const struct tile *ptile,
 					const struct player *pplayer);
 struct player_tile *map_get_player_tile(const struct tile *ptile,
 					const struct player *pplayer);
+struct player_tile_seen *map_get_player_seen(const struct tile *ptile,
+                                             const struct player *pplayer);
 bool update_player_tile_knowledge(struct player *pplayer,struct tile *ptile);
 void update_tile_knowledge(struct tile *ptile);
 void update_player_tile_last_seen(struct player *pplayer, struct tile *ptile);
@@ -130,6 +221,7 @@ void bounce_units_on_terrain_change(struct tile *ptile);
 void vision_change_sight(struct vision *vision,
                          const v_radius_t radius_sq);
 void vision_clear_sight(struct vision *vision);
+void vision_link(struct vision *new_vision, struct vision *old_vision);
 
 void change_playertile_site(struct player_tile *ptile,
                             struct vision_site *new_site);
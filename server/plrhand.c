@@ -30,6 +30,7 @@
 #include "citizens.h"
 #include "culture.h"
 #include "diptreaty.h"
+#include "effects.h"
 #include "government.h"
 #include "map.h"
 #include "movement.h"
@@ -128,6 +129,7 @@ void kill_player(struct player *pplayer)
   struct player *barbarians = NULL;
 
   pplayer->is_alive = FALSE;
+  effect_cache_flush();
 
   /* reset player status */
   player_status_reset(pplayer);
@@ -1387,6 +1389,7 @@ void server_player_init(struct player *pplayer, bool initmap,
 
   player_map_free(pplayer);
   pplayer->server.private_map = NULL;
+  pplayer->server.private_seen = NULL;
 
   if (initmap) {
     player_map_init(pplayer);
@@ -1685,6 +1688,8 @@ struct player *server_create_player(int player_id, const char *ai_tname,
     player_set_color(pplayer, prgbcolor);
   } /* else caller must ensure a color is assigned if game has started */
 
+  effect_cache_flush();
+
   return pplayer;
 }
 
@@ -1783,6 +1788,7 @@ void server_remove_player(struct player *pplayer)
   ai_traits_close(pplayer);
   adv_data_close(pplayer);
   player_destroy(pplayer);
+  effect_cache_flush();
 
   send_updated_vote_totals(NULL);
   /* must be called after the player was destroyed */
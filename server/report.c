@@ -45,6 +45,7 @@
 #include "citytools.h"
 #include "plrhand.h"
 #include "score.h"
+#include "scorelog.h"
 #include "srv_main.h"
 
 #include "report.h"
@@ -55,10 +56,25 @@ struct plrdata_slot {
   char *name;
 };
 
+/* A growing byte buffer used to assemble the records of the binary
+ * scorelog. */
+struct score_buf {
+  unsigned char *data;
+  size_t len;
+  size_t alloc;
+};
+
 struct logging_civ_score {
   FILE *fp;
   int last_turn;
   struct plrdata_slot *plrdata;
+  enum scorelog_format format;
+
+  /* Only used by the binary format. */
+  long index_pos;           /* offset of the last index block */
+  int index_count;          /* used entries in the last index block */
+  struct score_buf events;  /* player events of the current turn */
+  int num_events;
 };
 
 /* Have to be initialized to value less than -1 so it doesn't seem like report was created at
@@ -1112,6 +1128,49 @@ static void plrdata_slot_free(struct plrdata_slot *plrdata)
   }
 }
 
+/* Add new tags only at end of this list. Maintaining the order of
+ * old tags is critical. */
+static const struct {
+  char *name;
+  int (*get_value) (const struct player *);
+} score_tags[] = {
+  {"pop",             get_pop},
+  {"bnp",             get_economics},
+  {"mfg",             get_production},
+  {"cities",          get_cities},
+  {"techs",           get_techs},
+  {"munits",          get_munits},
+  {"settlers",        get_settlers},  /* "original" tags end here */
+
+  {"wonders",         get_wonders},
+  {"techout",         get_techout},
+  {"landarea",        get_landarea},
+  {"settledarea",     get_settledarea},
+  {"pollution",       get_pollution},
+  {"literacy",        get_literacy2},
+  {"spaceship",       get_spaceship}, /* new 1.8.2 tags end here */
+
+  {"gold",            get_gold},
+  {"taxrate",         get_taxrate},
+  {"scirate",         get_scirate},
+  {"luxrate",         get_luxrate},
+  {"riots",           get_riots},
+  {"happypop",        get_happypop},
+  {"contentpop",      get_contentpop},
+  {"unhappypop",      get_unhappypop},
+  {"specialists",     get_specialists},
+  {"gov",             get_gov},
+  {"corruption",      get_corruption}, /* new 1.11.5 tags end here */
+
+  {"score",           get_total_score}, /* New 2.1.10 tag end here. */
+
+  {"unitsbuilt",      get_units_built}, /* New tags since 2.3.0. */
+  {"unitskilled",     get_units_killed},
+  {"unitslost",       get_units_lost},
+
+  {"culture",         get_culture}      /* New tag in 2.6.0. */
+};
+
 /**********************************************************************//**
   Reads the whole file denoted by fp. Sets last_turn and id to the
   values contained in the file. Returns the player_names indexed by
@@ -1262,6 +1321,463 @@ static bool scan_score_log(char *id)
   return TRUE;
 }
 
+/**********************************************************************//**
+  Append 'len' bytes to the buffer.
+**************************************************************************/
+static void score_buf_add(struct score_buf *buf, const void *data,
+                          size_t len)
+{
+  if (buf->len + len > buf->alloc) {
+    buf->alloc = MAX(2 * buf->alloc, buf->len + len);
+    buf->alloc = MAX(buf->alloc, 256);
+    buf->data = fc_realloc(buf->data, buf->alloc);
+  }
+
+  memcpy(buf->data + buf->len, data, len);
+  buf->len += len;
+}
+
+/**********************************************************************//**
+  Append a 16 bit value to the buffer.
+**************************************************************************/
+static void score_buf_add_u16(struct score_buf *buf, unsigned int val)
+{
+  unsigned char bytes[2];
+
+  scorelog_put_u16(bytes, val);
+  score_buf_add(buf, bytes, sizeof(bytes));
+}
+
+/**********************************************************************//**
+  Append a 32 bit value to the buffer.
+**************************************************************************/
+static void score_buf_add_u32(struct score_buf *buf, unsigned long val)
+{
+  unsigned char bytes[4];
+
+  scorelog_put_u32(bytes, val);
+  score_buf_add(buf, bytes, sizeof(bytes));
+}
+
+/**********************************************************************//**
+  Append a string with its length to the buffer. Longer strings than 255
+  bytes are cut.
+**************************************************************************/
+static void score_buf_add_str(struct score_buf *buf, const char *str)
+{
+  unsigned char len = MIN(strlen(str), 255);
+
+  score_buf_add(buf, &len, 1);
+  score_buf_add(buf, str, len);
+}
+
+/**********************************************************************//**
+  Read 'len' bytes at offset 'pos' of the binary scorelog.
+**************************************************************************/
+static bool score_log_read(long pos, unsigned char *data, size_t len)
+{
+  return fseek(score_log->fp, pos, SEEK_SET) == 0
+         && fread(data, 1, len, score_log->fp) == len;
+}
+
+/**********************************************************************//**
+  Write 'len' bytes at offset 'pos' of the binary scorelog.
+**************************************************************************/
+static bool score_log_write(long pos, const unsigned char *data, size_t len)
+{
+  return fseek(score_log->fp, pos, SEEK_SET) == 0
+         && fwrite(data, 1, len, score_log->fp) == len;
+}
+
+/**********************************************************************//**
+  Read a string with its length at offset '*pos' of the binary scorelog
+  and advance '*pos' behind it.
+**************************************************************************/
+static bool score_log_read_str(long *pos, char *str, size_t str_len)
+{
+  unsigned char len;
+  char buf[256];
+
+  if (!score_log_read(*pos, &len, 1)
+      || (len > 0 && fread(buf, 1, len, score_log->fp) != len)) {
+    return FALSE;
+  }
+  buf[len] = '\0';
+  fc_strlcpy(str, buf, str_len);
+  *pos += 1 + len;
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Write an empty index block at the end of the binary scorelog. Returns
+  its offset or -1 on error.
+**************************************************************************/
+static long score_log_bin_new_index(void)
+{
+  unsigned char index[SCORELOG_INDEX_SIZE];
+  long pos;
+
+  memset(index, 0, sizeof(index));
+  memcpy(index, SCORELOG_INDEX_MAGIC, 4);
+
+  if (fseek(score_log->fp, 0, SEEK_END) != 0
+      || (pos = ftell(score_log->fp)) < 0
+      || fwrite(index, 1, sizeof(index), score_log->fp) != sizeof(index)) {
+    return -1;
+  }
+
+  return pos;
+}
+
+/**********************************************************************//**
+  Write the header and the first index block of a new binary scorelog.
+**************************************************************************/
+static bool score_log_bin_create(void)
+{
+  struct score_buf header = { NULL, 0, 0 };
+  bool ret;
+  int i;
+
+  score_buf_add(&header, SCORELOG_MAGIC, SCORELOG_MAGIC_LEN);
+  score_buf_add_str(&header, VERSION_STRING);
+  /* Offset of the first index block; filled in below. */
+  score_buf_add_u32(&header, 0);
+  score_buf_add_str(&header, server.game_identifier);
+  score_buf_add_u16(&header, ARRAY_SIZE(score_tags));
+  for (i = 0; i < ARRAY_SIZE(score_tags); i++) {
+    score_buf_add_str(&header, score_tags[i].name);
+  }
+  scorelog_put_u32(header.data + SCORELOG_MAGIC_LEN + 1
+                   + strlen(VERSION_STRING), header.len);
+
+  ret = score_log_write(0, header.data, header.len);
+  free(header.data);
+
+  score_log->index_pos = ret ? score_log_bin_new_index() : -1;
+  score_log->index_count = 0;
+  score_log->last_turn = -1;
+
+  return score_log->index_pos >= 0;
+}
+
+/**********************************************************************//**
+  Binary version of scan_score_log(). Reads the header and follows the
+  index to the last turn; only the headers and the player events of the
+  turn blocks are read.
+
+  Returns TRUE iff the file had read successfully.
+**************************************************************************/
+static bool scan_score_log_bin(char *id)
+{
+  unsigned char buf[SCORELOG_INDEX_SIZE];
+  char name[MAX_LEN_NAME];
+  long pos, index_pos, min_pos, file_size;
+  int i, j, num_tags, num_events, count, plr_no;
+  struct plrdata_slot *plrdata;
+
+  fc_assert_ret_val(score_log != NULL, FALSE);
+  fc_assert_ret_val(score_log->fp != NULL, FALSE);
+
+  score_log->last_turn = -1;
+  id[0] = '\0';
+
+  if (!score_log_read(0, buf, SCORELOG_MAGIC_LEN)
+      || memcmp(buf, SCORELOG_MAGIC, SCORELOG_MAGIC_LEN) != 0) {
+    log_error("[%s] Bad file magic!", game.server.scorefile);
+    return FALSE;
+  }
+
+  /* Version string, index offset, id and tags. */
+  pos = SCORELOG_MAGIC_LEN;
+  if (!score_log_read_str(&pos, name, sizeof(name))
+      || !score_log_read(pos, buf, 4)) {
+    log_error("[%s] Can't read scorelog file header!",
+              game.server.scorefile);
+    return FALSE;
+  }
+  index_pos = scorelog_get_u32(buf);
+  pos += 4;
+
+  if (!score_log_read_str(&pos, id, MAX_LEN_GAME_IDENTIFIER)
+      || !score_log_read(pos, buf, 2)) {
+    log_error("[%s] Can't read scorelog file header!",
+              game.server.scorefile);
+    return FALSE;
+  }
+  if (strcmp(id, server.game_identifier) != 0) {
+    log_error("[%s] IDs don't match! game='%s' scorelog='%s'",
+              game.server.scorefile, server.game_identifier, id);
+    return FALSE;
+  }
+
+  num_tags = scorelog_get_u16(buf);
+  pos += 2;
+  if (num_tags != ARRAY_SIZE(score_tags)) {
+    log_error("[%s] Scorelog has %d tags instead of %d!",
+              game.server.scorefile, num_tags,
+              (int) ARRAY_SIZE(score_tags));
+    return FALSE;
+  }
+  for (i = 0; i < num_tags; i++) {
+    if (!score_log_read_str(&pos, name, sizeof(name))
+        || strcmp(name, score_tags[i].name) != 0) {
+      log_error("[%s] Tag %d doesn't match!", game.server.scorefile, i);
+      return FALSE;
+    }
+  }
+
+  if (fseek(score_log->fp, 0, SEEK_END) != 0
+      || (file_size = ftell(score_log->fp)) < 0) {
+    log_error("[%s] Can't get the size of the scorelog file!",
+              game.server.scorefile);
+    return FALSE;
+  }
+  min_pos = pos;
+
+  /* Follow the index. Index blocks are always appended to the file, so
+   * each one lies behind the previous one. */
+  while (index_pos != 0) {
+    if (index_pos < min_pos || index_pos > file_size - SCORELOG_INDEX_SIZE
+        || !score_log_read(index_pos, buf, SCORELOG_INDEX_SIZE)
+        || memcmp(buf, SCORELOG_INDEX_MAGIC, 4) != 0) {
+      log_error("[%s] Bad index block at %ld!", game.server.scorefile,
+                index_pos);
+      return FALSE;
+    }
+
+    if (scorelog_get_u32(buf + 8) > SCORELOG_INDEX_ENTRIES) {
+      log_error("[%s] Index block at %ld has %lu entries!",
+                game.server.scorefile, index_pos, scorelog_get_u32(buf + 8));
+      return FALSE;
+    }
+
+    score_log->index_pos = index_pos;
+    score_log->index_count = count = scorelog_get_u32(buf + 8);
+    min_pos = index_pos + SCORELOG_INDEX_SIZE;
+    index_pos = scorelog_get_u32(buf + 4);
+
+    for (i = 0; i < count; i++) {
+      const unsigned char *entry = buf + SCORELOG_INDEX_HEADER_SIZE
+                                   + i * SCORELOG_INDEX_ENTRY_SIZE;
+      unsigned char block[SCORELOG_TURN_HEADER_SIZE];
+      unsigned char event[7];
+      int turn = scorelog_get_s32(entry);
+
+      pos = scorelog_get_u32(entry + 4);
+      if (!score_log_read(pos, block, sizeof(block))
+          || memcmp(block, SCORELOG_TURN_MAGIC, 4) != 0
+          || scorelog_get_s32(block + 4) != turn) {
+        log_error("[%s] Bad block for turn %d!", game.server.scorefile,
+                  turn);
+        return FALSE;
+      }
+
+      if (turn < score_log->last_turn) {
+        log_error("[%s] Turn %d comes after turn %d!",
+                  game.server.scorefile, turn, score_log->last_turn);
+        return FALSE;
+      }
+      score_log->last_turn = turn;
+
+      /* Skip the calendar text. */
+      num_events = scorelog_get_u16(block + 18);
+      pos += SCORELOG_TURN_HEADER_SIZE;
+      if (!score_log_read_str(&pos, name, sizeof(name))) {
+        return FALSE;
+      }
+
+      for (j = 0; j < num_events; j++) {
+        if (!score_log_read(pos, event, sizeof(event))) {
+          return FALSE;
+        }
+        pos += sizeof(event);
+        if (!score_log_read_str(&pos, name, sizeof(name))) {
+          return FALSE;
+        }
+
+        plr_no = scorelog_get_u16(event + 5);
+        if (plr_no >= player_slot_count()) {
+          log_error("[%s] Invalid player number: %d!",
+                    game.server.scorefile, plr_no);
+          return FALSE;
+        }
+        plrdata = score_log->plrdata + plr_no;
+
+        if (event[0] == SCORELOG_ADDPLAYER) {
+          if (plrdata->name != NULL) {
+            log_error("[%s] Two names for one player (id %d)!",
+                      game.server.scorefile, plr_no);
+            return FALSE;
+          }
+          plrdata_slot_init(plrdata, name);
+        } else if (event[0] == SCORELOG_DELPLAYER) {
+          if (plrdata->name == NULL) {
+            log_error("[%s] Trying to remove undefined player (id %d)!",
+                      game.server.scorefile, plr_no);
+            return FALSE;
+          }
+          plrdata_slot_free(plrdata);
+        } else {
+          log_error("[%s] Bad event type %d!", game.server.scorefile,
+                    event[0]);
+          return FALSE;
+        }
+      }
+    }
+  }
+
+  if (score_log->last_turn == -1) {
+    log_error("[%s:-] Scorelog contains no turn!", game.server.scorefile);
+    return FALSE;
+  }
+
+  if (score_log->last_turn + 1 != game.info.turn) {
+    log_error("[%s:-] Scorelog doesn't match savegame!",
+              game.server.scorefile);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Log that the player was added to the scorelog in this turn.
+**************************************************************************/
+static void score_log_addplayer(const struct player *pplayer)
+{
+  if (score_log->format == SLF_BINARY) {
+    unsigned char event[7];
+
+    event[0] = SCORELOG_ADDPLAYER;
+    scorelog_put_u32(event + 1, game.info.turn);
+    scorelog_put_u16(event + 5, player_number(pplayer));
+    score_buf_add(&score_log->events, event, sizeof(event));
+    score_buf_add_str(&score_log->events, player_name(pplayer));
+    score_log->num_events++;
+  } else {
+    fprintf(score_log->fp, "addplayer %d %d %s\n", game.info.turn,
+            player_number(pplayer), player_name(pplayer));
+  }
+}
+
+/**********************************************************************//**
+  Log that the player was removed from the scorelog after the last turn.
+**************************************************************************/
+static void score_log_delplayer(const struct player *pplayer)
+{
+  if (score_log->format == SLF_BINARY) {
+    unsigned char event[7];
+
+    event[0] = SCORELOG_DELPLAYER;
+    scorelog_put_u32(event + 1, game.info.turn - 1);
+    scorelog_put_u16(event + 5, player_number(pplayer));
+    score_buf_add(&score_log->events, event, sizeof(event));
+    score_buf_add_str(&score_log->events, "");
+    score_log->num_events++;
+  } else {
+    fprintf(score_log->fp, "delplayer %d %d\n", game.info.turn - 1,
+            player_number(pplayer));
+  }
+}
+
+/**********************************************************************//**
+  Append the block for this turn to the binary scorelog and add it to the
+  index.
+**************************************************************************/
+static bool score_log_bin_turn(void)
+{
+  struct score_buf block = { NULL, 0, 0 };
+  unsigned char entry[SCORELOG_INDEX_ENTRY_SIZE];
+  unsigned char count[4];
+  int num_players = 0;
+  long pos;
+  int i;
+  bool ret;
+
+  players_iterate(pplayer) {
+    if (GOOD_PLAYER(pplayer)
+        && !(game.server.scoreloglevel == SL_HUMANS && is_ai(pplayer))) {
+      num_players++;
+    }
+  } players_iterate_end;
+
+  score_buf_add(&block, SCORELOG_TURN_MAGIC, 4);
+  score_buf_add_u32(&block, game.info.turn);
+  score_buf_add_u32(&block, game.info.year);
+  /* Offset of the columns; filled in below. */
+  score_buf_add_u32(&block, 0);
+  score_buf_add_u16(&block, num_players);
+  score_buf_add_u16(&block, score_log->num_events);
+  score_buf_add_str(&block, calendar_text());
+  if (score_log->events.len > 0) {
+    score_buf_add(&block, score_log->events.data, score_log->events.len);
+  }
+
+  players_iterate(pplayer) {
+    if (GOOD_PLAYER(pplayer)
+        && !(game.server.scoreloglevel == SL_HUMANS && is_ai(pplayer))) {
+      score_buf_add_u16(&block, player_number(pplayer));
+    }
+  } players_iterate_end;
+
+  scorelog_put_u32(block.data + 12, block.len);
+
+  /* One column for each tag. */
+  for (i = 0; i < ARRAY_SIZE(score_tags); i++) {
+    players_iterate(pplayer) {
+      if (GOOD_PLAYER(pplayer)
+          && !(game.server.scoreloglevel == SL_HUMANS && is_ai(pplayer))) {
+        score_buf_add_u32(&block, score_tags[i].get_value(pplayer));
+      }
+    } players_iterate_end;
+  }
+
+  /* Write the block first so that the index never points behind the end
+   * of the file. */
+  ret = fseek(score_log->fp, 0, SEEK_END) == 0
+        && (pos = ftell(score_log->fp)) >= 0
+        && fwrite(block.data, 1, block.len, score_log->fp) == block.len;
+  free(block.data);
+
+  score_log->events.len = 0;
+  score_log->num_events = 0;
+
+  if (!ret) {
+    return FALSE;
+  }
+
+  if (score_log->index_count == SCORELOG_INDEX_ENTRIES) {
+    long index_pos = score_log_bin_new_index();
+    unsigned char next[4];
+
+    if (index_pos < 0) {
+      return FALSE;
+    }
+
+    scorelog_put_u32(next, index_pos);
+    if (!score_log_write(score_log->index_pos + 4, next, sizeof(next))) {
+      return FALSE;
+    }
+    score_log->index_pos = index_pos;
+    score_log->index_count = 0;
+  }
+
+  scorelog_put_u32(entry, game.info.turn);
+  scorelog_put_u32(entry + 4, pos);
+  scorelog_put_u32(count, score_log->index_count + 1);
+
+  if (!score_log_write(score_log->index_pos + SCORELOG_INDEX_HEADER_SIZE
+                       + score_log->index_count * SCORELOG_INDEX_ENTRY_SIZE,
+                       entry, sizeof(entry))
+      || !score_log_write(score_log->index_pos + 8, count, sizeof(count))) {
+    return FALSE;
+  }
+  score_log->index_count++;
+
+  return TRUE;
+}
+
 /**********************************************************************//**
   Initialize score logging system
 **************************************************************************/
@@ -1274,6 +1790,13 @@ void log_civ_score_init(void)
   score_log = fc_calloc(1, sizeof(*score_log));
   score_log->fp = NULL;
   score_log->last_turn = -1;
+  score_log->format = SLF_TEXT;
+  score_log->index_pos = -1;
+  score_log->index_count = 0;
+  score_log->events.data = NULL;
+  score_log->events.len = 0;
+  score_log->events.alloc = 0;
+  score_log->num_events = 0;
   score_log->plrdata = fc_calloc(player_slot_count(),
                                  sizeof(*score_log->plrdata));
   player_slots_iterate(pslot) {
@@ -1311,6 +1834,7 @@ void log_civ_score_free(void)
     free(score_log->plrdata);
   }
 
+  free(score_log->events.data);
   free(score_log);
   score_log = NULL;
 }
@@ -1324,49 +1848,6 @@ void log_civ_score_now(void)
   char id[MAX_LEN_GAME_IDENTIFIER];
   int i = 0;
 
-  /* Add new tags only at end of this list. Maintaining the order of
-   * old tags is critical. */
-  static const struct {
-    char *name;
-    int (*get_value) (const struct player *);
-  } score_tags[] = {
-    {"pop",             get_pop},
-    {"bnp",             get_economics},
-    {"mfg",             get_production},
-    {"cities",          get_cities},
-    {"techs",           get_techs},
-    {"munits",          get_munits},
-    {"settlers",        get_settlers},  /* "original" tags end here */
-
-    {"wonders",         get_wonders},
-    {"techout",         get_techout},
-    {"landarea",        get_landarea},
-    {"settledarea",     get_settledarea},
-    {"pollution",       get_pollution},
-    {"literacy",        get_literacy2},
-    {"spaceship",       get_spaceship}, /* new 1.8.2 tags end here */
-
-    {"gold",            get_gold},
-    {"taxrate",         get_taxrate},
-    {"scirate",         get_scirate},
-    {"luxrate",         get_luxrate},
-    {"riots",           get_riots},
-    {"happypop",        get_happypop},
-    {"contentpop",      get_contentpop},
-    {"unhappypop",      get_unhappypop},
-    {"specialists",     get_specialists},
-    {"gov",             get_gov},
-    {"corruption",      get_corruption}, /* new 1.11.5 tags end here */
-
-    {"score",           get_total_score}, /* New 2.1.10 tag end here. */
-
-    {"unitsbuilt",      get_units_built}, /* New tags since 2.3.0. */
-    {"unitskilled",     get_units_killed},
-    {"unitslost",       get_units_lost},
-
-    {"culture",         get_culture}      /* New tag in 2.6.0. */
-  };
-
   if (!game.server.scorelog) {
     return;
   }
@@ -1375,7 +1856,35 @@ void log_civ_score_now(void)
     return;
   }
 
+  if (!score_log->fp && game.server.scorelogformat == SLF_BINARY) {
+    score_log->format = SLF_BINARY;
+
+    if (game.info.year != GAME_START_YEAR) {
+      score_log->fp = fc_fopen(game.server.scorefile, "r+b");
+    }
+
+    if (score_log->fp) {
+      if (!scan_score_log_bin(id)) {
+        goto log_civ_score_disable;
+      }
+    } else {
+      score_log->fp = fc_fopen(game.server.scorefile, "w+b");
+      if (!score_log->fp) {
+        log_error("Can't open scorelog file '%s' for creation!",
+                  game.server.scorefile);
+        goto log_civ_score_disable;
+      }
+      if (!score_log_bin_create()) {
+        log_error("Can't write scorelog file '%s'!",
+                  game.server.scorefile);
+        goto log_civ_score_disable;
+      }
+    }
+  }
+
   if (!score_log->fp) {
+    score_log->format = SLF_TEXT;
+
     if (game.info.year == GAME_START_YEAR) {
       oper = SL_CREATE;
     } else {
@@ -1427,7 +1936,8 @@ void log_civ_score_now(void)
     }
   }
 
-  if (game.info.turn > score_log->last_turn) {
+  if (score_log->format == SLF_TEXT
+      && game.info.turn > score_log->last_turn) {
     fprintf(score_log->fp, "turn %d %d %s\n", game.info.turn, game.info.year,
             calendar_text());
     score_log->last_turn = game.info.turn;
@@ -1441,8 +1951,7 @@ void log_civ_score_now(void)
       struct player *pplayer = player_slot_get_player(pslot);
 
       if (!GOOD_PLAYER(pplayer)) {
-        fprintf(score_log->fp, "delplayer %d %d\n", game.info.turn - 1,
-                player_number(pplayer));
+        score_log_delplayer(pplayer);
         plrdata_slot_free(plrdata);
       }
     }
@@ -1457,8 +1966,7 @@ void log_civ_score_now(void)
           break;
         }
       case SL_ALL:
-        fprintf(score_log->fp, "addplayer %d %d %s\n", game.info.turn,
-              player_number(pplayer), player_name(pplayer));
+        score_log_addplayer(pplayer);
         plrdata_slot_init(plrdata, player_name(pplayer));
       }
     }
@@ -1478,16 +1986,25 @@ void log_civ_score_now(void)
         if (strcmp(plrdata->name, player_name(pplayer)) != 0) {
           log_debug("player names does not match '%s' != '%s'", plrdata->name,
                   player_name(pplayer));
-          fprintf(score_log->fp, "delplayer %d %d\n", game.info.turn - 1,
-                  player_number(pplayer));
-          fprintf(score_log->fp, "addplayer %d %d %s\n", game.info.turn,
-                  player_number(pplayer), player_name(pplayer));
+          score_log_delplayer(pplayer);
+          score_log_addplayer(pplayer);
           plrdata_slot_replace(plrdata, player_name(pplayer));
         }
       }
     }
   } players_iterate_end;
 
+  if (score_log->format == SLF_BINARY) {
+    score_log->last_turn = game.info.turn;
+    if (!score_log_bin_turn()) {
+      log_error("Can't write scorelog file '%s'!", game.server.scorefile);
+      goto log_civ_score_disable;
+    }
+    fflush(score_log->fp);
+
+    return;
+  }
+
   for (i = 0; i < ARRAY_SIZE(score_tags); i++) {
     players_iterate(pplayer) {
       if (!GOOD_PLAYER(pplayer)
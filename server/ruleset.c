@@ -8158,6 +8158,34 @@ void rulesets_deinit(void)
   requirement_vector_free(&reqs_list);
 }
 
+/**********************************************************************//**
+  Helper for compile_requirement_programs().
+**************************************************************************/
+static bool effect_compile_reqs_cb(struct effect *peffect, void *data)
+{
+  req_program_compile(&peffect->reqs_prog, &peffect->reqs);
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Compile the requirement vectors evaluated most often during the game.
+  Done once the ruleset is final; the ruleset must not be edited after.
+**************************************************************************/
+static void compile_requirement_programs(void)
+{
+  iterate_effect_cache(effect_compile_reqs_cb, NULL);
+
+  action_enablers_iterate(enabler) {
+    req_program_compile(&enabler->actor_reqs_prog, &enabler->actor_reqs);
+    req_program_compile(&enabler->target_reqs_prog, &enabler->target_reqs);
+  } action_enablers_iterate_end;
+
+  improvement_iterate(pimprove) {
+    req_program_compile(&pimprove->reqs_prog, &pimprove->reqs);
+  } improvement_iterate_end;
+}
+
 /**********************************************************************//**
   Loads the rulesets from directory.
   This may be called more than once and it will free any stale data.
@@ -8371,6 +8399,7 @@ static bool load_rulesetdir(const char *rsdir, bool compat_mode,
       set_unit_type_caches(ptype);
     } unit_type_iterate_end;
     city_production_caravan_shields_init();
+    compile_requirement_programs();
 
     /* Build advisors unit class cache corresponding to loaded rulesets */
     adv_units_ruleset_init();
@@ -118,7 +118,7 @@ static void check_fow(const char *file, const char *function, int line)
 
   whole_map_iterate(&(wld.map), ptile) {
     players_iterate(pplayer) {
-      struct player_tile *plr_tile = map_get_player_tile(ptile, pplayer);
+      struct player_tile_seen *plr_tile = map_get_player_seen(ptile, pplayer);
 
       vision_layer_iterate(v) {
         /* underflow of unsigned int */
@@ -381,11 +381,24 @@ void real_sanity_check_city(struct city *pcity, const char *file,
 static void check_cities(const char *file, const char *function, int line)
 {
   players_iterate(pplayer) {
+    struct city_list *centers = player_gov_centers(pplayer);
+    int num_centers = 0;
+
     city_list_iterate(pplayer->cities, pcity) {
       SANITY_CITY(pcity, city_owner(pcity) == pplayer);
 
+      if (centers != NULL && is_gov_center(pcity)) {
+        SANITY_CITY(pcity, city_list_find_number(centers, pcity->id)
+                           == pcity);
+        num_centers++;
+      }
+
       real_sanity_check_city(pcity, file, function, line);
     } city_list_iterate_end;
+
+    if (centers != NULL) {
+      SANITY_CHECK(city_list_size(centers) == num_centers);
+    }
   } players_iterate_end;
 }
 
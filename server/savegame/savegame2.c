@@ -4512,14 +4512,14 @@ static void sg_load_player_vision(struct loaddata *loading,
 
   /* Load player map (terrain). */
   LOAD_MAP_CHAR(ch, ptile,
-                map_get_player_tile(ptile, plr)->terrain
-                  = char2terrain(ch), loading->file,
+                player_tile_set_terrain(map_get_player_tile(ptile, plr),
+                                        char2terrain(ch)), loading->file,
                 "player%d.map_t%04d", plrno);
 
   /* Load player map (resources). */
   LOAD_MAP_CHAR(ch, ptile,
-                map_get_player_tile(ptile, plr)->resource
-                  = char2resource(ch), loading->file,
+                player_tile_set_resource(map_get_player_tile(ptile, plr),
+                                         char2resource(ch)), loading->file,
                 "player%d.map_res%04d", plrno);
 
   if (loading->version >= 30) {
@@ -4587,12 +4587,13 @@ static void sg_load_player_vision(struct loaddata *loading,
         sg_failure_ret('\0' != token[0],
                        "Savegame corrupt - map size not correct.");
         if (strcmp(token, "-") == 0) {
-          map_get_player_tile(ptile, plr)->owner = NULL;
+          player_tile_set_owner(map_get_player_tile(ptile, plr), NULL);
         } else  {
           sg_failure_ret(str_to_int(token, &number),
                          "Savegame corrupt - got tile owner=%s in (%d, %d).",
                          token, x, y);
-          map_get_player_tile(ptile, plr)->owner = player_by_number(number);
+          player_tile_set_owner(map_get_player_tile(ptile, plr),
+                                player_by_number(number));
         }
 
         if (loading->version >= 30) {
@@ -4600,12 +4601,14 @@ static void sg_load_player_vision(struct loaddata *loading,
           sg_failure_ret('\0' != token2[0],
                          "Savegame corrupt - map size not correct.");
           if (strcmp(token2, "-") == 0) {
-            map_get_player_tile(ptile, plr)->extras_owner = NULL;
+            player_tile_set_extras_owner(map_get_player_tile(ptile, plr),
+                                         NULL);
           } else  {
             sg_failure_ret(str_to_int(token2, &number),
                            "Savegame corrupt - got extras owner=%s in (%d, %d).",
                            token, x, y);
-            map_get_player_tile(ptile, plr)->extras_owner = player_by_number(number);
+            player_tile_set_extras_owner(map_get_player_tile(ptile, plr),
+                                         player_by_number(number));
           }
         } else {
           map_get_player_tile(ptile, plr)->extras_owner
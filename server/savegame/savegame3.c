@@ -6445,8 +6445,8 @@ static void sg_load_player_vision(struct loaddata *loading,
 
   /* Load player map (terrain). */
   LOAD_MAP_CHAR(ch, ptile,
-                map_get_player_tile(ptile, plr)->terrain
-                  = char2terrain(ch), loading->file,
+                player_tile_set_terrain(map_get_player_tile(ptile, plr),
+                                        char2terrain(ch)), loading->file,
                 "player%d.map_t%04d", plrno);
 
   /* Load player map (extras). */
@@ -6483,24 +6483,27 @@ static void sg_load_player_vision(struct loaddata *loading,
         sg_failure_ret('\0' != token[0],
                        "Savegame corrupt - map size not correct.");
         if (strcmp(token, "-") == 0) {
-          map_get_player_tile(ptile, plr)->owner = NULL;
+          player_tile_set_owner(map_get_player_tile(ptile, plr), NULL);
         } else  {
           sg_failure_ret(str_to_int(token, &number),
                          "Savegame corrupt - got tile owner=%s in (%d, %d).",
                          token, x, y);
-          map_get_player_tile(ptile, plr)->owner = player_by_number(number);
+          player_tile_set_owner(map_get_player_tile(ptile, plr),
+                                player_by_number(number));
         }
 
         scanin(&ptr2, ",", token2, sizeof(token2));
         sg_failure_ret('\0' != token2[0],
                        "Savegame corrupt - map size not correct.");
         if (strcmp(token2, "-") == 0) {
-          map_get_player_tile(ptile, plr)->extras_owner = NULL;
+          player_tile_set_extras_owner(map_get_player_tile(ptile, plr),
+                                       NULL);
         } else  {
           sg_failure_ret(str_to_int(token2, &number),
                          "Savegame corrupt - got extras owner=%s in (%d, %d).",
                          token, x, y);
-          map_get_player_tile(ptile, plr)->extras_owner = player_by_number(number);
+          player_tile_set_extras_owner(map_get_player_tile(ptile, plr),
+                                       player_by_number(number));
         }
       }
     }
@@ -6671,7 +6674,8 @@ static void sg_save_player_vision(struct savedata *saving,
 
   /* Save the map (terrain). */
   SAVE_MAP_CHAR(ptile,
-                terrain2char(map_get_player_tile(ptile, plr)->terrain),
+                terrain2char(player_tile_terrain(
+                               map_get_player_tile(ptile, plr))),
                 saving->file, "player%d.map_t%04d", plrno);
 
   if (game.server.foggedborders) {
@@ -6687,11 +6691,11 @@ static void sg_save_player_vision(struct savedata *saving,
         struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
         struct player_tile *plrtile = map_get_player_tile(ptile, plr);
 
-        if (plrtile == NULL || plrtile->owner == NULL) {
+        if (plrtile == NULL || player_tile_owner(plrtile) == NULL) {
           strcpy(token, "-");
         } else {
           fc_snprintf(token, sizeof(token), "%d",
-                      player_number(plrtile->owner));
+                      player_number(player_tile_owner(plrtile)));
         }
         strcat(line, token);
         if (x < wld.map.xsize) {
@@ -6711,11 +6715,11 @@ static void sg_save_player_vision(struct savedata *saving,
         struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
         struct player_tile *plrtile = map_get_player_tile(ptile, plr);
 
-        if (plrtile == NULL || plrtile->extras_owner == NULL) {
+        if (plrtile == NULL || player_tile_extras_owner(plrtile) == NULL) {
           strcpy(token, "-");
         } else {
           fc_snprintf(token, sizeof(token), "%d",
-                      player_number(plrtile->extras_owner));
+                      player_number(player_tile_extras_owner(plrtile)));
         }
         strcat(line, token);
         if (x < wld.map.xsize) {
@@ -6742,7 +6746,8 @@ static void sg_save_player_vision(struct savedata *saving,
 
     SAVE_MAP_CHAR(ptile,
                   sg_extras_get(map_get_player_tile(ptile, plr)->extras,
-                                map_get_player_tile(ptile, plr)->resource,
+                                player_tile_resource(
+                                  map_get_player_tile(ptile, plr)),
                                 mod),
                   saving->file, "player%d.map_e%02d_%04d", plrno, j);
   } halfbyte_iterate_extras_end;
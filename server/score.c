@@ -25,6 +25,7 @@
 #include "shared.h"
 
 /* common */
+#include "city.h"
 #include "culture.h"
 #include "game.h"
 #include "improvement.h"
@@ -155,8 +156,11 @@ static void print_landarea_map(struct claim_map *pcmap, int turn)
 
 #endif /* LAND_AREA_DEBUG > 2 */
 
+#ifdef FREECIV_DEBUG
 /**********************************************************************//**
   Count landarea, settled area, and claims map for all players.
+  This is the full recount the incremental landarea_cache is checked
+  against.
 **************************************************************************/
 static void build_landarea_map(struct claim_map *pcmap)
 {
@@ -212,10 +216,253 @@ static void build_landarea_map(struct claim_map *pcmap)
 #endif
 }
 
+/* How often, in turns, debug builds check the incremental land area
+ * against a full recount of the map. */
+#define LANDAREA_CHECK_TURNS 10
+#endif /* FREECIV_DEBUG */
+
+/* Land area which each tile adds to the score. The tiles changed by the
+ * game are marked with score_tile_changed() and only those are counted
+ * again when the scores are calculated. */
+struct score_tile {
+  short landarea;     /* Player index or -1 */
+  short settledarea;  /* Player index or -1 */
+};
+
+static struct {
+  struct score_tile *tiles;
+  int num_tiles;
+  enum borders_mode borders;
+
+  int *changed;
+  int num_changed, changed_alloc;
+  struct dbv changed_map;     /* Tiles listed in 'changed' */
+
+  struct claim_map cmap;
+} landarea_cache;
+
+/**********************************************************************//**
+  Returns whether one of the cities of the player has the tile in its
+  city map.
+**************************************************************************/
+static bool player_claims_tile(const struct player *pplayer,
+                               const struct tile *ptile)
+{
+  city_list_iterate(pplayer->cities, pcity) {
+    if (city_map_includes_tile(pcity, ptile)) {
+      return TRUE;
+    }
+  } city_list_iterate_end;
+
+  return FALSE;
+}
+
+/**********************************************************************//**
+  Fill in the land area the tile adds to the score. Mirrors the rules of
+  build_landarea_map().
+**************************************************************************/
+static void score_tile_count(const struct tile *ptile,
+                             struct score_tile *pstile)
+{
+  struct player *owner = NULL;
+
+  pstile->settledarea = -1;
+
+  if (is_ocean_tile(ptile)) {
+    /* Nothing. */
+  } else if (NULL != tile_city(ptile)) {
+    owner = city_owner(tile_city(ptile));
+    pstile->settledarea = player_index(owner);
+  } else if (NULL != tile_worked(ptile)) {
+    owner = city_owner(tile_worked(ptile));
+    pstile->settledarea = player_index(owner);
+  } else if (unit_list_size(ptile->units) > 0) {
+    /* Because of allied stacking these calculations are a bit off. */
+    owner = unit_owner(unit_list_get(ptile->units, 0));
+    if (player_claims_tile(owner, ptile)) {
+      pstile->settledarea = player_index(owner);
+    }
+  }
+
+  if (BORDERS_DISABLED != game.info.borders) {
+    owner = tile_owner(ptile);
+  }
+  pstile->landarea = (NULL != owner ? player_index(owner) : -1);
+}
+
+/**********************************************************************//**
+  Add (sign 1) or remove (sign -1) the land area of a tile to the totals.
+**************************************************************************/
+static void score_tile_add(const struct score_tile *pstile, int sign)
+{
+  if (pstile->landarea >= 0) {
+    landarea_cache.cmap.player[pstile->landarea].landarea += sign;
+  }
+  if (pstile->settledarea >= 0) {
+    landarea_cache.cmap.player[pstile->settledarea].settledarea += sign;
+  }
+}
+
+/**********************************************************************//**
+  Count the land area of every tile again.
+**************************************************************************/
+static void landarea_cache_rebuild(void)
+{
+  if (landarea_cache.num_tiles != MAP_INDEX_SIZE) {
+    score_free();
+    landarea_cache.num_tiles = MAP_INDEX_SIZE;
+    landarea_cache.tiles = fc_malloc(MAP_INDEX_SIZE
+                                     * sizeof(*landarea_cache.tiles));
+    dbv_init(&landarea_cache.changed_map, MAP_INDEX_SIZE);
+  }
+
+  memset(&landarea_cache.cmap, 0, sizeof(landarea_cache.cmap));
+  whole_map_iterate(&(wld.map), ptile) {
+    struct score_tile *pstile = landarea_cache.tiles + tile_index(ptile);
+
+    score_tile_count(ptile, pstile);
+    score_tile_add(pstile, 1);
+  } whole_map_iterate_end;
+
+  landarea_cache.borders = game.info.borders;
+  landarea_cache.num_changed = 0;
+  dbv_clr_all(&landarea_cache.changed_map);
+}
+
+#ifdef FREECIV_DEBUG
+/**********************************************************************//**
+  Check the land area totals against a full recount, and count every tile
+  again if they are off.
+**************************************************************************/
+static void landarea_cache_check(void)
+{
+  static struct claim_map cmap;
+  bool ok = TRUE;
+
+  build_landarea_map(&cmap);
+  players_iterate(pplayer) {
+    int idx = player_index(pplayer);
+
+    if (cmap.player[idx].landarea
+        != landarea_cache.cmap.player[idx].landarea
+        || cmap.player[idx].settledarea
+           != landarea_cache.cmap.player[idx].settledarea) {
+      log_error("Land area of %s is %d/%d but should be %d/%d.",
+                player_name(pplayer),
+                landarea_cache.cmap.player[idx].landarea,
+                landarea_cache.cmap.player[idx].settledarea,
+                cmap.player[idx].landarea, cmap.player[idx].settledarea);
+      ok = FALSE;
+    }
+  } players_iterate_end;
+
+  if (!ok) {
+    landarea_cache_rebuild();
+  }
+}
+#endif /* FREECIV_DEBUG */
+
+/**********************************************************************//**
+  Bring the land area totals up to date and return them.
+**************************************************************************/
+static const struct claim_map *landarea_cache_update(void)
+{
+  int i;
+
+  if (landarea_cache.tiles == NULL
+      || landarea_cache.num_tiles != MAP_INDEX_SIZE
+      || landarea_cache.borders != game.info.borders) {
+    landarea_cache_rebuild();
+  } else if (landarea_cache.num_changed > 0) {
+    for (i = 0; i < landarea_cache.num_changed; i++) {
+      int idx = landarea_cache.changed[i];
+      struct score_tile *pstile = landarea_cache.tiles + idx;
+
+      score_tile_add(pstile, -1);
+      score_tile_count(index_to_tile(&(wld.map), idx), pstile);
+      score_tile_add(pstile, 1);
+    }
+    landarea_cache.num_changed = 0;
+    dbv_clr_all(&landarea_cache.changed_map);
+
+#ifdef FREECIV_DEBUG
+    if (game.info.turn % LANDAREA_CHECK_TURNS == 0) {
+      landarea_cache_check();
+    }
+#endif
+  }
+
+  return &landarea_cache.cmap;
+}
+
+/**********************************************************************//**
+  Note that the land area the tile adds to the scores may have changed:
+  its terrain, owner, worker or the units on it.
+**************************************************************************/
+void score_tile_changed(const struct tile *ptile)
+{
+  int idx;
+
+  if (landarea_cache.tiles == NULL) {
+    /* Everything is counted on first use. */
+    return;
+  }
+
+  idx = tile_index(ptile);
+  if (dbv_isset(&landarea_cache.changed_map, idx)) {
+    return;
+  }
+  dbv_set(&landarea_cache.changed_map, idx);
+
+  if (landarea_cache.num_changed >= landarea_cache.changed_alloc) {
+    landarea_cache.changed_alloc = MAX(64, 2 * landarea_cache.changed_alloc);
+    landarea_cache.changed
+      = fc_realloc(landarea_cache.changed,
+                   landarea_cache.changed_alloc
+                   * sizeof(*landarea_cache.changed));
+  }
+  landarea_cache.changed[landarea_cache.num_changed++] = idx;
+}
+
+/**********************************************************************//**
+  Note that a city was built, lost, transferred or resized its city map.
+  Units on the tiles of the city map may count as settled area (or no
+  longer do).
+**************************************************************************/
+void score_city_area_changed(const struct tile *pcenter, int radius_sq)
+{
+  if (landarea_cache.tiles == NULL) {
+    return;
+  }
+
+  city_tile_iterate(radius_sq, pcenter, ptile) {
+    score_tile_changed(ptile);
+  } city_tile_iterate_end;
+}
+
+/**********************************************************************//**
+  Free the land area cache. It is rebuilt when the scores are calculated
+  the next time.
+**************************************************************************/
+void score_free(void)
+{
+  if (landarea_cache.tiles != NULL) {
+    free(landarea_cache.tiles);
+    landarea_cache.tiles = NULL;
+    dbv_free(&landarea_cache.changed_map);
+  }
+  landarea_cache.num_tiles = 0;
+
+  free(landarea_cache.changed);
+  landarea_cache.changed = NULL;
+  landarea_cache.num_changed = 0;
+  landarea_cache.changed_alloc = 0;
+}
+
 /**********************************************************************//**
   Returns the given player's land and settled areas from a claim map.
 **************************************************************************/
-static void get_player_landarea(struct claim_map *pcmap,
+static void get_player_landarea(const struct claim_map *pcmap,
 				struct player *pplayer,
 				int *return_landarea,
 				int *return_settledarea)
@@ -252,7 +499,6 @@ void calc_civ_score(struct player *pplayer)
   const struct research *presearch;
   struct city *wonder_city;
   int landarea = 0, settledarea = 0;
-  static struct claim_map cmap;
 
   pplayer->score.happy = 0;
   pplayer->score.content = 0;
@@ -302,19 +548,31 @@ void calc_civ_score(struct player *pplayer)
     pplayer->score.literacy += (city_population(pcity) * bonus) / 100;
   } city_list_iterate_end;
 
-  build_landarea_map(&cmap);
-
-  get_player_landarea(&cmap, pplayer, &landarea, &settledarea);
+  get_player_landarea(landarea_cache_update(), pplayer,
+                      &landarea, &settledarea);
   pplayer->score.landarea = landarea;
   pplayer->score.settledarea = settledarea;
 
   presearch = research_get(pplayer);
-  advance_index_iterate(A_FIRST, i) {
-    if (research_invention_state(presearch, i) == TECH_KNOWN) {
-      pplayer->score.techs++;
+  pplayer->score.techs = presearch->techs_known;
+#ifdef FREECIV_DEBUG
+  {
+    int techs = 0;
+
+    advance_index_iterate(A_FIRST, i) {
+      if (research_invention_state(presearch, i) == TECH_KNOWN) {
+        techs++;
+      }
+    } advance_index_iterate_end;
+    if (techs != presearch->techs_known) {
+      log_error("%s knows %d techs but %d are counted.",
+                research_rule_name(presearch), techs,
+                presearch->techs_known);
+      pplayer->score.techs = techs;
     }
-  } advance_index_iterate_end;
-  pplayer->score.techs += research_get(pplayer)->future_tech * 5 / 2;
+  }
+#endif /* FREECIV_DEBUG */
+  pplayer->score.techs += presearch->future_tech * 5 / 2;
   
   unit_list_iterate(pplayer->units, punit) {
     if (is_military_unit(punit)) {
@@ -23,4 +23,8 @@ int total_player_citizens(const struct player *pplayer);
 
 void rank_users(bool);
 
+void score_tile_changed(const struct tile *ptile);
+void score_city_area_changed(const struct tile *pcenter, int radius_sq);
+void score_free(void);
+
 #endif /* FC__SCORE_H */
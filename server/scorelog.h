@@ -0,0 +1,108 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+#ifndef FC__SCORELOG_H
+#define FC__SCORELOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Layout of the binary scorelog written by server/report.c and read by
+ * freeciv-scorelog. See doc/README.scorelog for the full description.
+ * All numbers are little endian; strings are prefixed by their length
+ * as one byte and are not terminated.
+ *
+ *  header:      magic, version string, offset of the first index block,
+ *               game id, number of tags (u16) and the tag names
+ *  index block: SCORELOG_INDEX_MAGIC, offset of the next index block
+ *               (0 for none), number of used entries and
+ *               SCORELOG_INDEX_ENTRIES entries of (turn, block offset)
+ *  turn block:  SCORELOG_TURN_MAGIC, turn, year, offset of the value
+ *               columns from the start of the block, number of players
+ *               (u16), number of events (u16), calendar text, the
+ *               events, the player ids (u16) and then one column per tag
+ *               with the value of each player (s32) */
+
+#define SCORELOG_MAGIC "FCSCLOG1"
+#define SCORELOG_MAGIC_LEN 8
+
+#define SCORELOG_INDEX_MAGIC "SIDX"
+#define SCORELOG_INDEX_ENTRIES 256
+#define SCORELOG_INDEX_HEADER_SIZE 12
+#define SCORELOG_INDEX_ENTRY_SIZE 8
+#define SCORELOG_INDEX_SIZE (SCORELOG_INDEX_HEADER_SIZE                    \
+                             + SCORELOG_INDEX_ENTRIES                      \
+                               * SCORELOG_INDEX_ENTRY_SIZE)
+
+#define SCORELOG_TURN_MAGIC "STRN"
+#define SCORELOG_TURN_HEADER_SIZE 20
+
+/* Events of a turn block. An event is the type (u8), the turn (s32), the
+ * player id (u16) and the player name (empty for SCORELOG_DELPLAYER). */
+enum scorelog_event {
+  SCORELOG_ADDPLAYER = 1,
+  SCORELOG_DELPLAYER = 2
+};
+
+/**********************************************************************//**
+  Store a 16 bit value.
+**************************************************************************/
+static inline void scorelog_put_u16(unsigned char *buf, unsigned int val)
+{
+  buf[0] = val & 0xff;
+  buf[1] = (val >> 8) & 0xff;
+}
+
+/**********************************************************************//**
+  Store a 32 bit value.
+**************************************************************************/
+static inline void scorelog_put_u32(unsigned char *buf, unsigned long val)
+{
+  buf[0] = val & 0xff;
+  buf[1] = (val >> 8) & 0xff;
+  buf[2] = (val >> 16) & 0xff;
+  buf[3] = (val >> 24) & 0xff;
+}
+
+/**********************************************************************//**
+  Read a 16 bit value.
+**************************************************************************/
+static inline unsigned int scorelog_get_u16(const unsigned char *buf)
+{
+  return buf[0] | (buf[1] << 8);
+}
+
+/**********************************************************************//**
+  Read a 32 bit value.
+**************************************************************************/
+static inline unsigned long scorelog_get_u32(const unsigned char *buf)
+{
+  return (unsigned long) buf[0] | ((unsigned long) buf[1] << 8)
+         | ((unsigned long) buf[2] << 16) | ((unsigned long) buf[3] << 24);
+}
+
+/**********************************************************************//**
+  Read a signed 32 bit value.
+**************************************************************************/
+static inline int scorelog_get_s32(const unsigned char *buf)
+{
+  unsigned long val = scorelog_get_u32(buf);
+
+  return val >= 0x80000000UL ? -(int) (0xffffffffUL - val) - 1 : (int) val;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FC__SCORELOG_H */
@@ -45,6 +45,9 @@
 #include <readline/history.h>
 #include <readline/readline.h>
 #endif
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 #ifdef HAVE_SYS_SELECT_H
 #include <sys/select.h>
 #endif
@@ -122,6 +125,36 @@ static int socklan;
 
 #define PROCESSING_TIME_STATISTICS 0
 
+/* Wait for input with epoll where available. Sockets are registered once
+ * when they are opened, and a wait costs only as much as there are ready
+ * sockets. When epoll can't be used, select() is the fallback. */
+#if defined(HAVE_SYS_EPOLL_H) && !defined(FREECIV_SOCKET_ZERO_NOT_STDIN)
+#define SERNET_EPOLL
+#endif
+
+/* What the last sniff_wait() found ready on a socket. */
+struct sniff_ready {
+  bool read;
+  bool write;
+  bool except;
+};
+
+static struct sniff_ready conn_ready[MAX_NUM_CONNECTIONS];
+static struct sniff_ready *listen_ready;
+static struct sniff_ready stdin_ready;
+
+#ifdef SERNET_EPOLL
+/* epoll_event.data.u32 of the sockets that are not connections, which
+ * use their index in connections[]. */
+#define EPOLL_ID_LISTEN(i)  (MAX_NUM_CONNECTIONS + (i))
+#define EPOLL_ID_STDIN      0xffffffff
+
+static int epoll_fd = -1;
+static bool epoll_stdin = FALSE;      /* stdin is registered */
+static bool epoll_stdin_file = FALSE; /* stdin can't be watched */
+static bool epoll_out[MAX_NUM_CONNECTIONS]; /* Waiting to write */
+#endif /* SERNET_EPOLL */
+
 static int server_accept_connection(int sockfd);
 static void start_processing_request(struct connection *pconn,
                                      int request_id);
@@ -194,6 +227,257 @@ static void handle_readline_input_callback(char *line)
 }
 #endif /* FREECIV_HAVE_LIBREADLINE */
 
+#ifdef SERNET_EPOLL
+/*************************************************************************//**
+  Give up epoll after a failure and fall back to select(), which needs no
+  registered sockets.
+*****************************************************************************/
+static void sniff_epoll_fail(const char *what)
+{
+  log_error("%s failed: %s; falling back to select()",
+            what, fc_strerror(fc_get_errno()));
+  fc_closesocket(epoll_fd);
+  epoll_fd = -1;
+}
+
+/*************************************************************************//**
+  Register a socket to be waited for with epoll.
+*****************************************************************************/
+static void sniff_epoll_add(int sock, uint32_t id, uint32_t events)
+{
+  struct epoll_event ev;
+
+  if (epoll_fd < 0) {
+    return;
+  }
+
+  ev.events = events;
+  ev.data.u32 = id;
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock, &ev) == -1) {
+    sniff_epoll_fail("epoll_ctl(ADD)");
+  }
+}
+#endif /* SERNET_EPOLL */
+
+/*************************************************************************//**
+  Start waiting for input from a new connection.
+*****************************************************************************/
+static void sniff_watch_connection(struct connection *pconn)
+{
+#ifdef SERNET_EPOLL
+  int i = pconn - connections;
+
+  epoll_out[i] = FALSE;
+  sniff_epoll_add(pconn->sock, i, EPOLLIN | EPOLLPRI);
+#endif /* SERNET_EPOLL */
+}
+
+/*************************************************************************//**
+  Called when the send buffer of a connection gets data or is flushed.
+  The socket is watched for writability only while there is something to
+  write.
+*****************************************************************************/
+static void sniff_notify_writable(struct connection *pconn,
+                                  bool data_available)
+{
+#ifdef SERNET_EPOLL
+  int i = pconn - connections;
+  struct epoll_event ev;
+
+  if (epoll_fd < 0 || pconn->server.is_closing
+      || data_available == epoll_out[i]) {
+    return;
+  }
+
+  ev.events = EPOLLIN | EPOLLPRI | (data_available ? EPOLLOUT : 0);
+  ev.data.u32 = i;
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, pconn->sock, &ev) == -1) {
+    sniff_epoll_fail("epoll_ctl(MOD)");
+    return;
+  }
+  epoll_out[i] = data_available;
+#endif /* SERNET_EPOLL */
+}
+
+/*************************************************************************//**
+  Stop waiting for input from a connection about to be closed.
+*****************************************************************************/
+static void sniff_unwatch_connection(struct connection *pconn)
+{
+#ifdef SERNET_EPOLL
+  if (epoll_fd >= 0) {
+    struct epoll_event ev;
+
+    /* Older kernels want a non-NULL event even for EPOLL_CTL_DEL. */
+    memset(&ev, 0, sizeof(ev));
+    (void) epoll_ctl(epoll_fd, EPOLL_CTL_DEL, pconn->sock, &ev);
+  }
+  epoll_out[pconn - connections] = FALSE;
+#endif /* SERNET_EPOLL */
+}
+
+#ifdef SERNET_EPOLL
+/*************************************************************************//**
+  Wait up to 'timeout' seconds for input with epoll, first bringing the
+  registration of stdin up to date. Returns the number of ready sockets,
+  0 on timeout or -1 on error.
+*****************************************************************************/
+static int sniff_wait_epoll(int timeout)
+{
+  static struct epoll_event events[MAX_NUM_CONNECTIONS];
+  int i, n;
+
+  /* stdin comes and goes with 'no_input'. A stdin that is a regular file
+   * can't be watched but is always readable, as select() would tell. */
+  if (!no_input && !epoll_stdin && !epoll_stdin_file) {
+    struct epoll_event ev;
+
+    ev.events = EPOLLIN;
+    ev.data.u32 = EPOLL_ID_STDIN;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, 0, &ev) == 0) {
+      epoll_stdin = TRUE;
+    } else if (fc_get_errno() == EPERM) {
+      epoll_stdin_file = TRUE;
+    } else {
+      sniff_epoll_fail("epoll_ctl(ADD stdin)");
+      return -1;
+    }
+  } else if (no_input && epoll_stdin) {
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    (void) epoll_ctl(epoll_fd, EPOLL_CTL_DEL, 0, &ev);
+    epoll_stdin = FALSE;
+  }
+
+  n = epoll_wait(epoll_fd, events, ARRAY_SIZE(events),
+                 (!no_input && epoll_stdin_file) ? 0 : timeout * 1000);
+
+  for (i = 0; i < n; i++) {
+    uint32_t id = events[i].data.u32;
+    uint32_t ev = events[i].events;
+    struct sniff_ready *ready;
+
+    if (id == EPOLL_ID_STDIN) {
+      ready = &stdin_ready;
+    } else if (id >= EPOLL_ID_LISTEN(0)) {
+      ready = &listen_ready[id - EPOLL_ID_LISTEN(0)];
+    } else {
+      ready = &conn_ready[id];
+    }
+
+    /* Like select(), report hangups and errors as readable, so that
+     * reading finds out what happened. */
+    ready->read = (0 != (ev & (EPOLLIN | EPOLLHUP | EPOLLERR)));
+    ready->write = (0 != (ev & (EPOLLOUT | EPOLLERR)));
+    ready->except = (0 != (ev & EPOLLPRI));
+  }
+
+  if (!no_input && epoll_stdin_file && 0 <= n) {
+    stdin_ready.read = TRUE;
+    n++;
+  }
+
+  return n;
+}
+#endif /* SERNET_EPOLL */
+
+/*************************************************************************//**
+  Wait up to 'timeout' seconds for input with select(). Returns the number
+  of ready sockets, 0 on timeout or -1 on error.
+*****************************************************************************/
+static int sniff_wait_select(int timeout)
+{
+  fd_set readfs, writefs, exceptfs;
+  fc_timeval tv;
+  int max_desc;
+  int i, n;
+
+  tv.tv_sec = timeout;
+  tv.tv_usec = 0;
+
+  FC_FD_ZERO(&readfs);
+  FC_FD_ZERO(&writefs);
+  FC_FD_ZERO(&exceptfs);
+
+  if (!no_input) {
+#if !defined(FREECIV_SOCKET_ZERO_NOT_STDIN) && !defined(__VMS)
+    FD_SET(0, &readfs);
+#endif /* !FREECIV_SOCKET_ZERO_NOT_STDIN && !__VMS */
+  }
+
+  max_desc = 0;
+  for (i = 0; i < listen_count; i++) {
+    FD_SET(listen_socks[i], &readfs);
+    FD_SET(listen_socks[i], &exceptfs);
+    max_desc = MAX(max_desc, listen_socks[i]);
+  }
+
+  for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
+    struct connection *pconn = connections + i;
+
+    if (pconn->used && !pconn->server.is_closing) {
+      FD_SET(pconn->sock, &readfs);
+      if (0 < pconn->send_buffer->ndata) {
+        FD_SET(pconn->sock, &writefs);
+      }
+      FD_SET(pconn->sock, &exceptfs);
+      max_desc = MAX(pconn->sock, max_desc);
+    }
+  }
+
+  n = fc_select(max_desc + 1, &readfs, &writefs, &exceptfs, &tv);
+  if (n <= 0) {
+    return n;
+  }
+
+#if !defined(FREECIV_SOCKET_ZERO_NOT_STDIN) && !defined(__VMS)
+  stdin_ready.read = (!no_input && FD_ISSET(0, &readfs));
+#endif /* !FREECIV_SOCKET_ZERO_NOT_STDIN && !__VMS */
+  for (i = 0; i < listen_count; i++) {
+    listen_ready[i].read = FD_ISSET(listen_socks[i], &readfs);
+    listen_ready[i].except = FD_ISSET(listen_socks[i], &exceptfs);
+  }
+  for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
+    struct connection *pconn = connections + i;
+
+    if (pconn->used && !pconn->server.is_closing) {
+      conn_ready[i].read = FD_ISSET(pconn->sock, &readfs);
+      conn_ready[i].write = FD_ISSET(pconn->sock, &writefs);
+      conn_ready[i].except = FD_ISSET(pconn->sock, &exceptfs);
+    }
+  }
+
+  return n;
+}
+
+/*************************************************************************//**
+  Wait up to 'timeout' seconds for input on stdin, the listening sockets
+  or the connections, or for connections with pending data to become
+  writable. What is ready is left in stdin_ready, listen_ready[] and
+  conn_ready[]. Returns the number of ready sockets, 0 on timeout or -1
+  on error.
+*****************************************************************************/
+static int sniff_wait(int timeout)
+{
+  memset(conn_ready, 0, sizeof(conn_ready));
+  memset(listen_ready, 0, listen_count * sizeof(*listen_ready));
+  memset(&stdin_ready, 0, sizeof(stdin_ready));
+
+#ifdef SERNET_EPOLL
+  if (epoll_fd >= 0) {
+    int n = sniff_wait_epoll(timeout);
+
+    if (epoll_fd >= 0) {
+      return n;
+    }
+    /* epoll failed for good; retry the wait with select(). */
+  }
+#endif /* SERNET_EPOLL */
+
+  return sniff_wait_select(timeout);
+}
+
 /*************************************************************************//**
   Close the connection (very low-level). See also
   server_conn_close_callback().
@@ -220,6 +504,7 @@ static void close_connection(struct connection *pconn)
   pconn->playing = NULL;
   pconn->client_gui = GUI_STUB;
   pconn->access_level = ALLOW_NONE;
+  sniff_unwatch_connection(pconn);
   connection_common_close(pconn);
 
   send_updated_vote_totals(NULL);
@@ -251,6 +536,16 @@ void close_connections_and_socket(void)
     fc_closesocket(listen_socks[i]);
   }
   FC_FREE(listen_socks);
+  FC_FREE(listen_ready);
+
+#ifdef SERNET_EPOLL
+  if (epoll_fd >= 0) {
+    fc_closesocket(epoll_fd);
+    epoll_fd = -1;
+  }
+  epoll_stdin = FALSE;
+  epoll_stdin_file = FALSE;
+#endif /* SERNET_EPOLL */
 
   if (srvarg.announce != ANNOUNCE_NONE) {
     fc_closesocket(socklan);
@@ -494,10 +789,7 @@ static void incoming_client_packets(struct connection *pconn)
 enum server_events server_sniff_all_input(void)
 {
   int i, s;
-  int max_desc;
   bool excepting;
-  fd_set readfs, writefs, exceptfs;
-  fc_timeval tv;
 #ifdef FREECIV_SOCKET_ZERO_NOT_STDIN
   char *bufptr;
 #endif
@@ -656,45 +948,15 @@ enum server_events server_sniff_all_input(void)
       return S_E_END_OF_TURN_TIMEOUT;
     }
 
-    tv.tv_sec = 1;
-    tv.tv_usec = 0;
-
-    FC_FD_ZERO(&readfs);
-    FC_FD_ZERO(&writefs);
-    FC_FD_ZERO(&exceptfs);
-
-    if (!no_input) {
 #ifdef FREECIV_SOCKET_ZERO_NOT_STDIN
+    if (!no_input) {
       fc_init_console();
-#else /* FREECIV_SOCKET_ZERO_NOT_STDIN */
-#   if !defined(__VMS)
-      FD_SET(0, &readfs);
-#   endif /* VMS */
-#endif /* FREECIV_SOCKET_ZERO_NOT_STDIN */
     }
+#endif /* FREECIV_SOCKET_ZERO_NOT_STDIN */
 
-    max_desc = 0;
-    for (i = 0; i < listen_count; i++) {
-      FD_SET(listen_socks[i], &readfs);
-      FD_SET(listen_socks[i], &exceptfs);
-      max_desc = MAX(max_desc, listen_socks[i]);
-    }
-
-    for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
-      struct connection *pconn = connections + i;
-
-      if (pconn->used && !pconn->server.is_closing) {
-        FD_SET(pconn->sock, &readfs);
-        if (0 < pconn->send_buffer->ndata) {
-          FD_SET(pconn->sock, &writefs);
-        }
-        FD_SET(pconn->sock, &exceptfs);
-        max_desc = MAX(pconn->sock, max_desc);
-      }
-    }
     con_prompt_off();		/* output doesn't generate a new prompt */
 
-    if (fc_select(max_desc + 1, &readfs, &writefs, &exceptfs, &tv) == 0) {
+    if (sniff_wait(1) == 0) {
       /* timeout */
       call_ai_refresh();
       script_server_signal_emit("pulse");
@@ -736,7 +998,7 @@ enum server_events server_sniff_all_input(void)
 	    lib$stop(status);
 	  }
 	  if (ttchar.numchars) {
-	    FD_SET(0, &readfs);
+	    stdin_ready.read = TRUE;
 	  } else {
 	    continue;
 	  }
@@ -752,7 +1014,7 @@ enum server_events server_sniff_all_input(void)
 
     excepting = FALSE;
     for (i = 0; i < listen_count; i++) {
-      if (FD_ISSET(listen_socks[i], &exceptfs)) {
+      if (listen_ready[i].except) {
         excepting = TRUE;
         break;
       }
@@ -762,7 +1024,7 @@ enum server_events server_sniff_all_input(void)
     }
     for (i = 0; i < listen_count; i++) {
       s = listen_socks[i];
-      if (FD_ISSET(s, &readfs)) {     /* new players connects */
+      if (listen_ready[i].read) {     /* new players connects */
         log_verbose("got new connection");
         if (-1 == server_accept_connection(s)) {
           /* There will be a log_error() message from
@@ -779,7 +1041,7 @@ enum server_events server_sniff_all_input(void)
 
       if (pconn->used
           && !pconn->server.is_closing
-          && FD_ISSET(pconn->sock, &exceptfs)) {
+          && conn_ready[i].except) {
         log_verbose("connection (%s) cut due to exception data",
                     conn_description(pconn));
         connection_close_server(pconn, _("network exception"));
@@ -794,7 +1056,7 @@ enum server_events server_sniff_all_input(void)
       free(bufptr_internal);
     }
 #else  /* !FREECIV_SOCKET_ZERO_NOT_STDIN */
-    if (!no_input && FD_ISSET(0, &readfs)) {    /* input from server operator */
+    if (!no_input && stdin_ready.read) {    /* input from server operator */
 #ifdef FREECIV_HAVE_LIBREADLINE
       rl_callback_read_char();
       if (readline_handled_input) {
@@ -850,7 +1112,7 @@ enum server_events server_sniff_all_input(void)
 
         if (!pconn->used
             || pconn->server.is_closing
-            || !FD_ISSET(pconn->sock, &readfs)) {
+            || !conn_ready[i].read) {
           continue;
         }
 
@@ -873,7 +1135,7 @@ enum server_events server_sniff_all_input(void)
             && !pconn->server.is_closing
             && pconn->send_buffer
             && pconn->send_buffer->ndata > 0) {
-          if (FD_ISSET(pconn->sock, &writefs)) {
+          if (conn_ready[i].write) {
             flush_connection_send_buffer_all(pconn);
           } else {
             cut_lagging_connection(pconn);
@@ -1044,11 +1306,12 @@ int server_make_connection(int new_sock, const char *client_addr,
     if (!pconn->used) {
       connection_common_init(pconn);
       pconn->sock = new_sock;
+      sniff_watch_connection(pconn);
       pconn->observer = FALSE;
       pconn->playing = NULL;
       pconn->capability[0] = '\0';
       pconn->access_level = access_level_for_next_connection();
-      pconn->notify_of_writable_data = NULL;
+      pconn->notify_of_writable_data = sniff_notify_writable;
       pconn->server.currently_processed_request_id = 0;
       pconn->server.last_request_id_seen = 0;
       pconn->server.auth_tries = 0;
@@ -1132,6 +1395,7 @@ int server_open_socket(void)
 
   /* Loop to create sockets, bind, listen. */
   listen_socks = fc_calloc(name_count, sizeof(listen_socks[0]));
+  listen_ready = fc_calloc(name_count, sizeof(listen_ready[0]));
   listen_count = 0;
 
   fc_sockaddr_list_iterate(list, paddr) {
@@ -1224,6 +1488,17 @@ int server_open_socket(void)
 
   fc_sockaddr_list_destroy(list);
 
+#ifdef SERNET_EPOLL
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd == -1) {
+    log_verbose("epoll_create1() failed: %s; using select()",
+                fc_strerror(fc_get_errno()));
+  }
+  for (j = 0; j < listen_count; j++) {
+    sniff_epoll_add(listen_socks[j], EPOLL_ID_LISTEN(j), EPOLLIN | EPOLLPRI);
+  }
+#endif /* SERNET_EPOLL */
+
   connections_set_close_callback(server_conn_close_callback);
 
   if (srvarg.announce == ANNOUNCE_NONE) {
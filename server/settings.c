@@ -541,6 +541,19 @@ scoreloglevel_name(enum scorelog_level sl_level)
   return NULL;
 }
 
+/************************************************************************//**
+  Scorelog format names accessor.
+****************************************************************************/
+static const struct sset_val_name *
+scorelogformat_name(enum scorelog_format sl_format)
+{
+  switch (sl_format) {
+  NAME_CASE(SLF_TEXT, "TEXT",     N_("Text"));
+  NAME_CASE(SLF_BINARY, "BINARY", N_("Binary, indexed by turn"));
+  }
+  return NULL;
+}
+
 /************************************************************************//**
   Savegame compress type names accessor.
 ****************************************************************************/
@@ -637,6 +650,17 @@ static void scorelog_action(const struct setting *pset)
   }
 }
 
+/************************************************************************//**
+  Reopen the score log in the new format.
+****************************************************************************/
+static void scorelogformat_action(const struct setting *pset)
+{
+  if (game.server.scorelog) {
+    log_civ_score_free();
+    log_civ_score_init();
+  }
+}
+
 /************************************************************************//**
   Create the selected number of AI's.
 ****************************************************************************/
@@ -2957,6 +2981,20 @@ static struct setting settings[] = {
               "users are not required to wait for the save to finish."),
            NULL, NULL, GAME_DEFAULT_THREADED_SAVE)
 
+  GEN_INT("turnthreads", game.server.turn_threads,
+          SSET_META, SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
+          N_("Number of threads used for turn change"),
+          N_("Parts of the turn change that can be evaluated for each "
+             "player or city independently, such as refreshing all "
+             "cities before sending them to clients, are spread over "
+             "this many threads, as are valuing the tiles of a new map "
+             "for start positions and drawing map images. Results are "
+             "always committed in the same order, so the outcome of the "
+             "game does not depend on this setting."),
+          NULL, NULL, NULL,
+          GAME_MIN_TURN_THREADS, GAME_MAX_TURN_THREADS,
+          GAME_DEFAULT_TURN_THREADS)
+
   GEN_INT("compress", game.server.save_compress_level,
           SSET_META, SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
           N_("Savegame compression level"),
@@ -3019,6 +3057,21 @@ static struct setting settings[] = {
               "or only for human players."), NULL, NULL, NULL,
            scoreloglevel_name, GAME_DEFAULT_SCORELOGLEVEL)
 
+  GEN_ENUM("scorelogformat", game.server.scorelogformat,
+           SSET_META, SSET_INTERNAL, SSET_RARE,
+           ALLOW_HACK, ALLOW_HACK,
+           N_("Scorelog file format"),
+           /* TRANS: The strings between single quotes are setting names
+            * and should not be translated. */
+           N_("The binary format stores the values of each turn as one "
+              "column per statistic, with an index of the turns, so "
+              "single statistics can be extracted quickly with the "
+              "freeciv-scorelog tool. An existing score log can only "
+              "be continued in the format it was written in, so use a "
+              "new 'scorefile' when changing this during a game."),
+           NULL, NULL, scorelogformat_action,
+           scorelogformat_name, GAME_DEFAULT_SCORELOGFORMAT)
+
 #ifndef FREECIV_WEB
   GEN_STRING("scorefile", game.server.scorefile,
              SSET_META, SSET_INTERNAL, SSET_SITUATIONAL,
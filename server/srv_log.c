@@ -43,6 +43,27 @@
 static struct timer *aitimer[AIT_LAST][2];
 static int recursion[AIT_LAST];
 
+/* Set while AI code runs on several threads at once. */
+static bool log_concurrent = FALSE;
+
+/**********************************************************************//**
+  Tell whether AI code may currently run on several threads at once.
+  Meanwhile AI timers are not updated, and debug messages are logged but
+  not sent to the clients.
+**************************************************************************/
+void srv_log_concurrent(bool concurrent)
+{
+  log_concurrent = concurrent;
+}
+
+/**********************************************************************//**
+  Whether AI debug messages may be sent to the clients now.
+**************************************************************************/
+bool srv_log_can_notify(void)
+{
+  return !log_concurrent;
+}
+
 /* General AI logging functions */
 
 /**********************************************************************//**
@@ -71,7 +92,7 @@ void real_city_log(const char *file, const char *function, int line,
   va_end(ap);
 
   cat_snprintf(buffer, sizeof(buffer), "%s", buffer2);
-  if (notify) {
+  if (notify && !log_concurrent) {
     notify_conn(NULL, NULL, E_AI_DEBUG, ftc_log, "%s", buffer);
   }
   do_log(file, function, line, FALSE, level, "%s", buffer);
@@ -115,7 +136,7 @@ void real_unit_log(const char *file, const char *function, int line,
   va_end(ap);
 
   cat_snprintf(buffer, sizeof(buffer), "%s", buffer2);
-  if (notify) {
+  if (notify && !log_concurrent) {
     notify_conn(NULL, NULL, E_AI_DEBUG, ftc_log, "%s", buffer);
   }
   do_log(file, function, line, FALSE, level, "%s", buffer);
@@ -129,6 +150,10 @@ void timing_log_real(enum ai_timer timer, enum ai_timer_activity activity)
 {
   static int turn = -1;
 
+  if (log_concurrent) {
+    return;
+  }
+
   if (game.info.turn != turn) {
     int i;
 
@@ -204,6 +229,7 @@ void timing_results_real(void)
   AILOG_OUT("Cities", AIT_CITIES);
   AILOG_OUT(" - Buildings", AIT_BUILDINGS);
   AILOG_OUT(" - Danger", AIT_DANGER);
+  AILOG_OUT("   - Danger paths", AIT_DANGER_PATHS);
   AILOG_OUT(" - Worker want", AIT_CITY_TERRAIN);
   AILOG_OUT(" - Military want", AIT_CITY_MILITARY);
   AILOG_OUT(" - Settler want", AIT_CITY_SETTLERS);
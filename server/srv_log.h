@@ -50,6 +50,7 @@ enum ai_timer {
   AIT_CITIZEN_ARRANGE,
   AIT_BUILDINGS,
   AIT_DANGER,
+  AIT_DANGER_PATHS,
   AIT_TECH,
   AIT_FSTK,
   AIT_DEFENDERS,
@@ -112,6 +113,9 @@ void real_unit_log(const char *file, const char *function, int line,
   }                                                                         \
 }
 
+void srv_log_concurrent(bool concurrent);
+bool srv_log_can_notify(void);
+
 void timing_log_init(void);
 void timing_log_free(void);
 
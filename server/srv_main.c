@@ -57,6 +57,7 @@
 #include "registry.h"
 #include "support.h"
 #include "timing.h"
+#include "workerpool.h"
 
 /* common/aicore */
 #include "citymap.h"
@@ -192,6 +193,32 @@ static struct timer *eot_timer = NULL;
 
 static struct timer *between_turns = NULL;
 
+/* helper threads for the parallel parts of turn change */
+static struct fc_worker_pool *turn_workers = NULL;
+static int turn_workers_threads = 1;
+
+/**********************************************************************//**
+  Return the worker pool for the parallel parts of turn change, or NULL
+  if those should run serially. The pool is (re)created whenever the
+  'turnthreads' setting has changed since the last call.
+**************************************************************************/
+struct fc_worker_pool *server_turn_workers(void)
+{
+  if (turn_workers_threads != game.server.turn_threads) {
+    fc_worker_pool_destroy(turn_workers);
+    turn_workers = NULL;
+    turn_workers_threads = game.server.turn_threads;
+
+    if (turn_workers_threads > 1) {
+      turn_workers = fc_worker_pool_new(turn_workers_threads);
+      log_verbose("Turn change uses %d threads.",
+                  fc_worker_pool_threads(turn_workers));
+    }
+  }
+
+  return turn_workers;
+}
+
 /**********************************************************************//**
   Initialize the game seed.  This may safely be called multiple times.
 **************************************************************************/
@@ -1050,11 +1077,59 @@ static void kill_dying_players(void)
   }
 }
 
+/**********************************************************************//**
+  Run the planning of one of the AI players in the array 'data'.
+**************************************************************************/
+static void ai_plan_phase_player(int idx, void *data)
+{
+  struct player **planners = data;
+
+  CALL_PLR_AI_FUNC(plan_phase, planners[idx], planners[idx]);
+}
+
+/**********************************************************************//**
+  Let the AI players of the phase plan, all against the world as it is
+  before any of them moves. The planning of different players is spread
+  over the turn worker pool.
+**************************************************************************/
+static void ai_plan_phase(void)
+{
+  struct player *planners[MAX_NUM_PLAYER_SLOTS];
+  struct fc_worker_pool *workers = server_turn_workers();
+  bool threaded;
+  int count = 0;
+
+  phase_players_iterate(pplayer) {
+    if (is_ai(pplayer) && pplayer->ai->funcs.plan_phase != NULL) {
+      planners[count++] = pplayer;
+    }
+  } phase_players_iterate_end;
+
+  threaded = (count > 1 && fc_worker_pool_threads(workers) > 1);
+  if (threaded) {
+    /* The effect cache, the AI logs and the AI timers are not safe to
+     * update from several threads. */
+    effect_cache_freeze(TRUE);
+    srv_log_concurrent(TRUE);
+    ai_timers_suspend(TRUE);
+  }
+
+  fc_worker_pool_run(workers, count, ai_plan_phase_player, planners);
+
+  if (threaded) {
+    ai_timers_suspend(FALSE);
+    srv_log_concurrent(FALSE);
+    effect_cache_freeze(FALSE);
+  }
+}
+
 /**********************************************************************//**
   Called at the start of each (new) phase to do AI activities.
 **************************************************************************/
 static void ai_start_phase(void)
 {
+  ai_plan_phase();
+
   phase_players_iterate(pplayer) {
     if (is_ai(pplayer)) {
       CALL_PLR_AI_FUNC(first_activities, pplayer, pplayer);
@@ -1205,18 +1280,24 @@ static void begin_phase(bool is_new_phase)
     /* Unit "end of turn" activities - of course these actually go at
      * the start of the turn! */
     phase_players_iterate(pplayer) {
+      unit_info_freeze();
       update_unit_activities(pplayer);
+      unit_info_thaw();
       flush_packets();
     } phase_players_iterate_end;
     /* Execute orders after activities have been completed (roads built,
      * pillage done, etc.). */
     phase_players_iterate(pplayer) {
+      unit_info_freeze();
       execute_unit_orders(pplayer);
+      unit_info_thaw();
       flush_packets();
     } phase_players_iterate_end;
+    unit_info_freeze();
     phase_players_iterate(pplayer) {
       finalize_unit_phase_beginning(pplayer);
     } phase_players_iterate_end;
+    unit_info_thaw();
     flush_packets();
   }
 
@@ -1228,9 +1309,7 @@ static void begin_phase(bool is_new_phase)
     }
   } phase_players_iterate_end;
 
-  phase_players_iterate(pplayer) {
-    send_player_cities(pplayer);
-  } phase_players_iterate_end;
+  send_phase_players_cities();
 
   flush_packets();  /* to curb major city spam */
   conn_list_do_unbuffer(game.est_connections);
@@ -1248,7 +1327,9 @@ static void begin_phase(bool is_new_phase)
     } phase_players_iterate_end;
 
     log_debug("Aistartturn");
+    unit_info_freeze();
     ai_start_phase();
+    unit_info_thaw();
   } else {
     phase_players_iterate(pplayer) {
       if (is_ai(pplayer)) {
@@ -1345,6 +1426,7 @@ static void end_phase(void)
   send_city_suppression(TRUE);
 
   /* AI end of turn activities */
+  unit_info_freeze();
   players_iterate(pplayer) {
     unit_list_iterate(pplayer->units, punit) {
       CALL_PLR_AI_FUNC(unit_turn_end, pplayer, punit);
@@ -1356,6 +1438,7 @@ static void end_phase(void)
       CALL_PLR_AI_FUNC(last_activities, pplayer, pplayer);
     }
   } phase_players_iterate_end;
+  unit_info_thaw();
 
   /* Refresh cities */
   phase_players_iterate(pplayer) {
@@ -1363,7 +1446,14 @@ static void end_phase(void)
     research_get(pplayer)->got_tech_multi = FALSE;
   } phase_players_iterate_end;
 
+  /* The rest of the per-player turn change stays serial, in player order.
+   * City activities, unit restoration and research draw from the shared
+   * random number generator, and each player's results feed the next one
+   * through conquered cities, trade routes, tech leakage and parasites,
+   * so their order is part of the game. Only city refreshes are spread
+   * over the turn worker pool, see city_refresh_array(). */
   phase_players_iterate(pplayer) {
+    unit_info_freeze();
     do_tech_parasite_effect(pplayer);
     player_restore_units(pplayer);
 
@@ -1381,6 +1471,7 @@ static void end_phase(void)
     /* reduce the number of bulbs by the amount needed for tech upkeep and
      * check for finished research */
     update_bulbs(pplayer, -player_tech_upkeep(pplayer), TRUE);
+    unit_info_thaw();
     flush_packets();
   } phase_players_iterate_end;
 
@@ -1394,9 +1485,7 @@ static void end_phase(void)
   /* Unfreeze sending of cities. */
   send_city_suppression(FALSE);
 
-  phase_players_iterate(pplayer) {
-    send_player_cities(pplayer);
-  } phase_players_iterate_end;
+  send_phase_players_cities();
   flush_packets();  /* to curb major city spam */
 
   do_reveal_effects();
@@ -1735,6 +1824,9 @@ void server_quit(void)
   if (eot_timer != NULL) {
     timer_destroy(eot_timer);
   }
+  fc_worker_pool_destroy(turn_workers);
+  turn_workers = NULL;
+  turn_workers_threads = 1;
   set_server_state(S_S_OVER);
   mapimg_free();
   server_game_free();
@@ -2021,6 +2113,9 @@ bool server_packet_input(struct connection *pconn, void *packet, int type)
   /* Make sure to set this back to NULL before leaving this function: */
   pplayer->current_conn = pconn;
 
+  /* Send each unit changed by the request once. */
+  unit_info_freeze();
+
   if (!server_handle_packet(type, packet, pplayer, pconn)) {
     log_error("Received unknown packet %d from %s.",
               type, conn_description(pconn));
@@ -2035,6 +2130,8 @@ bool server_packet_input(struct connection *pconn, void *packet, int type)
     kill_dying_players();
   }
 
+  unit_info_thaw();
+
   pplayer->current_conn = NULL;
   return TRUE;
 }
@@ -2898,7 +2995,7 @@ static void srv_prepare(void)
   mapimg_init(mapimg_server_tile_known, mapimg_server_tile_terrain,
               mapimg_server_tile_owner, mapimg_server_tile_city,
               mapimg_server_tile_unit, mapimg_server_plrcolor_count,
-              mapimg_server_plrcolor_get);
+              mapimg_server_plrcolor_get, server_turn_workers);
 
 #ifdef HAVE_FCDB
   if (srvarg.fcdb_enabled) {
@@ -3161,6 +3258,10 @@ static void srv_ready(void)
 
   CALL_FUNC_EACH_AI(map_ready);
 
+  /* Map generation and savegame loading don't go through the effect
+   * cache invalidation hooks. */
+  effect_cache_flush();
+
   /* start the game */
   set_server_state(S_S_RUNNING);
   (void) send_server_info_to_metaserver(META_INFO);
@@ -3211,6 +3312,8 @@ static void srv_ready(void)
     settings_game_start();
   }
 
+  player_maps_log_memory();
+
   /* FIXME: can this be moved? */
   players_iterate(pplayer) {
     adv_data_analyze_rulesets(pplayer);
@@ -3324,6 +3427,7 @@ void server_game_free(void)
 
   event_cache_free();
   log_civ_score_free();
+  score_free();
   playercolor_free();
   citymap_free();
   game_free();
@@ -3524,7 +3628,7 @@ static struct terrain
 {
   if (knowledge && pplayer) {
     struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
-    return plrtile->terrain;
+    return player_tile_terrain(plrtile);
   }
 
   return tile_terrain(ptile);
@@ -3540,7 +3644,7 @@ static struct player *mapimg_server_tile_owner(const struct tile *ptile,
   if (knowledge && pplayer
       && tile_get_known(ptile, pplayer) != TILE_KNOWN_SEEN) {
     struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
-    return plrtile->owner;
+    return player_tile_owner(plrtile);
   }
 
   return tile_owner(ptile);
@@ -22,6 +22,7 @@
 #include "game.h"
 
 struct conn_list;
+struct fc_worker_pool;
 
 struct server_arguments {
   /* metaserver information */
@@ -99,6 +100,8 @@ void check_for_full_turn_done(void);
 bool check_for_game_over(void);
 bool game_was_started(void);
 
+struct fc_worker_pool *server_turn_workers(void);
+
 server_setting_id server_ss_by_name(const char *name);
 const char *server_ss_name_get(server_setting_id id);
 enum sset_type server_ss_type_get(server_setting_id id);
@@ -39,6 +39,7 @@
 
 /* common */
 #include "capability.h"
+#include "effects.h"
 #include "events.h"
 #include "fc_types.h" /* LINE_BREAK */
 #include "featured_text.h"
@@ -53,6 +54,10 @@
 #include "unitlist.h"
 #include "version.h"
 
+/* common/aicore */
+#include "path_finding.h"
+#include "pf_tools.h"
+
 /* server */
 #include "aiiface.h"
 #include "citytools.h"
@@ -2630,6 +2635,61 @@ static bool cancelvote_command(struct connection *caller,
   return TRUE;
 }
 
+/**********************************************************************//**
+  Find the path of the unit to the tile both with a plain and with a
+  goal-directed search, and report how they compare.
+**************************************************************************/
+static void debug_path_compare(struct connection *caller,
+                               const struct unit *punit, struct tile *ptile)
+{
+  struct pf_parameter parameter;
+  struct pf_position pos[2];
+  unsigned long expanded[2];
+  double seconds[2];
+  bool found[2];
+  struct timer *ptimer = timer_new(TIMER_USER, TIMER_ACTIVE);
+  int i;
+
+  pft_fill_unit_parameter(&parameter, punit);
+  for (i = 0; i < 2; i++) {
+    struct pf_map *pfm;
+
+    timer_clear(ptimer);
+    timer_start(ptimer);
+    pfm = (0 == i ? pf_map_new(&parameter)
+           : pf_map_new_goal(&parameter, ptile));
+    found[i] = pf_map_position(pfm, ptile, &pos[i]);
+    expanded[i] = pf_map_nodes_expanded(pfm);
+    pf_map_destroy(pfm);
+    timer_stop(ptimer);
+    seconds[i] = timer_read_seconds(ptimer);
+  }
+  timer_destroy(ptimer);
+
+  if (!found[0] && !found[1]) {
+    cmd_reply(CMD_DEBUG, caller, C_OK, _("No path found."));
+  } else if (found[0] != found[1]
+             || pos[0].total_MC != pos[1].total_MC
+             || pos[0].total_EC != pos[1].total_EC) {
+    cmd_reply(CMD_DEBUG, caller, C_FAIL,
+              _("The searches disagree: cost %d+%d against %d+%d."),
+              found[0] ? pos[0].total_MC : -1,
+              found[0] ? pos[0].total_EC : -1,
+              found[1] ? pos[1].total_MC : -1,
+              found[1] ? pos[1].total_EC : -1);
+  } else {
+    cmd_reply(CMD_DEBUG, caller, C_OK,
+              _("Path of %d turns, cost %d+%d."),
+              pos[0].turn, pos[0].total_MC, pos[0].total_EC);
+  }
+  cmd_reply(CMD_DEBUG, caller, C_OK,
+            _("Plain search: %lu positions expanded, %.6f seconds."),
+            expanded[0], seconds[0]);
+  cmd_reply(CMD_DEBUG, caller, C_OK,
+            _("Goal-directed search: %lu positions expanded, %.6f seconds."),
+            expanded[1], seconds[1]);
+}
+
 /**********************************************************************//**
   Turn on selective debugging.
 **************************************************************************/
@@ -2637,7 +2697,7 @@ static bool debug_command(struct connection *caller, char *str,
                           bool check)
 {
   char buf[MAX_LEN_CONSOLE_LINE];
-  char *arg[3];
+  char *arg[4];
   int ntokens = 0, i;
 
   if (game.info.is_new_game) {
@@ -2651,7 +2711,7 @@ static bool debug_command(struct connection *caller, char *str,
 
   if (str != NULL && strlen(str) > 0) {
     sz_strlcpy(buf, str);
-    ntokens = get_tokens(buf, arg, 3, TOKEN_DELIMITERS);
+    ntokens = get_tokens(buf, arg, 4, TOKEN_DELIMITERS);
   } else {
     ntokens = 0;
   }
@@ -2787,6 +2847,48 @@ static bool debug_command(struct connection *caller, char *str,
     } unit_list_iterate_end;
   } else if (ntokens > 0 && strcmp(arg[0], "timing") == 0) {
     TIMING_RESULTS();
+  } else if (ntokens > 0 && strcmp(arg[0], "caches") == 0) {
+    const struct effect_cache_stats *estats = effect_cache_stats_get();
+    const struct packet_broadcast_stats *bstats
+      = packet_broadcast_stats_get();
+    unsigned long lookups = estats->hits + estats->misses;
+    enum pf_map_type type;
+
+    if (ntokens == 2 && strcmp(arg[1], "reset") == 0) {
+      effect_cache_stats_reset();
+      pf_map_stats_reset();
+      packet_broadcast_stats_reset();
+      cmd_reply(CMD_DEBUG, caller, C_OK, _("Cache statistics reset."));
+    } else if (ntokens != 1) {
+      cmd_reply(CMD_DEBUG, caller, C_SYNTAX,
+                _("Undefined argument.  Usage:\n%s"),
+                command_synopsis(command_by_number(CMD_DEBUG)));
+    } else {
+      cmd_reply(CMD_DEBUG, caller, C_OK,
+                _("Effect cache: %lu hits, %lu misses (%lu%% hit rate), "
+                  "%lu uncached queries, %lu invalidations."),
+                estats->hits, estats->misses,
+                lookups > 0 ? estats->hits * 100 / lookups : 0,
+                estats->bypassed, estats->invalidations);
+
+      for (type = pf_map_type_begin(); type != pf_map_type_end();
+           type = pf_map_type_next(type)) {
+        struct pf_map_stats pstats;
+
+        pf_map_stats_get(type, &pstats);
+        cmd_reply(CMD_DEBUG, caller, C_OK,
+                  /* TRANS: 'Normal', 'Danger' or 'Fuel' path-finding maps */
+                  _("%s path-finding maps: %lu created, %lu allocated, "
+                    "%lu reused, %lu nodes, %lu expanded, %.3f seconds."),
+                  pf_map_type_name(type), pstats.maps, pstats.allocated,
+                  pstats.reused, pstats.nodes, pstats.expanded,
+                  pstats.seconds);
+      }
+
+      cmd_reply(CMD_DEBUG, caller, C_OK,
+                _("Broadcast packets: %lu encoded, %lu reused."),
+                bstats->encoded, bstats->reused);
+    }
   } else if (ntokens > 0 && strcmp(arg[0], "ferries") == 0) {
     if (game.server.debug[DEBUG_FERRIES]) {
       game.server.debug[DEBUG_FERRIES] = FALSE;
@@ -2796,6 +2898,34 @@ static bool debug_command(struct connection *caller, char *str,
       game.server.debug[DEBUG_FERRIES] = TRUE;
       cmd_reply(CMD_DEBUG, caller, C_OK, _("Ferry system in debug mode."));
     }
+  } else if (ntokens > 0 && strcmp(arg[0], "path") == 0) {
+    int id, x, y;
+    struct unit *punit;
+    struct tile *ptile;
+
+    if (ntokens != 4) {
+      cmd_reply(CMD_DEBUG, caller, C_SYNTAX,
+                _("Undefined argument.  Usage:\n%s"),
+                command_synopsis(command_by_number(CMD_DEBUG)));
+      goto cleanup;
+    }
+    if (!str_to_int(arg[1], &id)) {
+      cmd_reply(CMD_DEBUG, caller, C_SYNTAX, _("Value 2 must be integer."));
+      goto cleanup;
+    }
+    if (!(punit = game_unit_by_number(id))) {
+      cmd_reply(CMD_DEBUG, caller, C_SYNTAX, _("Unit %d does not exist."), id);
+      goto cleanup;
+    }
+    if (!str_to_int(arg[2], &x) || !str_to_int(arg[3], &y)) {
+      cmd_reply(CMD_DEBUG, caller, C_SYNTAX, _("Value 3 & 4 must be integer."));
+      goto cleanup;
+    }
+    if (!(ptile = map_pos_to_tile(&(wld.map), x, y))) {
+      cmd_reply(CMD_DEBUG, caller, C_SYNTAX, _("Bad map coordinates."));
+      goto cleanup;
+    }
+    debug_path_compare(caller, punit, ptile);
   } else if (ntokens > 0 && strcmp(arg[0], "unit") == 0) {
     int id;
     struct unit *punit;
@@ -58,6 +58,7 @@
 #include "notify.h"
 #include "plrhand.h"
 #include "sanitycheck.h"
+#include "score.h"
 #include "spacerace.h"
 #include "srv_main.h"
 #include "techtools.h"
@@ -2822,6 +2823,7 @@ void unit_change_homecity_handling(struct unit *punit, struct city *new_pcity,
     unit_list_remove(old_owner->units, punit);
     unit_list_prepend(new_owner->units, punit);
     punit->owner = new_owner;
+    score_tile_changed(unit_tile(punit));
 
     /* Activate AI control of the new owner. */
     CALL_PLR_AI_FUNC(unit_got, new_owner, punit);
@@ -69,6 +69,7 @@
 #include "notify.h"
 #include "plrhand.h"
 #include "sanitycheck.h"
+#include "score.h"
 #include "sernet.h"
 #include "srv_main.h"
 #include "techtools.h"
@@ -130,6 +131,15 @@ struct autoattack_prob {
 
 #define autoattack_prob_list_iterate_safe_end  LIST_ITERATE_END
 
+/* The ids of the units whose info is sent by unit_info_thaw(), in the
+ * order of their first change. */
+static struct {
+  int frozen;
+  int *ids;
+  int num;
+  int size;
+} unit_info_queue = { 0, NULL, 0, 0 };
+
 static void unit_restore_hitpoints(struct unit *punit);
 static void unit_restore_movepoints(struct player *pplayer, struct unit *punit);
 static void update_unit_activity(struct unit *punit);
@@ -1640,6 +1650,7 @@ struct unit *create_unit_full(struct player *pplayer, struct tile *ptile,
 
   unit_list_prepend(pplayer->units, punit);
   unit_list_prepend(ptile->units, punit);
+  score_tile_changed(ptile);
   if (pcity && !utype_has_flag(type, UTYF_NOHOME)) {
     fc_assert(city_owner(pcity) == pplayer);
     unit_list_prepend(pcity->units_supported, punit);
@@ -1779,6 +1790,7 @@ static void server_remove_unit_full(struct unit *punit, bool transported,
   script_server_remove_exported_object(punit);
   game_remove_unit(&wld, punit);
   punit = NULL;
+  score_tile_changed(ptile);
 
   if (NULL != ptrans) {
     /* Update the occupy info. */
@@ -2612,12 +2624,29 @@ void send_unit_info(struct conn_list *dest, struct unit *punit)
   struct packet_unit_short_info sinfo;
   struct unit_move_data *pdata;
 
+  CHECK_UNIT(punit);
+
   if (dest == NULL) {
+    /* A moving unit is sent at once, since the move code keeps track of
+     * who got it in the move data. */
+    if (unit_info_queue.frozen > 0 && punit->server.moving == NULL) {
+      if (!punit->server.info_pending) {
+        if (unit_info_queue.num == unit_info_queue.size) {
+          unit_info_queue.size = MAX(64, 2 * unit_info_queue.size);
+          unit_info_queue.ids
+            = fc_realloc(unit_info_queue.ids,
+                         unit_info_queue.size * sizeof(*unit_info_queue.ids));
+        }
+        unit_info_queue.ids[unit_info_queue.num++] = punit->id;
+        punit->server.info_pending = TRUE;
+      }
+      return;
+    }
+
     dest = game.est_connections;
+    punit->server.info_pending = FALSE;
   }
 
-  CHECK_UNIT(punit);
-
   powner = unit_owner(punit);
   package_unit(punit, &info);
   package_short_unit(punit, &sinfo, UNIT_INFO_IDENTITY, 0);
@@ -2645,6 +2674,42 @@ void send_unit_info(struct conn_list *dest, struct unit *punit)
   } conn_list_iterate_end;
 }
 
+/**********************************************************************//**
+  Delay sending the unit info to all connections. Until the matching
+  unit_info_thaw(), send_unit_info(NULL, punit) only remembers the unit,
+  so that a unit changed several times is sent once with its final state.
+  Calls can be nested.
+**************************************************************************/
+void unit_info_freeze(void)
+{
+  unit_info_queue.frozen++;
+}
+
+/**********************************************************************//**
+  Undo unit_info_freeze(). At the last one, send the info of the units
+  changed since, unless they are gone.
+**************************************************************************/
+void unit_info_thaw(void)
+{
+  int i;
+
+  fc_assert_ret(unit_info_queue.frozen > 0);
+
+  if (--unit_info_queue.frozen > 0) {
+    return;
+  }
+
+  /* Sending can't queue units anymore, so the queue stays as is. */
+  for (i = 0; i < unit_info_queue.num; i++) {
+    struct unit *punit = game_unit_by_number(unit_info_queue.ids[i]);
+
+    if (punit != NULL && punit->server.info_pending) {
+      send_unit_info(NULL, punit);
+    }
+  }
+  unit_info_queue.num = 0;
+}
+
 /**********************************************************************//**
   For each specified connections, send information about all the units
   known to that player/conn.
@@ -2860,31 +2925,33 @@ bool do_paradrop(struct unit *punit, struct tile *ptile)
   } else {
     /* Only take in account values from player map. */
     const struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+    struct terrain *plrterrain = player_tile_terrain(plrtile);
+    struct player *plrowner = player_tile_owner(plrtile);
 
     if (NULL == plrtile->site
-        && !is_native_to_class(unit_class_get(punit), plrtile->terrain,
+        && !is_native_to_class(unit_class_get(punit), plrterrain,
                                &(plrtile->extras))) {
       notify_player(pplayer, ptile, E_BAD_COMMAND, ftc_server,
                     _("This unit cannot paradrop into %s."),
-                    terrain_name_translation(plrtile->terrain));
+                    terrain_name_translation(plrterrain));
       return FALSE;
     }
 
     if (NULL != plrtile->site
-        && plrtile->owner != NULL
-        && pplayers_non_attack(pplayer, plrtile->owner)) {
+        && plrowner != NULL
+        && pplayers_non_attack(pplayer, plrowner)) {
       notify_player(pplayer, ptile, E_BAD_COMMAND, ftc_server,
                     _("Cannot attack unless you declare war first."));
       return FALSE;
     }
 
     if (is_military_unit(punit)
-        && NULL != plrtile->owner
-        && players_non_invade(pplayer, plrtile->owner)) {
+        && NULL != plrowner
+        && players_non_invade(pplayer, plrowner)) {
       notify_player(pplayer, ptile, E_BAD_COMMAND, ftc_server,
                     _("Cannot invade unless you break peace with "
                       "%s first."),
-                    player_name(plrtile->owner));
+                    player_name(plrowner));
       return FALSE;
     }
 
@@ -3547,6 +3614,8 @@ static struct unit_move_data *unit_move_data(struct unit *punit,
   /* Set new tile. */
   unit_tile_set(punit, pdesttile);
   unit_list_prepend(pdesttile->units, punit);
+  score_tile_changed(psrctile);
+  score_tile_changed(pdesttile);
 
   if (unit_transported(punit)) {
     /* Silently free orders since they won't be applicable anymore. */
@@ -3567,6 +3636,10 @@ static struct unit_move_data *unit_move_data(struct unit *punit,
   /* Enhance vision if unit steps into a fortress */
   new_vision = vision_new(powner, pdesttile);
   punit->server.vision = new_vision;
+  if (pdata->old_vision != NULL) {
+    /* Only the tiles not seen from the source tile change. */
+    vision_link(new_vision, pdata->old_vision);
+  }
   vision_change_sight(new_vision, radius_sq);
   ASSERT_VISION(new_vision);
 
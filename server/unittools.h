@@ -145,6 +145,8 @@ void package_short_unit(struct unit *punit,
 			struct packet_unit_short_info *packet,
                         enum unit_info_use packet_use, int info_city_id);
 void send_unit_info(struct conn_list *dest, struct unit *punit);
+void unit_info_freeze(void);
+void unit_info_thaw(void);
 void send_all_known_units(struct conn_list *dest);
 void unit_goes_out_of_sight(struct player *pplayer, struct unit *punit);
 
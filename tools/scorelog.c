@@ -0,0 +1,370 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+/* Reader for the binary scorelog (server setting 'scorelogformat').
+ * Only the header, the index and the parts of the turn blocks which are
+ * needed are read, so extracting one tag does not scan the whole file. */
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* utility */
+#include "fc_cmdline.h"
+#include "fciconv.h"
+#include "fcintl.h"
+#include "log.h"
+#include "mem.h"
+#include "support.h"
+
+/* common */
+#include "fc_cmdhelp.h"
+#include "fc_types.h"
+
+/* server */
+#include "scorelog.h"
+
+struct scorelog_file {
+  FILE *fp;
+  char version[256];
+  char id[256];
+  long index_pos;
+  int num_tags;
+  char **tags;
+  char *names[MAX_NUM_PLAYER_SLOTS];
+};
+
+static char *tag_selected = NULL;
+static char *file_selected = NULL;
+
+/**********************************************************************//**
+  Print an error message and quit.
+**************************************************************************/
+static void scorelog_fail(const char *msg, const char *filename)
+{
+  fc_fprintf(stderr, "%s: %s\n", filename, msg);
+  exit(EXIT_FAILURE);
+}
+
+/**********************************************************************//**
+  Read 'len' bytes at offset 'pos'.
+**************************************************************************/
+static bool scorelog_read(struct scorelog_file *slf, long pos,
+                          unsigned char *data, size_t len)
+{
+  return fseek(slf->fp, pos, SEEK_SET) == 0
+         && fread(data, 1, len, slf->fp) == len;
+}
+
+/**********************************************************************//**
+  Read a string with its length at offset '*pos' and advance '*pos'
+  behind it. 'str' has to hold at least 256 bytes.
+**************************************************************************/
+static bool scorelog_read_str(struct scorelog_file *slf, long *pos,
+                              char *str)
+{
+  unsigned char len;
+
+  if (!scorelog_read(slf, *pos, &len, 1)
+      || (len > 0 && fread(str, 1, len, slf->fp) != len)) {
+    return FALSE;
+  }
+  str[len] = '\0';
+  *pos += 1 + len;
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Open the binary scorelog and read its header.
+**************************************************************************/
+static void scorelog_open(struct scorelog_file *slf, const char *filename)
+{
+  unsigned char buf[SCORELOG_MAGIC_LEN];
+  char str[256];
+  long pos;
+  int i;
+
+  memset(slf, 0, sizeof(*slf));
+
+  slf->fp = fc_fopen(filename, "rb");
+  if (slf->fp == NULL) {
+    scorelog_fail(_("Can't open file."), filename);
+  }
+
+  if (!scorelog_read(slf, 0, buf, SCORELOG_MAGIC_LEN)
+      || memcmp(buf, SCORELOG_MAGIC, SCORELOG_MAGIC_LEN) != 0) {
+    scorelog_fail(_("Not a binary scorelog."), filename);
+  }
+
+  pos = SCORELOG_MAGIC_LEN;
+  if (!scorelog_read_str(slf, &pos, slf->version)
+      || !scorelog_read(slf, pos, buf, 4)) {
+    scorelog_fail(_("Can't read the header."), filename);
+  }
+  slf->index_pos = scorelog_get_u32(buf);
+  pos += 4;
+
+  if (!scorelog_read_str(slf, &pos, slf->id)
+      || !scorelog_read(slf, pos, buf, 2)) {
+    scorelog_fail(_("Can't read the header."), filename);
+  }
+  slf->num_tags = scorelog_get_u16(buf);
+  pos += 2;
+
+  slf->tags = fc_calloc(slf->num_tags, sizeof(*slf->tags));
+  for (i = 0; i < slf->num_tags; i++) {
+    if (!scorelog_read_str(slf, &pos, str)) {
+      scorelog_fail(_("Can't read the header."), filename);
+    }
+    slf->tags[i] = fc_strdup(str);
+  }
+}
+
+/**********************************************************************//**
+  Close the scorelog.
+**************************************************************************/
+static void scorelog_close(struct scorelog_file *slf)
+{
+  int i;
+
+  for (i = 0; i < slf->num_tags; i++) {
+    free(slf->tags[i]);
+  }
+  free(slf->tags);
+
+  for (i = 0; i < ARRAY_SIZE(slf->names); i++) {
+    free(slf->names[i]);
+  }
+
+  fclose(slf->fp);
+}
+
+/**********************************************************************//**
+  Print the values of one tag for every turn. With tag == -1 only the
+  turns are listed.
+**************************************************************************/
+static void scorelog_dump(struct scorelog_file *slf, int tag,
+                          const char *filename)
+{
+  unsigned char index[SCORELOG_INDEX_SIZE];
+  unsigned char block[SCORELOG_TURN_HEADER_SIZE];
+  unsigned char *players = NULL, *values = NULL;
+  int max_players = 0;
+  long index_pos = slf->index_pos;
+  long min_pos = SCORELOG_MAGIC_LEN, file_size;
+  int turns = 0;
+
+  if (fseek(slf->fp, 0, SEEK_END) != 0
+      || (file_size = ftell(slf->fp)) < 0) {
+    scorelog_fail(_("Can't read the file."), filename);
+  }
+
+  /* Index blocks are always appended to the file, so each one lies
+   * behind the previous one. Anything else would be a loop. */
+  while (index_pos != 0) {
+    int count, i;
+
+    if (index_pos < min_pos
+        || index_pos > file_size - (long) sizeof(index)
+        || !scorelog_read(slf, index_pos, index, sizeof(index))
+        || memcmp(index, SCORELOG_INDEX_MAGIC, 4) != 0
+        || scorelog_get_u32(index + 8) > SCORELOG_INDEX_ENTRIES) {
+      scorelog_fail(_("Bad index block."), filename);
+    }
+    count = scorelog_get_u32(index + 8);
+    min_pos = index_pos + sizeof(index);
+    index_pos = scorelog_get_u32(index + 4);
+
+    for (i = 0; i < count; i++) {
+      const unsigned char *entry = index + SCORELOG_INDEX_HEADER_SIZE
+                                   + i * SCORELOG_INDEX_ENTRY_SIZE;
+      long block_pos = scorelog_get_u32(entry + 4);
+      long pos = block_pos + SCORELOG_TURN_HEADER_SIZE;
+      char calendar[256], name[256];
+      int turn, year, num_players, num_events, j;
+      long columns;
+
+      if (!scorelog_read(slf, block_pos, block, sizeof(block))
+          || memcmp(block, SCORELOG_TURN_MAGIC, 4) != 0
+          || !scorelog_read_str(slf, &pos, calendar)) {
+        scorelog_fail(_("Bad turn block."), filename);
+      }
+      turn = scorelog_get_s32(block + 4);
+      year = scorelog_get_s32(block + 8);
+      columns = block_pos + scorelog_get_u32(block + 12);
+      num_players = scorelog_get_u16(block + 16);
+      num_events = scorelog_get_u16(block + 18);
+      turns++;
+
+      /* Player events; needed for the player names. */
+      for (j = 0; j < num_events; j++) {
+        unsigned char event[7];
+        int plr_no;
+
+        if (!scorelog_read(slf, pos, event, sizeof(event))) {
+          scorelog_fail(_("Bad turn block."), filename);
+        }
+        pos += sizeof(event);
+        if (!scorelog_read_str(slf, &pos, name)) {
+          scorelog_fail(_("Bad turn block."), filename);
+        }
+
+        plr_no = scorelog_get_u16(event + 5);
+        if (plr_no >= ARRAY_SIZE(slf->names)) {
+          scorelog_fail(_("Invalid player number."), filename);
+        }
+        free(slf->names[plr_no]);
+        slf->names[plr_no] = (event[0] == SCORELOG_ADDPLAYER
+                              ? fc_strdup(name) : NULL);
+      }
+
+      if (tag < 0) {
+        fc_printf("%d\t%d\t%s\t%d\n", turn, year, calendar, num_players);
+        continue;
+      }
+
+      if (num_players > max_players) {
+        max_players = num_players;
+        players = fc_realloc(players, 2 * max_players);
+        values = fc_realloc(values, 4 * max_players);
+      }
+
+      if (num_players > 0
+          && (!scorelog_read(slf, columns - 2 * num_players, players,
+                             2 * num_players)
+              || !scorelog_read(slf, columns + (long) tag * 4 * num_players,
+                                values, 4 * num_players))) {
+        scorelog_fail(_("Bad turn block."), filename);
+      }
+
+      for (j = 0; j < num_players; j++) {
+        int plr_no = scorelog_get_u16(players + 2 * j);
+        const char *plr_name = (plr_no < ARRAY_SIZE(slf->names)
+                                && slf->names[plr_no] != NULL
+                                ? slf->names[plr_no] : "");
+
+        fc_printf("%d\t%d\t%d\t%s\t%d\n", turn, year, plr_no, plr_name,
+                  scorelog_get_s32(values + 4 * j));
+      }
+    }
+  }
+
+  free(players);
+  free(values);
+
+  if (tag < 0) {
+    fc_printf("# %d turn blocks\n", turns);
+  }
+}
+
+/**********************************************************************//**
+  Parse freeciv-scorelog commandline parameters.
+**************************************************************************/
+static void scorelog_parse_cmdline(int argc, char *argv[])
+{
+  int i = 1;
+
+  while (i < argc) {
+    char *option = NULL;
+
+    if (is_option("--help", argv[i])) {
+      struct cmdhelp *help = cmdhelp_new(argv[0]);
+
+      cmdhelp_add(help, "h", "help",
+                  _("Print a summary of the options"));
+      cmdhelp_add(help, "t",
+                  /* TRANS: "tag" is exactly what user must type, do not translate. */
+                  _("tag TAG"),
+                  _("Print the values of TAG for all turns and players"));
+
+      /* The function below prints a header and footer for the options.
+       * Furthermore, the options are sorted. */
+      cmdhelp_display(help, TRUE, FALSE, TRUE);
+      cmdhelp_destroy(help);
+
+      cmdline_option_values_free();
+
+      exit(EXIT_SUCCESS);
+    } else if ((option = get_option_malloc("--tag", argv, &i, argc, TRUE))) {
+      tag_selected = option;
+    } else if (argv[i][0] != '-' && file_selected == NULL) {
+      file_selected = argv[i];
+    } else {
+      fc_fprintf(stderr, _("Unrecognized option: \"%s\"\n"), argv[i]);
+      cmdline_option_values_free();
+      exit(EXIT_FAILURE);
+    }
+
+    i++;
+  }
+}
+
+/**********************************************************************//**
+  Main entry point for freeciv-scorelog
+**************************************************************************/
+int main(int argc, char **argv)
+{
+  struct scorelog_file slf;
+  int tag = -1;
+  int i;
+
+  init_nls();
+  init_character_encodings(FC_DEFAULT_DATA_ENCODING, FALSE);
+
+  scorelog_parse_cmdline(argc, argv);
+
+  log_init(NULL, LOG_NORMAL, NULL, NULL, -1);
+
+  if (file_selected == NULL) {
+    fc_fprintf(stderr, _("No scorelog file given. Try using --help.\n"));
+    exit(EXIT_FAILURE);
+  }
+
+  scorelog_open(&slf, file_selected);
+
+  if (tag_selected != NULL) {
+    for (i = 0; i < slf.num_tags; i++) {
+      if (strcmp(slf.tags[i], tag_selected) == 0) {
+        tag = i;
+        break;
+      }
+    }
+
+    if (tag < 0) {
+      scorelog_fail(_("Unknown tag."), file_selected);
+    }
+
+    fc_printf("# turn\tyear\tplayer\tname\t%s\n", tag_selected);
+  } else {
+    fc_printf("# version %s\n", slf.version);
+    fc_printf("# id %s\n", slf.id);
+    for (i = 0; i < slf.num_tags; i++) {
+      fc_printf("# tag %d %s\n", i, slf.tags[i]);
+    }
+    fc_printf("# turn\tyear\tcalendar\tplayers\n");
+  }
+
+  scorelog_dump(&slf, tag, file_selected);
+  scorelog_close(&slf);
+
+  log_close();
+  free_nls();
+  cmdline_option_values_free();
+
+  return EXIT_SUCCESS;
+}
@@ -137,6 +137,14 @@ void fc_thread_cond_signal(fc_thread_cond *cond)
   cnd_signal(cond);
 }
 
+/*******************************************************************//**
+  Signal all threads waiting on condition to continue
+***********************************************************************/
+void fc_thread_cond_broadcast(fc_thread_cond *cond)
+{
+  cnd_broadcast(cond);
+}
+
 #elif defined(FREECIV_HAVE_PTHREAD)
 
 struct fc_thread_wrap_data {
@@ -267,6 +275,14 @@ void fc_thread_cond_signal(fc_thread_cond *cond)
   pthread_cond_signal(cond);
 }
 
+/*******************************************************************//**
+  Signal all threads waiting on condition to continue
+***********************************************************************/
+void fc_thread_cond_broadcast(fc_thread_cond *cond)
+{
+  pthread_cond_broadcast(cond);
+}
+
 #elif defined(FREECIV_HAVE_WINTHREADS)
 
 struct fc_thread_wrap_data {
@@ -397,6 +413,12 @@ void fc_thread_cond_wait(fc_thread_cond *cond, fc_mutex *mutex)
 void fc_thread_cond_signal(fc_thread_cond *cond)
 {}
 
+/*******************************************************************//**
+  Dummy fc_thread_cond_broadcast()
+***********************************************************************/
+void fc_thread_cond_broadcast(fc_thread_cond *cond)
+{}
+
 #endif /* !FREECIV_HAVE_THREAD_COND */
 
 /*******************************************************************//**
@@ -45,6 +45,9 @@
 #ifdef HAVE_SYS_SIGNAL_H
 #include <sys/signal.h>
 #endif
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
 #ifdef FREECIV_MSWINDOWS
 #include <windows.h>	/* GetTempPath */
 #endif
@@ -175,6 +178,70 @@ int fc_writesocket(int sock, const void *buf, size_t size)
   return result;
 }
 
+/*********************************************************************//**
+  Write several pieces of data to a socket with one call, gathering them
+  from their own buffers. At most FC_IOV_MAX pieces are written.
+  Returns the number of bytes written, or -1 on error. Like with
+  fc_writesocket() that may be less than the total length.
+*************************************************************************/
+int fc_writevsocket(int sock, const struct fc_iovec *iov, int iovcnt)
+{
+  int result;
+
+  if (iovcnt > FC_IOV_MAX) {
+    iovcnt = FC_IOV_MAX;
+  }
+
+#if defined(HAVE_SYS_UIO_H) && !defined(FREECIV_HAVE_WINSOCK)
+  {
+    struct iovec sys_iov[FC_IOV_MAX];
+    int i;
+
+    for (i = 0; i < iovcnt; i++) {
+      sys_iov[i].iov_base = (void *) iov[i].base;
+      sys_iov[i].iov_len = iov[i].len;
+    }
+
+#  ifdef MSG_NOSIGNAL
+    {
+      struct msghdr msg;
+
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_iov = sys_iov;
+      msg.msg_iovlen = iovcnt;
+      result = sendmsg(sock, &msg, MSG_NOSIGNAL);
+    }
+#  else  /* MSG_NOSIGNAL */
+    result = writev(sock, sys_iov, iovcnt);
+#  endif /* MSG_NOSIGNAL */
+  }
+#else  /* HAVE_SYS_UIO_H && !FREECIV_HAVE_WINSOCK */
+  {
+    int i;
+
+    /* No gathering write available; write the pieces one by one,
+     * stopping at the first one that does not go out whole. */
+    result = 0;
+    for (i = 0; i < iovcnt; i++) {
+      int nput = fc_writesocket(sock, iov[i].base, iov[i].len);
+
+      if (nput == -1) {
+        if (result == 0) {
+          result = -1;
+        }
+        break;
+      }
+      result += nput;
+      if ((size_t) nput < iov[i].len) {
+        break;
+      }
+    }
+  }
+#endif /* HAVE_SYS_UIO_H && !FREECIV_HAVE_WINSOCK */
+
+  return result;
+}
+
 /*********************************************************************//**
   Close a socket.
 *************************************************************************/
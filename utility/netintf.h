@@ -51,6 +51,15 @@ extern "C" {
 #include "net_types.h"
 #include "support.h"   /* bool type */
 
+/* One piece of data for fc_writevsocket() */
+struct fc_iovec {
+  const void *base;
+  size_t len;
+};
+
+/* Most pieces fc_writevsocket() writes in one go */
+#define FC_IOV_MAX 64
+
 #ifdef FD_ZERO
 #define FC_FD_ZERO FD_ZERO
 #else
@@ -95,6 +104,7 @@ int fc_select(int n, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
               fc_timeval *timeout);
 int fc_readsocket(int sock, void *buf, size_t size);
 int fc_writesocket(int sock, const void *buf, size_t size);
+int fc_writevsocket(int sock, const struct fc_iovec *iov, int iovcnt);
 void fc_closesocket(int sock);
 
 void fc_nonblock(int sockfd);
@@ -0,0 +1,192 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+/* utility */
+#include "fcthread.h"
+#include "log.h"
+#include "mem.h"
+
+#include "workerpool.h"
+
+struct fc_worker_pool {
+  int num_helpers;          /* Threads besides the one calling run() */
+  fc_thread *helpers;
+
+  fc_mutex mutex;
+  fc_thread_cond work_cond; /* New job posted, or pool exiting */
+  fc_thread_cond done_cond; /* Last helper finished with the job */
+
+  /* Current job. Protected by mutex. */
+  fc_worker_func func;
+  void *data;
+  int count;
+  int next;                 /* Next index to hand out */
+  int busy;                 /* Helpers still inside the job */
+  unsigned int job_id;      /* Bumped for each job posted */
+  bool exiting;
+};
+
+/*******************************************************************//**
+  Process items of the current job until none are left.
+  Must be called with pool->mutex held; returns with it held.
+***********************************************************************/
+static void worker_pool_drain(struct fc_worker_pool *pool)
+{
+  while (pool->next < pool->count) {
+    int idx = pool->next++;
+
+    fc_release_mutex(&pool->mutex);
+    pool->func(idx, pool->data);
+    fc_allocate_mutex(&pool->mutex);
+  }
+}
+
+/*******************************************************************//**
+  Main function of a helper thread.
+***********************************************************************/
+static void worker_pool_helper(void *arg)
+{
+  struct fc_worker_pool *pool = arg;
+  unsigned int seen = 0;
+
+  fc_allocate_mutex(&pool->mutex);
+  while (TRUE) {
+    while (!pool->exiting && pool->job_id == seen) {
+      fc_thread_cond_wait(&pool->work_cond, &pool->mutex);
+    }
+    if (pool->exiting) {
+      break;
+    }
+    seen = pool->job_id;
+
+    worker_pool_drain(pool);
+
+    if (--pool->busy == 0) {
+      fc_thread_cond_signal(&pool->done_cond);
+    }
+  }
+  fc_release_mutex(&pool->mutex);
+}
+
+/*******************************************************************//**
+  Create a pool running jobs on num_threads threads in total, the calling
+  thread included. Falls back to serial execution when the platform has
+  no condition variable implementation.
+***********************************************************************/
+struct fc_worker_pool *fc_worker_pool_new(int num_threads)
+{
+  struct fc_worker_pool *pool = fc_calloc(1, sizeof(*pool));
+  int i;
+
+  if (!has_thread_cond_impl()) {
+    num_threads = 1;
+  }
+
+  fc_init_mutex(&pool->mutex);
+  fc_thread_cond_init(&pool->work_cond);
+  fc_thread_cond_init(&pool->done_cond);
+
+  if (num_threads > 1) {
+    pool->helpers = fc_calloc(num_threads - 1, sizeof(*pool->helpers));
+  }
+
+  for (i = 0; i < num_threads - 1; i++) {
+    if (fc_thread_start(&pool->helpers[i], worker_pool_helper, pool)) {
+      log_error("Failed to start worker thread %d; "
+                "continuing with %d.", i + 1, i + 1);
+      break;
+    }
+    pool->num_helpers++;
+  }
+
+  return pool;
+}
+
+/*******************************************************************//**
+  Stop the helper threads and free the pool.
+***********************************************************************/
+void fc_worker_pool_destroy(struct fc_worker_pool *pool)
+{
+  int i;
+
+  if (pool == NULL) {
+    return;
+  }
+
+  fc_allocate_mutex(&pool->mutex);
+  pool->exiting = TRUE;
+  fc_thread_cond_broadcast(&pool->work_cond);
+  fc_release_mutex(&pool->mutex);
+
+  for (i = 0; i < pool->num_helpers; i++) {
+    fc_thread_wait(&pool->helpers[i]);
+  }
+
+  fc_thread_cond_destroy(&pool->done_cond);
+  fc_thread_cond_destroy(&pool->work_cond);
+  fc_destroy_mutex(&pool->mutex);
+  free(pool->helpers);
+  free(pool);
+}
+
+/*******************************************************************//**
+  Number of threads the pool runs jobs on, the calling thread included.
+***********************************************************************/
+int fc_worker_pool_threads(const struct fc_worker_pool *pool)
+{
+  if (pool == NULL) {
+    return 1;
+  }
+
+  return pool->num_helpers + 1;
+}
+
+/*******************************************************************//**
+  Call func(idx, data) for each idx in [0, count), spread over the pool,
+  and wait for all the calls to finish.
+***********************************************************************/
+void fc_worker_pool_run(struct fc_worker_pool *pool, int count,
+                        fc_worker_func func, void *data)
+{
+  if (pool == NULL || pool->num_helpers == 0 || count <= 1) {
+    int i;
+
+    for (i = 0; i < count; i++) {
+      func(i, data);
+    }
+
+    return;
+  }
+
+  fc_allocate_mutex(&pool->mutex);
+  pool->func = func;
+  pool->data = data;
+  pool->count = count;
+  pool->next = 0;
+  pool->busy = pool->num_helpers;
+  pool->job_id++;
+  fc_thread_cond_broadcast(&pool->work_cond);
+
+  worker_pool_drain(pool);
+
+  while (pool->busy > 0) {
+    fc_thread_cond_wait(&pool->done_cond, &pool->mutex);
+  }
+  pool->func = NULL;
+  pool->data = NULL;
+  fc_release_mutex(&pool->mutex);
+}
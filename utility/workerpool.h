@@ -0,0 +1,50 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+#ifndef FC__WORKERPOOL_H
+#define FC__WORKERPOOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* utility */
+#include "support.h" /* bool */
+
+/* A pool of helper threads executing index ranges of a job.
+ *
+ * fc_worker_pool_run() calls func(idx, data) exactly once for every idx
+ * in [0, count) and returns only when all of them have finished. The
+ * calling thread takes part in the work, so a pool without helper
+ * threads (or a NULL pool) simply runs the job serially in index order.
+ * The order in which indices are processed is unspecified otherwise;
+ * callers wanting deterministic results must make every item write only
+ * to storage owned by that index, and commit the results afterwards. */
+
+struct fc_worker_pool;
+
+typedef void (*fc_worker_func)(int idx, void *data);
+
+struct fc_worker_pool *fc_worker_pool_new(int num_threads);
+void fc_worker_pool_destroy(struct fc_worker_pool *pool);
+
+int fc_worker_pool_threads(const struct fc_worker_pool *pool);
+
+void fc_worker_pool_run(struct fc_worker_pool *pool, int count,
+                        fc_worker_func func, void *data);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FC__WORKERPOOL_H */